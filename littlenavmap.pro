@@ -168,14 +168,17 @@ SOURCES += src/main.cpp\
     src/route/routecommand.cpp \
     src/route/routefinder.cpp \
     src/mapgui/mapwidget.cpp \
+    src/mapgui/mapbenchmark.cpp \
     src/route/routenetworkradio.cpp \
     src/route/routenetworkairway.cpp \
     src/route/routenetwork.cpp \
     src/connect/connectdialog.cpp \
     src/connect/connectclient.cpp \
+    src/connect/flightrecorder.cpp \
     src/mapgui/mappainteraircraft.cpp \
     src/profile/profilewidget.cpp \
     src/common/aircrafttrack.cpp \
+    src/info/htmltemplateview.cpp \
     src/info/infocontroller.cpp \
     src/common/symbolpainter.cpp \
     src/db/databasemanager.cpp \
@@ -186,6 +189,8 @@ SOURCES += src/main.cpp\
     src/export/htmlexporter.cpp \
     src/common/htmlinfobuilder.cpp \
     src/mapgui/mapscreenindex.cpp \
+    src/mapgui/mapupdatescheduler.cpp \
+    src/mapgui/trafficstore.cpp \
     src/options/optionsdialog.cpp \
     src/options/optiondata.cpp \
     src/common/settingsmigrate.cpp \
@@ -209,6 +214,9 @@ SOURCES += src/main.cpp\
     src/navapp.cpp \
     src/common/mapflags.cpp \
     src/common/elevationprovider.cpp \
+    src/common/elevationservice.cpp \
+    src/common/globemappedreader.cpp \
+    src/common/elevationpyramid.cpp \
     src/mapgui/mappaintership.cpp \
     src/mapgui/mappaintervehicle.cpp \
     src/common/updatehandler.cpp \
@@ -240,6 +248,8 @@ SOURCES += src/main.cpp\
     src/gui/timedialog.cpp \
     src/gui/stylehandler.cpp \
     src/mapgui/mappainteraltitude.cpp \
+    src/mapgui/mappainterterrain.cpp \
+    src/mapgui/terraintilecache.cpp \
     src/gui/trafficpatterndialog.cpp \
     src/profile/profilescrollarea.cpp \
     src/profile/profilelabelwidget.cpp \
@@ -252,6 +262,7 @@ SOURCES += src/main.cpp\
     src/mapgui/mappainterweather.cpp \
     src/common/airportfiles.cpp \
     src/common/tabindexes.cpp \
+    src/common/screengrid.cpp \
     src/route/routeexportdata.cpp \
     src/route/routeexportdialog.cpp
 
@@ -288,14 +299,17 @@ HEADERS  += src/gui/mainwindow.h \
     src/route/routecommand.h \
     src/route/routefinder.h \
     src/mapgui/mapwidget.h \
+    src/mapgui/mapbenchmark.h \
     src/route/routenetworkradio.h \
     src/route/routenetworkairway.h \
     src/route/routenetwork.h \
     src/connect/connectdialog.h \
     src/connect/connectclient.h \
+    src/connect/flightrecorder.h \
     src/mapgui/mappainteraircraft.h \
     src/profile/profilewidget.h \
     src/common/aircrafttrack.h \
+    src/info/htmltemplateview.h \
     src/info/infocontroller.h \
     src/common/symbolpainter.h \
     src/db/databasemanager.h \
@@ -306,6 +320,8 @@ HEADERS  += src/gui/mainwindow.h \
     src/export/htmlexporter.h \
     src/common/htmlinfobuilder.h \
     src/mapgui/mapscreenindex.h \
+    src/mapgui/mapupdatescheduler.h \
+    src/mapgui/trafficstore.h \
     src/options/optionsdialog.h \
     src/options/optiondata.h \
     src/common/settingsmigrate.h \
@@ -329,6 +345,9 @@ HEADERS  += src/gui/mainwindow.h \
     src/navapp.h \
     src/common/mapflags.h \
     src/common/elevationprovider.h \
+    src/common/elevationservice.h \
+    src/common/globemappedreader.h \
+    src/common/elevationpyramid.h \
     src/mapgui/mappaintership.h \
     src/mapgui/mappaintervehicle.h \
     src/common/updatehandler.h \
@@ -360,6 +379,8 @@ HEADERS  += src/gui/mainwindow.h \
     src/gui/timedialog.h \
     src/gui/stylehandler.h \
     src/mapgui/mappainteraltitude.h \
+    src/mapgui/mappainterterrain.h \
+    src/mapgui/terraintilecache.h \
     src/gui/trafficpatterndialog.h \
     src/profile/profilescrollarea.h \
     src/profile/profilelabelwidget.h \
@@ -372,6 +393,7 @@ HEADERS  += src/gui/mainwindow.h \
     src/mapgui/mappainterweather.h \
     src/common/airportfiles.h \
     src/common/tabindexes.h \
+    src/common/screengrid.h \
     src/route/routeexportdata.h \
     src/route/routeexportdialog.h
 
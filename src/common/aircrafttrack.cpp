@@ -24,12 +24,27 @@
 #include <QDataStream>
 #include <QDateTime>
 #include <QFile>
+#include <QSaveFile>
 
-AircraftTrack::AircraftTrack()
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+void initStream(QDataStream& stream)
 {
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
 
 }
 
+AircraftTrack::AircraftTrack()
+{
+  simplified.resize(LOD_LEVELS);
+}
+
 AircraftTrack::~AircraftTrack()
 {
 
@@ -53,53 +68,169 @@ QDataStream& operator<<(QDataStream& dataStream, const at::AircraftTrackPos& tra
 
 void AircraftTrack::saveState()
 {
-  QFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
-
-  if(trackFile.open(QIODevice::WriteOnly))
-  {
-    QDataStream out(&trackFile);
-    out.setVersion(QDataStream::Qt_5_5);
-    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    out << FILE_MAGIC_NUMBER << FILE_VERSION << *this;
-    trackFile.close();
-  }
-  else
-    qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
+  writeUnsaved();
 }
 
 void AircraftTrack::restoreState()
 {
-  clear();
+  load(0, std::numeric_limits<quint32>::max());
+}
+
+void AircraftTrack::load(quint32 fromTimestamp, quint32 toTimestamp)
+{
+  clearTrack();
 
   QFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
   if(trackFile.exists())
   {
     if(trackFile.open(QIODevice::ReadOnly))
     {
-      quint32 magic;
-      quint16 version;
       QDataStream in(&trackFile);
-      in.setVersion(QDataStream::Qt_5_5);
-      in.setFloatingPointPrecision(QDataStream::SinglePrecision);
-      in >> magic;
+      initStream(in);
 
-      if(magic == FILE_MAGIC_NUMBER)
+      quint16 version = readHeader(in, trackFile.fileName());
+      if(version == FILE_VERSION_LIST)
       {
-        in >> version;
-        if(version == FILE_VERSION)
-          in >> *this;
-        else
-          qWarning() << "Cannot read track" << trackFile.fileName() << ". Invalid version number:" << version;
+        // Old format with a plain list - convert to chunks with next save
+        QList<at::AircraftTrackPos> positions;
+        in >> positions;
+
+        QVector<at::AircraftTrackPos> inRange;
+        for(const at::AircraftTrackPos& trackPos : positions)
+        {
+          if(trackPos.timestamp >= fromTimestamp && trackPos.timestamp <= toTimestamp)
+            inRange.append(trackPos);
+        }
+
+        for(int i = std::max(0, inRange.size() - maxTrackEntries); i < inRange.size(); i++)
+          append(inRange.at(i));
+        numFileEntries = -1;
       }
-      else
-        qWarning() << "Cannot read track" << trackFile.fileName() << ". Invalid magic number:" << magic;
+      else if(version == FILE_VERSION)
+      {
+        QVector<ChunkIndex> index;
+        bool complete = readChunkIndex(in, index);
+
+        // Index reading stops at a truncated chunk header and leaves the stream in an error state
+        // Chunks before are complete and can be read
+        in.resetStatus();
+
+        // Use only chunks overlapping the time range
+        QVector<ChunkIndex> chunks;
+        for(const ChunkIndex& chunk : index)
+        {
+          if(chunk.lastTimestamp >= fromTimestamp && chunk.firstTimestamp <= toTimestamp)
+            chunks.append(chunk);
+        }
+
+        // Load only the latest chunks which fit into the ring buffer
+        int firstChunk = chunks.size();
+        int loadEntries = 0;
+        while(firstChunk > 0 &&
+              loadEntries + static_cast<int>(chunks.at(firstChunk - 1).numEntries) <= maxTrackEntries)
+          loadEntries += chunks.at(--firstChunk).numEntries;
 
+        for(int i = firstChunk; i < chunks.size() && in.status() == QDataStream::Ok; i++)
+          readChunk(in, chunks.at(i), fromTimestamp, toTimestamp);
+
+        if(complete && in.status() == QDataStream::Ok)
+        {
+          numFileEntries = 0;
+          for(const ChunkIndex& chunk : index)
+            numFileEntries += chunk.numEntries;
+        }
+        else
+        {
+          // Truncated after crash or corrupted - write a clean file from the loaded positions with next save
+          qWarning() << "Track" << trackFile.fileName() << "is incomplete";
+          numFileEntries = -1;
+        }
+      }
       trackFile.close();
     }
     else
       qWarning() << "Cannot read track" << trackFile.fileName() << ":" << trackFile.errorString();
   }
+
+  // All loaded positions are already in the file
+  numUnsaved = 0;
+}
+
+void AircraftTrack::clearTrack()
+{
+  ring.clear();
+  head = numEntries = numUnsaved = 0;
+  firstSequence = 0;
+  for(QVector<qint64>& level : simplified)
+    level.clear();
+
+  // Truncate file with the next write
+  numFileEntries = -1;
+}
+
+void AircraftTrack::setMaxTrackEntries(int value)
+{
+  if(value == maxTrackEntries)
+    return;
+
+  // Copy latest entries into a new buffer starting at index 0
+  int keep = std::min(numEntries, value);
+  QVector<at::AircraftTrackPos> newRing;
+  newRing.reserve(keep);
+  for(int i = numEntries - keep; i < numEntries; i++)
+    newRing.append(at(i));
+
+  ring.swap(newRing);
+  head = 0;
+  firstSequence += numEntries - keep;
+  numEntries = keep;
+  pruneSimplified();
+  numUnsaved = std::min(numUnsaved, keep);
+  maxTrackEntries = value;
+}
+
+void AircraftTrack::append(const at::AircraftTrackPos& trackPos)
+{
+  if(head == 0 && numEntries == ring.size())
+    // Still growing
+    ring.append(trackPos);
+  else
+    // Reuse free slot
+    ring[(head + numEntries) % ring.size()] = trackPos;
+
+  // Add to all simplified levels where the position is far enough from the last one
+  qint64 sequence = firstSequence + numEntries;
+  float tolerance = LOD_BASE_TOLERANCE_METER;
+  for(QVector<qint64>& level : simplified)
+  {
+    if(level.isEmpty() || atSequence(level.last()).pos.distanceMeterTo(trackPos.pos) >= tolerance)
+      level.append(sequence);
+    tolerance *= 2.f;
+  }
+
+  numEntries++;
+  numUnsaved++;
+}
+
+void AircraftTrack::pruneSimplified()
+{
+  for(QVector<qint64>& level : simplified)
+  {
+    int numRemove = static_cast<int>(std::lower_bound(level.begin(), level.end(), firstSequence) - level.begin());
+    if(numRemove > 0)
+      level.remove(0, numRemove);
+  }
+}
+
+const QVector<qint64> *AircraftTrack::getSimplifiedTrack(float toleranceMeter) const
+{
+  if(!(toleranceMeter >= LOD_BASE_TOLERANCE_METER))
+    // Below finest level or invalid
+    return nullptr;
+
+  int level = std::min(static_cast<int>(std::log2(toleranceMeter / LOD_BASE_TOLERANCE_METER)), LOD_LEVELS - 1);
+  const QVector<qint64>& sequences = simplified.at(level);
+  return sequences.isEmpty() ? nullptr : &sequences;
 }
 
 bool AircraftTrack::appendTrackPos(const atools::geo::Pos& pos, const QDateTime& timestamp, bool onGround)
@@ -120,21 +251,30 @@ bool AircraftTrack::appendTrackPos(const atools::geo::Pos& pos, const QDateTime&
     {
       if(pos.distanceMeterTo(last().pos) > atools::geo::nmToMeter(MAX_POINT_DISTANCE_NM))
       {
-        clear();
+        clearTrack();
         pruned = true;
       }
       else
       {
-        if(size() > maxTrackEntries)
+        if(numEntries >= maxTrackEntries)
         {
-          for(int i = 0; i < PRUNE_TRACK_ENTRIES; i++)
-            removeFirst();
+          // Buffer is full - drop oldest entries by moving the head
+          int numRemove = numEntries > PRUNE_TRACK_ENTRIES ? PRUNE_TRACK_ENTRIES : numEntries;
+          head = (head + numRemove) % ring.size();
+          firstSequence += numRemove;
+          numEntries -= numRemove;
+          pruneSimplified();
+          numUnsaved = std::min(numUnsaved, numEntries);
           pruned = true;
         }
       }
       append({pos, timestamp.toTime_t(), onGround});
     }
   }
+
+  if(numUnsaved >= CHUNK_TRACK_ENTRIES)
+    writeUnsaved();
+
   return pruned;
 }
 
@@ -145,3 +285,132 @@ float AircraftTrack::getMaxAltitude() const
     maxAlt = std::max(maxAlt, trackPos.pos.getAltitude());
   return maxAlt;
 }
+
+void AircraftTrack::writeUnsaved()
+{
+  if(numFileEntries < 0 || numFileEntries > maxTrackEntries * 2)
+    // File not valid or contains too many positions which are not in memory anymore
+    rewriteFile();
+  else if(numUnsaved > 0)
+  {
+    QFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
+    if(trackFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+      QDataStream out(&trackFile);
+      initStream(out);
+      writeChunk(out, numEntries - numUnsaved, numEntries);
+      trackFile.close();
+
+      if(out.status() == QDataStream::Ok)
+      {
+        numFileEntries += numUnsaved;
+        numUnsaved = 0;
+      }
+      else
+      {
+        // Might be partially written - rewrite with next attempt
+        qWarning() << "Cannot append to track" << trackFile.fileName();
+        numFileEntries = -1;
+      }
+    }
+    else
+      qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
+  }
+}
+
+void AircraftTrack::rewriteFile()
+{
+  // Write to temporary file which replaces the track file only if complete
+  QSaveFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
+
+  if(trackFile.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&trackFile);
+    initStream(out);
+
+    out << FILE_MAGIC_NUMBER << FILE_VERSION;
+    for(int i = 0; i < numEntries; i += REWRITE_CHUNK_TRACK_ENTRIES)
+      writeChunk(out, i, std::min(i + REWRITE_CHUNK_TRACK_ENTRIES, numEntries));
+
+    if(out.status() == QDataStream::Ok && trackFile.commit())
+    {
+      numFileEntries = numEntries;
+      numUnsaved = 0;
+    }
+    else
+      qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
+  }
+  else
+    qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
+}
+
+void AircraftTrack::writeChunk(QDataStream& out, int from, int to) const
+{
+  // Write positions first to get the size for the chunk header
+  QByteArray bytes;
+  QDataStream chunkOut(&bytes, QIODevice::WriteOnly);
+  initStream(chunkOut);
+  for(int i = from; i < to; i++)
+    chunkOut << at(i);
+
+  out << CHUNK_MAGIC_NUMBER << static_cast<quint32>(to - from) << at(from).timestamp << at(to - 1).timestamp
+      << static_cast<quint32>(bytes.size());
+  out.writeRawData(bytes.constData(), bytes.size());
+}
+
+quint16 AircraftTrack::readHeader(QDataStream& in, const QString& filename)
+{
+  quint32 magic;
+  quint16 version;
+  in >> magic;
+
+  if(magic == FILE_MAGIC_NUMBER)
+  {
+    in >> version;
+    if(version == FILE_VERSION || version == FILE_VERSION_LIST)
+      return version;
+    else
+      qWarning() << "Cannot read track" << filename << ". Invalid version number:" << version;
+  }
+  else
+    qWarning() << "Cannot read track" << filename << ". Invalid magic number:" << magic;
+  return 0;
+}
+
+bool AircraftTrack::readChunkIndex(QDataStream& in, QVector<ChunkIndex>& index)
+{
+  while(!in.atEnd())
+  {
+    quint32 magic;
+    ChunkIndex chunk;
+    in >> magic >> chunk.numEntries >> chunk.firstTimestamp >> chunk.lastTimestamp >> chunk.bytes;
+
+    if(in.status() != QDataStream::Ok || magic != CHUNK_MAGIC_NUMBER)
+      return false;
+
+    // Skip the positions - these are loaded on demand
+    chunk.offset = in.device()->pos();
+    if(in.skipRawData(static_cast<int>(chunk.bytes)) != static_cast<int>(chunk.bytes))
+      return false;
+
+    index.append(chunk);
+  }
+  return true;
+}
+
+void AircraftTrack::readChunk(QDataStream& in, const ChunkIndex& chunk, quint32 fromTimestamp, quint32 toTimestamp)
+{
+  in.device()->seek(chunk.offset);
+
+  at::AircraftTrackPos trackPos;
+  for(quint32 i = 0; i < chunk.numEntries; i++)
+  {
+    in >> trackPos;
+    if(in.status() != QDataStream::Ok)
+      // Do not add partially read positions
+      break;
+
+    if(trackPos.timestamp >= fromTimestamp && trackPos.timestamp <= toTimestamp)
+      append(trackPos);
+  }
+}
@@ -20,6 +20,8 @@
 
 #include "geo/pos.h"
 
+#include <QVector>
+
 namespace at {
 /* Track position. Can be converted to QVariant and thus be saved to settings */
 struct AircraftTrackPos
@@ -38,23 +40,76 @@ Q_DECLARE_TYPEINFO(at::AircraftTrackPos, Q_PRIMITIVE_TYPE);
 Q_DECLARE_METATYPE(at::AircraftTrackPos);
 
 /*
- * Stores the track of the flight simulator aircraft
+ * Stores the track of the flight simulator aircraft.
+ *
+ * Positions are kept in a ring buffer with a fixed capacity. Oldest positions are dropped in blocks if the
+ * buffer is full.
+ *
+ * The track file (little_navmap.track) is written incrementally during flight by appending chunks of new positions.
+ * Each chunk has a header with number of positions and time range which allows to skip chunks outside of a
+ * time range when loading.
+ * A crash loses only the positions which were not written yet. The file is rewritten from the buffer
+ * if it grows too large or the track was cleared.
  */
-class AircraftTrack :
-  private QList<at::AircraftTrackPos>
+class AircraftTrack
 {
 public:
   AircraftTrack();
   ~AircraftTrack();
 
-  /* Saves and restores track into a separate file (little_navmap.track) */
+  /* Iterates from oldest to latest position */
+  class const_iterator
+  {
+  public:
+    const_iterator(const AircraftTrack *trackParam, int indexParam)
+      : track(trackParam), index(indexParam)
+    {
+    }
+
+    const at::AircraftTrackPos& operator*() const
+    {
+      return track->at(index);
+    }
+
+    const at::AircraftTrackPos *operator->() const
+    {
+      return &track->at(index);
+    }
+
+    const_iterator& operator++()
+    {
+      index++;
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+      return track == other.track && index == other.index;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    const AircraftTrack *track;
+    int index;
+  };
+
+  /* Writes all positions not saved yet to the track file (little_navmap.track) */
   void saveState();
+
+  /* Loads the latest positions from the track file up to maximum number of track entries */
   void restoreState();
 
-  void clearTrack()
-  {
-    clear();
-  }
+  /* Replaces the track with the latest positions from the track file within the time range in seconds since
+   * epoch. Only chunks overlapping the range are read. Positions outside of the range are dropped from the file
+   * with the next rewrite. */
+  void load(quint32 fromTimestamp, quint32 toTimestamp);
+
+  /* Clear track and truncate file with the next write */
+  void clearTrack();
 
   /*
    * Add a track position. Accurracy depends on the ground flag which will cause more
@@ -65,26 +120,118 @@ public:
 
   float getMaxAltitude() const;
 
-  /* Pull only needed methods into public space */
-  using QList::isEmpty;
-  using QList::first;
-  using QList::last;
-  using QList::size;
-  using QList::at;
-  using QList::begin;
-  using QList::end;
+  bool isEmpty() const
+  {
+    return numEntries == 0;
+  }
+
+  int size() const
+  {
+    return numEntries;
+  }
+
+  /* Index 0 is the oldest position */
+  const at::AircraftTrackPos& at(int i) const
+  {
+    return ring.at((head + i) % ring.size());
+  }
+
+  const at::AircraftTrackPos& first() const
+  {
+    return at(0);
+  }
+
+  const at::AircraftTrackPos& last() const
+  {
+    return at(numEntries - 1);
+  }
+
+  /* Access by sequence number as used by the simplified track. Sequence numbers do not change when pruning. */
+  const at::AircraftTrackPos& atSequence(qint64 sequence) const
+  {
+    return at(static_cast<int>(sequence - firstSequence));
+  }
+
+  /*
+   * Get sequence numbers of a simplified track where consecutive positions are at least about toleranceMeter apart.
+   * The latest position is not always included.
+   * Returns null if the tolerance is below the finest level and the full track has to be used.
+   */
+  const QVector<qint64> *getSimplifiedTrack(float toleranceMeter) const;
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
 
-  void setMaxTrackEntries(int value)
+  const_iterator end() const
   {
-    maxTrackEntries = value;
+    return const_iterator(this, numEntries);
   }
 
+  /* Changes the capacity of the ring buffer and keeps the latest positions */
+  void setMaxTrackEntries(int value);
+
 private:
+  /* Header of a chunk in the track file */
+  struct ChunkIndex
+  {
+    qint64 offset; /* File offset of the positions */
+    quint32 numEntries, firstTimestamp, lastTimestamp, bytes;
+  };
+
+  void append(const at::AircraftTrackPos& trackPos);
+
+  /* Remove pruned positions from the simplified track levels */
+  void pruneSimplified();
+
+  /* Append all unsaved positions as a new chunk or rewrite the file if required */
+  void writeUnsaved();
+  void rewriteFile();
+  void writeChunk(QDataStream& out, int from, int to) const;
+
+  /* Read all chunk headers. Returns false if the file is truncated or corrupted. */
+  static bool readChunkIndex(QDataStream& in, QVector<ChunkIndex>& index);
+
+  /* Read positions of one chunk and append the ones within the time range to the ring buffer.
+   * Stops at the first position which cannot be read. */
+  void readChunk(QDataStream& in, const ChunkIndex& chunk, quint32 fromTimestamp, quint32 toTimestamp);
+
+  /* Reads magic number and version. Returns 0 if invalid. */
+  static quint16 readHeader(QDataStream& in, const QString& filename);
+
+  /* Ring buffer. Grows up to maxTrackEntries and is reused after that. */
+  QVector<at::AircraftTrackPos> ring;
+  int head = 0, numEntries = 0;
+
+  /* Sequence number of the oldest position */
+  qint64 firstSequence = 0;
+
+  /* Sequence numbers of the simplified track for each level. Level n keeps only positions which are at least
+   * LOD_BASE_TOLERANCE_METER * 2^n apart. Updated incrementally when appending. */
+  QVector<QVector<qint64> > simplified;
+
+  /* Number of latest entries in the ring not written to the file yet */
+  int numUnsaved = 0;
+
+  /* Number of entries in the file or -1 if file has to be rewritten */
+  int numFileEntries = -1;
+
   /* Maximum number of track points. If exceeded entries will be removed from beginning of the list */
   int maxTrackEntries = 20000;
   /* Number of entries to remove at once */
   static Q_DECL_CONSTEXPR int PRUNE_TRACK_ENTRIES = 200;
 
+  /* Number of new positions collected before appending a chunk to the file */
+  static Q_DECL_CONSTEXPR int CHUNK_TRACK_ENTRIES = 60;
+
+  /* Chunk size when rewriting the whole file */
+  static Q_DECL_CONSTEXPR int REWRITE_CHUNK_TRACK_ENTRIES = 1000;
+
+  /* Simplified track levels from 50 meter to 100 km */
+  static Q_DECL_CONSTEXPR int LOD_LEVELS = 12;
+  static Q_DECL_CONSTEXPR float LOD_BASE_TOLERANCE_METER = 50.f;
+
   /* Minimum time difference between recordings */
   static Q_DECL_CONSTEXPR int MIN_POSITION_TIME_DIFF_MS = 1000;
   static Q_DECL_CONSTEXPR int MIN_POSITION_TIME_DIFF_GROUND_MS = 250;
@@ -93,9 +240,12 @@ private:
   static Q_DECL_CONSTEXPR int MAX_POINT_DISTANCE_NM = 2000;
 
   static Q_DECL_CONSTEXPR quint32 FILE_MAGIC_NUMBER = 0x5B6C1A2B;
+  static Q_DECL_CONSTEXPR quint32 CHUNK_MAGIC_NUMBER = 0x4C2E8D3F;
 
   /* Version 2 to adds timstamp and single floating point precision */
-  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 2;
+  /* Version 3 uses chunks which are appended during flight */
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 3;
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION_LIST = 2;
 };
 
 #endif // LITTLENAVMAP_AIRCRAFTTRACK_H
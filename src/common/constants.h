@@ -306,6 +306,9 @@ const QLatin1Literal DATABASE_PREFIX("little_navmap_");
 const QLatin1Literal DATABASE_SUFFIX(".sqlite");
 const QLatin1Literal DATABASE_BACKUP_SUFFIX("-backup");
 
+/* Disk cache for terrain shading tiles */
+const QLatin1Literal TERRAIN_TILE_DIR("little_navmap_terrain");
+
 /* This is the default configuration file for reading the scenery library.
  * It can be overridden by placing a  file with the same name into
  * the configuration directory. */
@@ -317,6 +320,12 @@ const QString NETWORKS_CONFIG = ":/littlenavmap/resources/config/networks.cfg";
 /* Configuration for online networks */
 const QString URLS_CONFIG = ":/littlenavmap/resources/config/urls.cfg";
 
+/* Map layer definitions for zoom distances */
+const QString MAPLAYERS_CONFIG = ":/littlenavmap/resources/config/maplayers.cfg";
+
+/* Default frame script for the map rendering benchmark */
+const QString MAPBENCHMARK_CONFIG = ":/littlenavmap/resources/config/mapbenchmark.cfg";
+
 const int MAINWINDOW_STATE_VERSION = 0;
 
 /* Main window state for first startup. Generated in MainWindow::writeSettings() */
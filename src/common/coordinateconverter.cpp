@@ -20,6 +20,7 @@
 #include "atools.h"
 #include "geo/pos.h"
 #include "geo/line.h"
+#include "geo/calculations.h"
 
 #include <marble/ViewportParams.h>
 
@@ -29,6 +30,7 @@ using namespace Marble;
 using namespace atools::geo;
 
 const QSize CoordinateConverter::DEFAULT_WTOS_SIZE(100, 100);
+Q_DECL_CONSTEXPR double CoordinateConverter::INVALID_BATCH_COORD;
 
 CoordinateConverter::CoordinateConverter(const ViewportParams *viewportParams)
   : viewport(viewportParams)
@@ -221,6 +223,100 @@ QPointF CoordinateConverter::wToSF(const GeoDataCoordinates& coords, const QSize
   }
 }
 
+void CoordinateConverter::wToSBatch(const double *lonX, const double *latY, int num, double *x, double *y,
+                                    quint8 *visible, const QSize& size) const
+{
+  if(num <= 0)
+    return;
+
+  switch(viewport->projection())
+  {
+    case Marble::Spherical:
+      wToSBatchSpherical(lonX, latY, num, x, y, visible, size);
+      break;
+
+    case Marble::Mercator:
+      wToSBatchMercator(lonX, latY, num, x, y, visible, size);
+      break;
+
+    default:
+      // Use Marble projection for all others
+      for(int i = 0; i < num; i++)
+      {
+        if(std::isnan(lonX[i]) || std::isnan(latY[i]))
+        {
+          x[i] = y[i] = 0.;
+          visible[i] = 0;
+        }
+        else
+          visible[i] = wToS(Pos(lonX[i], latY[i]), x[i], y[i], size) ? 1 : 0;
+      }
+      break;
+  }
+}
+
+/* Orthographic projection. Same as rotating the quaternion around the planet axis in Marble's
+ * SphericalProjection but without the per point overhead. Points with z < 0 are behind the globe. */
+void CoordinateConverter::wToSBatchSpherical(const double *lonX, const double *latY, int num, double *x, double *y,
+                                             quint8 *visible, const QSize& size) const
+{
+  const double radius = viewport->radius();
+  const double centerLon = viewport->centerLongitude(), centerLat = viewport->centerLatitude();
+  const double sinCenterLat = std::sin(centerLat), cosCenterLat = std::cos(centerLat);
+  const double halfWidth = viewport->width() / 2., halfHeight = viewport->height() / 2.;
+  const double left = -size.width() / 2., right = viewport->width() + size.width() / 2.;
+  const double top = -size.height() / 2., bottom = viewport->height() + size.height() / 2.;
+
+  // Loop does not branch to allow vectorization by the compiler
+  for(int i = 0; i < num; i++)
+  {
+    const double lon = atools::geo::toRadians(lonX[i]) - centerLon, lat = atools::geo::toRadians(latY[i]);
+    const double sinLat = std::sin(lat), cosLat = std::cos(lat), cosLon = std::cos(lon);
+
+    const double qx = cosLat * std::sin(lon);
+    const double qy = cosCenterLat * sinLat - sinCenterLat * cosLat * cosLon;
+    const double qz = sinCenterLat * sinLat + cosCenterLat * cosLat * cosLon;
+
+    x[i] = halfWidth + radius * qx;
+    y[i] = halfHeight - radius * qy;
+    // Comparisons are always false for NaN coordinates
+    visible[i] = qz >= 0. && x[i] >= left && x[i] < right && y[i] >= top && y[i] < bottom;
+  }
+}
+
+/* Mercator projection as done in Marble's MercatorProjection. The leftmost visible repetition
+ * is used for x like in wToSInternal. */
+void CoordinateConverter::wToSBatchMercator(const double *lonX, const double *latY, int num, double *x, double *y,
+                                            quint8 *visible, const QSize& size) const
+{
+  // Maximum latitude of the Mercator projection in Marble
+  static const double MAX_LAT_RAD = atools::geo::toRadians(85.05113);
+
+  const double radius = viewport->radius();
+  const double rad2Pixel = 2. * radius / M_PI;
+  const double worldWidth = 4. * radius;
+  const double centerLon = viewport->centerLongitude();
+  const double centerLatInv = std::atanh(std::sin(viewport->centerLatitude()));
+  const double halfWidth = viewport->width() / 2., halfHeight = viewport->height() / 2.;
+  const double left = -size.width() / 2., right = viewport->width() + size.width() / 2.;
+  const double top = -size.height() / 2., bottom = viewport->height() + size.height() / 2.;
+
+  for(int i = 0; i < num; i++)
+  {
+    const double lat = std::max(-MAX_LAT_RAD, std::min(atools::geo::toRadians(latY[i]), MAX_LAT_RAD));
+    double xs = halfWidth + (atools::geo::toRadians(lonX[i]) - centerLon) * rad2Pixel;
+    y[i] = halfHeight - (std::atanh(std::sin(lat)) - centerLatInv) * rad2Pixel;
+
+    // Move to the leftmost repetition which is not left of the screen
+    double xrep = xs - std::floor((xs - left) / worldWidth) * worldWidth;
+    bool vis = xrep < right && y[i] >= top && y[i] < bottom;
+
+    // Keep the base coordinate if no repetition is visible
+    x[i] = vis ? xrep : xs;
+    visible[i] = vis;
+  }
+}
+
 bool CoordinateConverter::sToW(int x, int y, Marble::GeoDataCoordinates& coords) const
 {
   qreal lon, lat;
@@ -22,6 +22,9 @@
 
 #include <QPoint>
 #include <QSize>
+#include <QVector>
+
+#include <limits>
 
 namespace Marble {
 class ViewportParams;
@@ -34,6 +37,52 @@ class Line;
 }
 }
 
+/*
+ * Contiguous buffers for the batch world to screen conversion. Can be reused between calls to
+ * avoid reallocation. visible is 1 if the coordinate is visible and not hidden behind the globe.
+ */
+struct ScreenPointBatch
+{
+  QVector<double> lonX, latY; /* Input coordinates in degree */
+  QVector<double> x, y; /* Resulting screen coordinates */
+  QVector<quint8> visible; /* Visibility mask */
+
+  void resize(int num)
+  {
+    lonX.resize(num);
+    latY.resize(num);
+    x.resize(num);
+    y.resize(num);
+    visible.resize(num);
+  }
+
+  int size() const
+  {
+    return visible.size();
+  }
+
+  bool isVisible(int i) const
+  {
+    return visible.at(i) > 0;
+  }
+
+  int xInt(int i) const
+  {
+    return static_cast<int>(std::round(x.at(i)));
+  }
+
+  int yInt(int i) const
+  {
+    return static_cast<int>(std::round(y.at(i)));
+  }
+
+  QPointF pointF(int i) const
+  {
+    return QPointF(x.at(i), y.at(i));
+  }
+
+};
+
 /*
  * Converter for screen and world coordinates.
  */
@@ -105,6 +154,53 @@ public:
   bool wToS(const atools::geo::Line& coords, QLineF& line, const QSize& size = DEFAULT_WTOS_SIZE,
             bool *isHidden = nullptr) const;
 
+  /*
+   * Convert an array of world coordinates to screen coordinates at once. Uses dedicated loops for the
+   * spherical and Mercator projections which avoid the detour through GeoDataCoordinates and Marble's projection
+   * classes. All other projections fall back to the single point conversion.
+   * @param lonX longitude array in degree
+   * @param latY latitude array in degree
+   * @param num number of coordinates in all arrays
+   * @param x resulting screen coordinates
+   * @param y resulting screen coordinates
+   * @param visible resulting mask which is 1 if coordinate is visible and not hidden.
+   * Always 0 for coordinates set to INVALID_BATCH_COORD.
+   * @param size estimated screen size for Mercator projection
+   */
+  void wToSBatch(const double *lonX, const double *latY, int num, double *x, double *y, quint8 *visible,
+                 const QSize& size = DEFAULT_WTOS_SIZE) const;
+
+  /* Convert all positions in a list of Pos like LineString and fill the batch buffers */
+  template<typename CONTAINER>
+  void wToSBatchPos(const CONTAINER& positions, ScreenPointBatch& batch, const QSize& size = DEFAULT_WTOS_SIZE) const
+  {
+    batch.resize(positions.size());
+    double *lonX = batch.lonX.data(), *latY = batch.latY.data();
+    for(const auto& pos : positions)
+    {
+      *lonX++ = pos.isValid() ? pos.getLonX() : INVALID_BATCH_COORD;
+      *latY++ = pos.isValid() ? pos.getLatY() : INVALID_BATCH_COORD;
+    }
+    wToSBatch(batch.lonX.constData(), batch.latY.constData(), batch.size(),
+              batch.x.data(), batch.y.data(), batch.visible.data(), size);
+  }
+
+  /* Convert the position of all map objects in the list. TYPE needs a "position" member of type Pos. */
+  template<typename TYPE>
+  void wToSBatch(const QList<TYPE>& objects, ScreenPointBatch& batch, const QSize& size = DEFAULT_WTOS_SIZE) const
+  {
+    batch.resize(objects.size());
+    double *lonX = batch.lonX.data(), *latY = batch.latY.data();
+    for(const TYPE& obj : objects)
+    {
+      // NaN for invalid positions results in invisible points
+      *lonX++ = obj.position.isValid() ? obj.position.getLonX() : INVALID_BATCH_COORD;
+      *latY++ = obj.position.isValid() ? obj.position.getLatY() : INVALID_BATCH_COORD;
+    }
+    wToSBatch(batch.lonX.constData(), batch.latY.constData(), batch.size(),
+              batch.x.data(), batch.y.data(), batch.visible.data(), size);
+  }
+
   bool sToW(int x, int y, Marble::GeoDataCoordinates& coords) const;
 
   /* Converte screen to world coordinates */
@@ -113,6 +209,14 @@ public:
   atools::geo::Pos sToW(const QPoint& point) const;
   atools::geo::Pos sToW(const QPointF& point) const;
 
+  const Marble::ViewportParams *getViewport() const
+  {
+    return viewport;
+  }
+
+  /* Marks invalid coordinates in batch conversion input */
+  static Q_DECL_CONSTEXPR double INVALID_BATCH_COORD = std::numeric_limits<double>::quiet_NaN();
+
   /* Shortcuts for more readable code */
   static Q_DECL_CONSTEXPR Marble::GeoDataCoordinates::Unit DEG = Marble::GeoDataCoordinates::Degree;
   static Q_DECL_CONSTEXPR Marble::GeoDataCoordinates::BearingType INITBRG =
@@ -124,6 +228,12 @@ private:
   bool wToSInternal(const Marble::GeoDataCoordinates& coords, double& x, double& y, const QSize& size,
                     bool *isHidden) const;
 
+  /* Batch kernels for the two most used projections */
+  void wToSBatchSpherical(const double *lonX, const double *latY, int num, double *x, double *y,
+                          quint8 *visible, const QSize& size) const;
+  void wToSBatchMercator(const double *lonX, const double *latY, int num, double *x, double *y,
+                         quint8 *visible, const QSize& size) const;
+
   const Marble::ViewportParams *viewport;
 
 };
@@ -18,6 +18,8 @@
 #include "common/elevationprovider.h"
 
 #include "navapp.h"
+#include "common/elevationpyramid.h"
+#include "common/globemappedreader.h"
 #include "fs/common/globereader.h"
 #include "options/optiondata.h"
 #include "geo/line.h"
@@ -25,14 +27,18 @@
 #include "geo/pos.h"
 #include "gui/dialog.h"
 #include "geo/calculations.h"
+#include "settings/settings.h"
 
 #include <marble/GeoDataCoordinates.h>
 #include <marble/ElevationModel.h>
 
 #include <QMessageBox>
+#include <QtConcurrent/QtConcurrentRun>
 
 /* Limt altitude to this value */
 static Q_DECL_CONSTEXPR float ALTITUDE_LIMIT_METER = 8800.f;
+/* Lines are split into chunks of this length to skip sea areas in corridors */
+static Q_DECL_CONSTEXPR float CORRIDOR_CHUNK_METER = 50000.f;
 /* Point removal equality tolerance in meter */
 static Q_DECL_CONSTEXPR float SAME_ONLINE_ELEVATION_EPSILON = 1.f;
 
@@ -44,7 +50,7 @@ using atools::fs::common::GlobeReader;
 using namespace Marble;
 
 ElevationProvider::ElevationProvider(QObject *parent, const Marble::ElevationModel *model)
-  : QObject(parent), marbleModel(model)
+  : QObject(parent), marbleModel(model), pyramidCancel(false)
 {
   // Marble will let us know when updates are available
   connect(marbleModel, &ElevationModel::updateAvailable, this, &ElevationProvider::marbleUpdateAvailable);
@@ -53,6 +59,7 @@ ElevationProvider::ElevationProvider(QObject *parent, const Marble::ElevationMod
 
 ElevationProvider::~ElevationProvider()
 {
+  cancelPyramid();
   delete globeReader;
 }
 
@@ -64,9 +71,18 @@ void ElevationProvider::marbleUpdateAvailable()
 
 float ElevationProvider::getElevationMeter(const atools::geo::Pos& pos)
 {
+  // Lock free access to mapped files
+  std::shared_ptr<const GlobeMappedReader> reader = std::atomic_load(&mappedReader);
+  if(reader != nullptr)
+    return std::min(reader->getElevation(pos), ALTITUDE_LIMIT_METER);
+
+  // Take a snapshot of both readers since the mapped reader might have changed after the check above
   QMutexLocker locker(&mutex);
+  reader = std::atomic_load(&mappedReader);
+  if(reader != nullptr)
+    return std::min(reader->getElevation(pos), ALTITUDE_LIMIT_METER);
 
-  if(isGlobeOfflineProvider())
+  if(globeReader != nullptr)
   {
     float elevation = globeReader->getElevation(pos);
     if(!(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID))
@@ -83,9 +99,24 @@ void ElevationProvider::getElevations(atools::geo::LineString& elevations, const
   if(!line.isValid())
     return;
 
+  // Lock free access to mapped files
+  std::shared_ptr<const GlobeMappedReader> reader = std::atomic_load(&mappedReader);
+  if(reader != nullptr)
+  {
+    getMappedElevations(*reader, elevations, line);
+    return;
+  }
+
+  // Take a snapshot of both readers since the mapped reader might have changed after the check above
   QMutexLocker locker(&mutex);
+  reader = std::atomic_load(&mappedReader);
+  if(reader != nullptr)
+  {
+    getMappedElevations(*reader, elevations, line);
+    return;
+  }
 
-  if(isGlobeOfflineProvider())
+  if(globeReader != nullptr)
   {
     globeReader->getElevations(elevations, LineString(line.getPos1(), line.getPos2()));
     for(Pos& pos : elevations)
@@ -141,6 +172,67 @@ void ElevationProvider::getElevations(atools::geo::LineString& elevations, const
     pos.setAltitude(std::min(pos.getAltitude(), ALTITUDE_LIMIT_METER));
 }
 
+void ElevationProvider::getMappedElevations(const GlobeMappedReader& reader, atools::geo::LineString& elevations,
+                                            const atools::geo::Line& line)
+{
+  int start = elevations.size();
+  reader.getElevations(elevations, line);
+  for(int i = start; i < elevations.size(); i++)
+    // Limit ground altitude
+    elevations[i].setAltitude(std::min(elevations.at(i).getAltitude(), ALTITUDE_LIMIT_METER));
+}
+
+bool ElevationProvider::getElevations(float *elevations, const float *lonX, const float *latY, int size) const
+{
+  std::shared_ptr<const GlobeMappedReader> reader = std::atomic_load(&mappedReader);
+  if(reader == nullptr)
+    return false;
+
+  reader->getElevations(elevations, lonX, latY, size);
+  for(int i = 0; i < size; i++)
+    // Limit ground altitude
+    elevations[i] = std::min(elevations[i], ALTITUDE_LIMIT_METER);
+  return true;
+}
+
+bool ElevationProvider::getCorridorElevations(atools::geo::LineString& elevations, const atools::geo::Line& line,
+                                              float corridorMeter) const
+{
+  std::shared_ptr<const GlobeMappedReader> reader = std::atomic_load(&mappedReader);
+  if(reader == nullptr)
+    return false;
+
+  if(!line.isValid())
+    return true;
+
+  std::shared_ptr<const ElevationPyramid> pyr = std::atomic_load(&pyramid);
+
+  float lengthMeter = line.lengthMeter();
+  int numChunks = std::max(1, static_cast<int>(std::ceil(lengthMeter / CORRIDOR_CHUNK_METER)));
+  int start = elevations.size();
+  Pos chunkStart = line.getPos1();
+  for(int i = 1; i <= numChunks; i++)
+  {
+    Pos chunkEnd = i == numChunks ? line.getPos2() :
+                   line.getPos1().interpolate(line.getPos2(), lengthMeter, static_cast<float>(i) / numChunks);
+
+    if(pyr != nullptr && pyr->getMaxElevation(LineString(chunkStart, chunkEnd), corridorMeter) < 1.f)
+    {
+      // Only sea in this part of the corridor
+      elevations.append(Pos(chunkStart.getLonX(), chunkStart.getLatY(), 0.f));
+      elevations.append(Pos(chunkEnd.getLonX(), chunkEnd.getLatY(), 0.f));
+    }
+    else
+      reader->getCorridorElevations(elevations, Line(chunkStart, chunkEnd), corridorMeter);
+    chunkStart = chunkEnd;
+  }
+
+  for(int i = start; i < elevations.size(); i++)
+    // Limit ground altitude
+    elevations[i].setAltitude(std::min(elevations.at(i).getAltitude(), ALTITUDE_LIMIT_METER));
+  return true;
+}
+
 bool ElevationProvider::isGlobeDirectoryValid(const QString& path) const
 {
   // Checks for files and more
@@ -154,8 +246,68 @@ void ElevationProvider::optionsChanged()
   updateReader();
 }
 
+void ElevationProvider::startPyramid(const std::shared_ptr<const GlobeMappedReader>& reader)
+{
+  QString filename = atools::settings::Settings::getConfigFilename(".globemax");
+  QString key = reader->getDataDir();
+
+  pyramidFuture = QtConcurrent::run([this, reader, filename, key]() -> void
+  {
+    std::shared_ptr<ElevationPyramid> pyr = std::make_shared<ElevationPyramid>();
+    if(!pyr->loadCache(filename, key))
+    {
+      qDebug() << Q_FUNC_INFO << "Building elevation pyramid";
+      if(!pyr->build(*reader, pyramidCancel))
+        return;
+
+      pyr->saveCache(filename, key);
+      qDebug() << Q_FUNC_INFO << "Building elevation pyramid done";
+    }
+
+    std::atomic_store(&pyramid, std::shared_ptr<const ElevationPyramid>(pyr));
+
+    // Queued to receivers in the main thread
+    emit pyramidAvailable();
+  });
+}
+
+void ElevationProvider::requestPyramid()
+{
+  if(pyramidRequested)
+    return;
+
+  std::shared_ptr<const GlobeMappedReader> reader = std::atomic_load(&mappedReader);
+  if(reader != nullptr)
+  {
+    pyramidRequested = true;
+    startPyramid(reader);
+  }
+}
+
+bool ElevationProvider::getMaxElevation(float& elevationMeter, const atools::geo::LineString& line,
+                                        float corridorMeter) const
+{
+  std::shared_ptr<const ElevationPyramid> pyr = std::atomic_load(&pyramid);
+  if(pyr == nullptr)
+    return false;
+
+  elevationMeter = std::min(pyr->getMaxElevation(line, corridorMeter), ALTITUDE_LIMIT_METER);
+  return true;
+}
+
+void ElevationProvider::cancelPyramid()
+{
+  pyramidCancel = true;
+  pyramidFuture.waitForFinished();
+  pyramidCancel = false;
+  std::atomic_store(&pyramid, std::shared_ptr<const ElevationPyramid>());
+}
+
 void ElevationProvider::updateReader()
 {
+  cancelPyramid();
+  pyramidRequested = false;
+
   if(OptionData::instance().getFlags() & opts::CACHE_USE_OFFLINE_ELEVATION)
   {
     const QString& path = OptionData::instance().getOfflineElevationPath();
@@ -168,16 +320,30 @@ void ElevationProvider::updateReader()
     else
     {
       delete globeReader;
-      globeReader = new GlobeReader(path);
-      {
-        qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
+      globeReader = nullptr;
 
-        if(!globeReader->openFiles())
+      // Try memory mapped files first
+      std::shared_ptr<GlobeMappedReader> reader = std::make_shared<GlobeMappedReader>(path);
+      if(reader->openFiles())
+      {
+        qDebug() << Q_FUNC_INFO << "Using memory mapped GLOBE files";
+        std::atomic_store(&mappedReader, std::shared_ptr<const GlobeMappedReader>(reader));
+      }
+      else
+      {
+        // Mapping failed - e.g. due to limited address space - fall back to reading files
+        std::atomic_store(&mappedReader, std::shared_ptr<const GlobeMappedReader>());
+        globeReader = new GlobeReader(path);
         {
-          NavApp::deleteSplashScreen();
-          atools::gui::Dialog::warning(NavApp::getQMainWidget(),
-                                       tr("Cannot open GLOBE data in directory<br/><i>%1</i>").arg(path));
-          qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
+          qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
+
+          if(!globeReader->openFiles())
+          {
+            NavApp::deleteSplashScreen();
+            atools::gui::Dialog::warning(NavApp::getQMainWidget(),
+                                         tr("Cannot open GLOBE data in directory<br/><i>%1</i>").arg(path));
+            qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
+          }
         }
       }
     }
@@ -186,6 +352,7 @@ void ElevationProvider::updateReader()
   {
     delete globeReader;
     globeReader = nullptr;
+    std::atomic_store(&mappedReader, std::shared_ptr<const GlobeMappedReader>());
   }
 
   emit updateAvailable();
@@ -18,9 +18,13 @@
 #ifndef LITTLENAVMAP_ELEVATIONPROVIDER_H
 #define LITTLENAVMAP_ELEVATIONPROVIDER_H
 
+#include <QFuture>
 #include <QMutex>
 #include <QObject>
 
+#include <atomic>
+#include <memory>
+
 namespace Marble {
 class ElevationModel;
 }
@@ -39,10 +43,19 @@ class Line;
 }
 }
 
+class GlobeMappedReader;
+class ElevationPyramid;
+
 /*
  * Wraps the slow Marble online elevation provider and the fast offline GLOBE data provider.
  * Use GLOBE data if all paramters are set properly in settings.
  *
+ * GLOBE data is read from memory mapped files without locking if mapping is possible. Otherwise
+ * all calls are serialized.
+ *
+ * A pyramid of maximum elevation can be built in background from the mapped files and cached on disk. It allows
+ * fast queries for the highest terrain along lines and corridors. It is loaded only after requestPyramid().
+ *
  * Class is thread safe.
  */
 class ElevationProvider :
@@ -61,10 +74,34 @@ public:
    * consecutive ones with same elevation. Elevation given in meter */
   void getElevations(atools::geo::LineString& elevations, const atools::geo::Line& line);
 
+  /* Get highest elevation across a corridor of corridorMeter to each side along a great circle line.
+   * Parts of the line where the elevation pyramid shows no terrain in the corridor are not sampled.
+   * Elevation given in meter. Returns false if the memory mapped GLOBE data is not used. */
+  bool getCorridorElevations(atools::geo::LineString& elevations, const atools::geo::Line& line,
+                             float corridorMeter) const;
+
+  /* Highest terrain in meter within corridorMeter along the line string from the elevation pyramid.
+   * Result is conservative. Returns false if the pyramid is not loaded yet. Thread safe and lock free. */
+  bool getMaxElevation(float& elevationMeter, const atools::geo::LineString& line, float corridorMeter) const;
+
+  /* Load or build the elevation pyramid in background if memory mapped GLOBE data is used and not done yet.
+   * Sends pyramidAvailable when done. Call from main thread only. */
+  void requestPyramid();
+
+  /* Get elevations in meter for size coordinates in degree. Returns false if the memory mapped GLOBE data
+   * is not used. Thread safe and lock free. */
+  bool getElevations(float *elevations, const float *lonX, const float *latY, int size) const;
+
+  /* true if getCorridorElevations() and the batch getElevations() can be used */
+  bool isMappedGlobeProvider() const
+  {
+    return std::atomic_load(&mappedReader) != nullptr;
+  }
+
   /* true if the data is provided from the fast offline source */
   bool isGlobeOfflineProvider() const
   {
-    return globeReader != nullptr;
+    return globeReader != nullptr || std::atomic_load(&mappedReader) != nullptr;
   }
 
   /* True if directory is valid and contains at least one valid GLOBE file */
@@ -77,13 +114,36 @@ signals:
    * for at least one that was queried before. Only sent for online data. */
   void updateAvailable();
 
+  /* Elevation pyramid was loaded or built after requestPyramid(). Elevation data itself did not change. */
+  void pyramidAvailable();
+
 private:
   void marbleUpdateAvailable();
   void updateReader();
 
+  /* Load pyramid from cache or build it in background */
+  void startPyramid(const std::shared_ptr<const GlobeMappedReader>& reader);
+  void cancelPyramid();
+
+  /* Append elevations for line from the mapped reader and limit them */
+  static void getMappedElevations(const GlobeMappedReader& reader, atools::geo::LineString& elevations,
+                                  const atools::geo::Line& line);
+
   const Marble::ElevationModel *marbleModel = nullptr;
   atools::fs::common::GlobeReader *globeReader = nullptr;
 
+  /* Used instead of globeReader if all files could be mapped. Accessed only by std::atomic_load and
+   * std::atomic_store to allow exchanging the reader while other threads still use the old one. */
+  std::shared_ptr<const GlobeMappedReader> mappedReader;
+
+  /* Maximum elevation pyramid. Also accessed only by std::atomic_load and std::atomic_store. */
+  std::shared_ptr<const ElevationPyramid> pyramid;
+  QFuture<void> pyramidFuture;
+  std::atomic<bool> pyramidCancel;
+
+  /* Pyramid was requested for the current mapped reader */
+  bool pyramidRequested = false;
+
   /* Need to synchronize here since it is called from profile widget thread */
   mutable QMutex mutex;
 
@@ -0,0 +1,241 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/elevationpyramid.h"
+
+#include "common/globemappedreader.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/pos.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float METER_PER_DEGREE = 111319.5f;
+
+}
+
+ElevationPyramid::ElevationPyramid()
+{
+
+}
+
+ElevationPyramid::~ElevationPyramid()
+{
+
+}
+
+bool ElevationPyramid::build(const GlobeMappedReader& reader, const std::atomic<bool>& cancel)
+{
+  levels.clear();
+
+  // Base level from the GLOBE grid ===================================
+  Level base;
+  base.columns = GlobeMappedReader::GRID_COLUMNS / BASE_BLOCK;
+  base.rows = GlobeMappedReader::GRID_ROWS / BASE_BLOCK;
+  base.values.fill(std::numeric_limits<qint16>::min(), base.columns * base.rows);
+
+  for(int y = 0; y < GlobeMappedReader::GRID_ROWS; y++)
+  {
+    if(cancel)
+      return false;
+
+    qint16 *row = base.values.data() + (y / BASE_BLOCK) * base.columns;
+    for(int x = 0; x < GlobeMappedReader::GRID_COLUMNS; x++)
+    {
+      qint16 value = static_cast<qint16>(reader.getGridValue(x, y));
+      qint16& cell = row[x / BASE_BLOCK];
+      if(value > cell)
+        cell = value;
+    }
+  }
+  levels.append(base);
+
+  // Upper levels each with the maximum of 2 x 2 cells ===================================
+  while(levels.last().columns > 1 || levels.last().rows > 1)
+  {
+    const Level& lower = levels.last();
+    Level upper;
+    upper.columns = (lower.columns + 1) / 2;
+    upper.rows = (lower.rows + 1) / 2;
+    upper.values.fill(std::numeric_limits<qint16>::min(), upper.columns * upper.rows);
+
+    for(int y = 0; y < lower.rows; y++)
+    {
+      for(int x = 0; x < lower.columns; x++)
+      {
+        qint16& cell = upper.values[(y / 2) * upper.columns + x / 2];
+        cell = std::max(cell, lower.values.at(y * lower.columns + x));
+      }
+    }
+    levels.append(upper);
+  }
+  return true;
+}
+
+bool ElevationPyramid::loadCache(const QString& filename, const QString& key)
+{
+  levels.clear();
+
+  QFile file(filename);
+  if(file.exists() && file.open(QIODevice::ReadOnly))
+  {
+    QDataStream in(&file);
+    quint32 magic;
+    quint16 version;
+    QString fileKey;
+    int numLevels;
+    in >> magic >> version >> fileKey >> numLevels;
+
+    if(magic == FILE_MAGIC_NUMBER && version == FILE_VERSION && fileKey == key)
+    {
+      for(int i = 0; i < numLevels && in.status() == QDataStream::Ok; i++)
+      {
+        Level level;
+        in >> level.columns >> level.rows >> level.values;
+        levels.append(level);
+      }
+
+      if(in.status() != QDataStream::Ok)
+      {
+        qWarning() << Q_FUNC_INFO << "Cannot read" << filename;
+        levels.clear();
+      }
+    }
+    file.close();
+  }
+  return isValid();
+}
+
+bool ElevationPyramid::saveCache(const QString& filename, const QString& key) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out << static_cast<quint32>(FILE_MAGIC_NUMBER) << static_cast<quint16>(FILE_VERSION) << key << levels.size();
+    for(const Level& level : levels)
+      out << level.columns << level.rows << level.values;
+
+    if(out.status() == QDataStream::Ok && file.commit())
+      return true;
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+float ElevationPyramid::getMaxElevation(const atools::geo::Pos& pos, float radiusMeter) const
+{
+  float latDelta = radiusMeter / METER_PER_DEGREE;
+  float cosLat = std::cos(atools::geo::toRadians(pos.getLatY()));
+  float lonDelta = cosLat > 0.01f ? std::min(latDelta / cosLat, 180.f) : 180.f;
+
+  return maxElevationForBox(pos.getLonX() - lonDelta, pos.getLatY() + latDelta,
+                            pos.getLonX() + lonDelta, pos.getLatY() - latDelta);
+}
+
+float ElevationPyramid::getMaxElevation(const atools::geo::LineString& line, float corridorMeter) const
+{
+  float maxElevation = 0.f;
+  if(line.size() == 1)
+    maxElevation = getMaxElevation(line.first(), corridorMeter);
+
+  for(int i = 1; i < line.size(); i++)
+  {
+    const atools::geo::Pos& p1 = line.at(i - 1), & p2 = line.at(i);
+    float lengthMeter = p1.distanceMeterTo(p2);
+
+    // Cover the segment with boxes - boxes get larger for long segments to limit the number of queries
+    int numBoxes = static_cast<int>(std::ceil(lengthMeter / std::max(corridorMeter * 2.f, 1000.f)));
+    numBoxes = std::min(std::max(numBoxes, 1), static_cast<int>(MAX_LINE_BOXES));
+    float stepMeter = lengthMeter / numBoxes;
+
+    for(int j = 0; j <= numBoxes; j++)
+    {
+      atools::geo::Pos pos = p1.interpolate(p2, lengthMeter, static_cast<float>(j) / numBoxes);
+      maxElevation = std::max(maxElevation, getMaxElevation(pos, corridorMeter + stepMeter / 2.f));
+    }
+  }
+  return maxElevation;
+}
+
+float ElevationPyramid::maxElevationForBox(float west, float north, float east, float south) const
+{
+  if(levels.isEmpty())
+    return 0.f;
+
+  north = std::min(north, 90.f);
+  south = std::max(south, -90.f);
+
+  if(east - west >= 360.f)
+  {
+    west = -180.f;
+    east = 180.f;
+  }
+  else
+  {
+    // Normalize west to -180 to 180 and split at the anti-meridian
+    while(west < -180.f)
+    {
+      west += 360.f;
+      east += 360.f;
+    }
+    while(west >= 180.f)
+    {
+      west -= 360.f;
+      east -= 360.f;
+    }
+
+    if(east > 180.f)
+      return std::max(maxElevationForBox(west, north, 180.f, south),
+                      maxElevationForBox(-180.f, north, east - 360.f, south));
+  }
+
+  // Select level where the box covers only a few cells
+  const float baseCellDegree = static_cast<float>(BASE_BLOCK) / GlobeMappedReader::GRID_PER_DEGREE;
+  float spanCells = std::max(east - west, north - south) / baseCellDegree;
+  int levelIndex = 0;
+  while(levelIndex < levels.size() - 1 && spanCells > MAX_QUERY_CELLS)
+  {
+    levelIndex++;
+    spanCells /= 2.f;
+  }
+
+  const Level& level = levels.at(levelIndex);
+  float cellDegree = baseCellDegree * (1 << levelIndex);
+  int x0 = std::max(static_cast<int>((west + 180.f) / cellDegree), 0);
+  int x1 = std::min(static_cast<int>((east + 180.f) / cellDegree), level.columns - 1);
+  int y0 = std::max(static_cast<int>((90.f - north) / cellDegree), 0);
+  int y1 = std::min(static_cast<int>((90.f - south) / cellDegree), level.rows - 1);
+
+  qint16 maxValue = std::numeric_limits<qint16>::min();
+  for(int y = y0; y <= y1; y++)
+  {
+    for(int x = x0; x <= x1; x++)
+      maxValue = std::max(maxValue, level.values.at(y * level.columns + x));
+  }
+  return std::max(static_cast<float>(maxValue), 0.f);
+}
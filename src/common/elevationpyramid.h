@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_ELEVATIONPYRAMID_H
+#define LITTLENAVMAP_ELEVATIONPYRAMID_H
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+namespace atools {
+namespace geo {
+class Pos;
+class LineString;
+}
+}
+
+class GlobeMappedReader;
+
+/*
+ * Pyramid of maximum elevation built from the GLOBE data. The base level holds the maximum of 16 x 16 GLOBE grid
+ * points (8 arc minutes) and each further level the maximum of 2 x 2 cells of the level below.
+ *
+ * Queries for the highest terrain in an area pick the level where the area covers only a few cells.
+ * Results are conservative: the terrain can be lower but never higher than returned.
+ *
+ * Read only after building or loading. Queries are thread safe.
+ */
+class ElevationPyramid
+{
+public:
+  ElevationPyramid();
+  ~ElevationPyramid();
+
+  /* Build all levels from the memory mapped GLOBE files. Reads all data and takes a few seconds.
+   * Returns false if cancel was set. */
+  bool build(const GlobeMappedReader& reader, const std::atomic<bool>& cancel);
+
+  /* Load or save the pyramid from a cache file. key has to match the one used for saving. */
+  bool loadCache(const QString& filename, const QString& key);
+  bool saveCache(const QString& filename, const QString& key) const;
+
+  bool isValid() const
+  {
+    return !levels.isEmpty();
+  }
+
+  /* Highest terrain in meter within radiusMeter around pos */
+  float getMaxElevation(const atools::geo::Pos& pos, float radiusMeter) const;
+
+  /* Highest terrain in meter within corridorMeter of all great circle segments of the line string */
+  float getMaxElevation(const atools::geo::LineString& line, float corridorMeter) const;
+
+private:
+  struct Level
+  {
+    int columns, rows;
+    QVector<qint16> values; /* Row major from north west */
+  };
+
+  /* Highest terrain in a box given in degree. Longitudes can be outside of -180 to 180. */
+  float maxElevationForBox(float west, float north, float east, float south) const;
+
+  QVector<Level> levels;
+
+  /* Base level cell size in GLOBE grid points */
+  static Q_DECL_CONSTEXPR int BASE_BLOCK = 16;
+
+  /* A query box covers not more than this number of cells in each direction */
+  static Q_DECL_CONSTEXPR int MAX_QUERY_CELLS = 4;
+
+  /* Maximum number of boxes along a line segment */
+  static Q_DECL_CONSTEXPR int MAX_LINE_BOXES = 256;
+
+  static Q_DECL_CONSTEXPR quint32 FILE_MAGIC_NUMBER = 0x2D8E4A71;
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 1;
+};
+
+#endif // LITTLENAVMAP_ELEVATIONPYRAMID_H
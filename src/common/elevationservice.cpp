@@ -0,0 +1,211 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/elevationservice.h"
+
+#include "common/elevationprovider.h"
+
+#include <QDebug>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <cmath>
+
+using atools::geo::Pos;
+
+/* Positions are snapped to this grid - four times the GLOBE resolution of 30 arc seconds */
+static Q_DECL_CONSTEXPR int KEY_PER_DEGREE = 480;
+static Q_DECL_CONSTEXPR quint64 KEY_COLUMNS = 360 * KEY_PER_DEGREE;
+
+/* Number of cached positions */
+static Q_DECL_CONSTEXPR int CACHE_SIZE = 200000;
+
+ElevationService::ElevationService(QObject *parent, ElevationProvider *elevationProvider)
+  : QObject(parent), provider(elevationProvider)
+{
+  cache.setMaxCost(CACHE_SIZE);
+
+  batchTimer.setSingleShot(true);
+  batchTimer.setInterval(0);
+  connect(&batchTimer, &QTimer::timeout, this, &ElevationService::startBatch);
+  connect(&watcher, &QFutureWatcher<Batch>::finished, this, &ElevationService::batchFinished);
+
+  // Elevation source or options changed
+  connect(provider, &ElevationProvider::updateAvailable, this, &ElevationService::clearCache);
+}
+
+ElevationService::~ElevationService()
+{
+  qDebug() << Q_FUNC_INFO << "cache hit rate" << getCacheHitRate() << "hits" << cacheHits << "misses" << cacheMisses;
+
+  batchTimer.stop();
+  watcher.waitForFinished();
+}
+
+quint64 ElevationService::requestElevations(const atools::geo::LineString& positions)
+{
+  queuedRequests.append({nextRequestId, positions});
+
+  // Coalesce all requests of this event loop iteration - next batch is started when the running one finishes
+  if(!watcher.isRunning() && !batchTimer.isActive())
+    batchTimer.start();
+  return nextRequestId++;
+}
+
+void ElevationService::cancelRequest(quint64 requestId)
+{
+  auto pred = [requestId](const Request& request) -> bool
+              {
+                return request.id == requestId;
+              };
+
+  queuedRequests.erase(std::remove_if(queuedRequests.begin(), queuedRequests.end(), pred), queuedRequests.end());
+  runningRequests.erase(std::remove_if(runningRequests.begin(), runningRequests.end(), pred),
+                        runningRequests.end());
+}
+
+void ElevationService::clearCache()
+{
+  cache.clear();
+  generation++;
+}
+
+float ElevationService::getCacheHitRate() const
+{
+  quint64 total = cacheHits + cacheMisses;
+  return total > 0 ? static_cast<float>(cacheHits) / static_cast<float>(total) : 0.f;
+}
+
+void ElevationService::startBatch()
+{
+  if(watcher.isRunning() || queuedRequests.isEmpty())
+    return;
+
+  runningRequests.swap(queuedRequests);
+  queuedRequests.clear();
+
+  Batch batch;
+  batch.generation = generation;
+
+  // Keys already added to this batch
+  QSet<quint64> batchKeys;
+
+  for(Request& request : runningRequests)
+  {
+    for(Pos& pos : request.positions)
+    {
+      if(!pos.isValid())
+        continue;
+
+      quint64 key = positionKey(pos);
+      const float *elevation = cache.object(key);
+      if(elevation != nullptr)
+      {
+        // Resolve cached value right away
+        pos.setAltitude(*elevation);
+        cacheHits++;
+      }
+      else if(batchKeys.contains(key))
+        cacheHits++;
+      else
+      {
+        Pos keyPos = keyPosition(key);
+        batchKeys.insert(key);
+        batch.keys.append(key);
+        batch.lonX.append(keyPos.getLonX());
+        batch.latY.append(keyPos.getLatY());
+        cacheMisses++;
+      }
+    }
+  }
+
+  // Provider access is lock free for memory mapped files and serialized by the provider otherwise
+  watcher.setFuture(QtConcurrent::run(&ElevationService::calculateBatch, provider, batch));
+}
+
+ElevationService::Batch ElevationService::calculateBatch(ElevationProvider *provider, Batch batch)
+{
+  int size = batch.keys.size();
+  batch.elevations.resize(size);
+
+  // Use lock free batch lookup if possible - otherwise the provider serializes access
+  if(!provider->getElevations(batch.elevations.data(), batch.lonX.constData(), batch.latY.constData(), size))
+  {
+    for(int i = 0; i < size; i++)
+      batch.elevations[i] = provider->getElevationMeter(Pos(batch.lonX.at(i), batch.latY.at(i)));
+  }
+  return batch;
+}
+
+void ElevationService::batchFinished()
+{
+  Batch batch = watcher.result();
+
+  if(batch.generation == generation)
+  {
+    for(int i = 0; i < batch.keys.size(); i++)
+      cache.insert(batch.keys.at(i), new float(batch.elevations.at(i)));
+  }
+
+  finishRequests(batch);
+
+  // Requests which arrived in the meantime
+  startBatch();
+}
+
+void ElevationService::finishRequests(const Batch& batch)
+{
+  QHash<quint64, float> batchElevations;
+  batchElevations.reserve(batch.keys.size());
+  for(int i = 0; i < batch.keys.size(); i++)
+    batchElevations.insert(batch.keys.at(i), batch.elevations.at(i));
+
+  // Copy since receivers might add or cancel requests
+  QVector<Request> requests;
+  requests.swap(runningRequests);
+
+  for(Request& request : requests)
+  {
+    for(Pos& pos : request.positions)
+    {
+      if(pos.isValid())
+      {
+        auto it = batchElevations.constFind(positionKey(pos));
+        if(it != batchElevations.constEnd())
+          pos.setAltitude(it.value());
+      }
+    }
+    emit elevationsAvailable(request.id, request.positions);
+  }
+}
+
+quint64 ElevationService::positionKey(const atools::geo::Pos& pos)
+{
+  quint64 x = static_cast<quint64>(std::min(std::max(static_cast<int>(std::round((pos.getLonX() + 180.f) *
+                                                                                   KEY_PER_DEGREE)), 0),
+                                             static_cast<int>(KEY_COLUMNS) - 1));
+  quint64 y = static_cast<quint64>(std::max(static_cast<int>(std::round((pos.getLatY() + 90.f) * KEY_PER_DEGREE)),
+                                            0));
+  return y * KEY_COLUMNS + x;
+}
+
+atools::geo::Pos ElevationService::keyPosition(quint64 key)
+{
+  return Pos(static_cast<float>(key % KEY_COLUMNS) / KEY_PER_DEGREE - 180.f,
+             static_cast<float>(key / KEY_COLUMNS) / KEY_PER_DEGREE - 90.f);
+}
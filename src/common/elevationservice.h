@@ -0,0 +1,114 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_ELEVATIONSERVICE_H
+#define LITTLENAVMAP_ELEVATIONSERVICE_H
+
+#include "geo/linestring.h"
+
+#include <QCache>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QTimer>
+
+class ElevationProvider;
+
+/*
+ * Asynchronous elevation queries on top of the ElevationProvider.
+ *
+ * Requests are queued and all requests arriving within one event loop iteration are coalesced into one batch
+ * which is calculated in a background thread. Positions are snapped to a grid of a quarter GLOBE cell. Equal
+ * positions are only looked up once per batch and the results are kept in a cache shared by all callers.
+ *
+ * Results are delivered in the main thread by the signal elevationsAvailable.
+ * Must be used from the main thread only.
+ */
+class ElevationService :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  ElevationService(QObject *parent, ElevationProvider *elevationProvider);
+  virtual ~ElevationService();
+
+  /* Queue query for all positions. Returns the id used in elevationsAvailable.
+   * Result contains the positions with altitude in meter and in the same order. */
+  quint64 requestElevations(const atools::geo::LineString& positions);
+  quint64 requestElevation(const atools::geo::Pos& pos)
+  {
+    return requestElevations(atools::geo::LineString({pos}));
+  }
+
+  /* Result for this request will not be sent */
+  void cancelRequest(quint64 requestId);
+
+  /* Drop cached values. Results of a running batch are still delivered but not cached.
+   * Called when the elevation source changes. */
+  void clearCache();
+
+  /* Ratio of positions found in the cache or already queued in the same batch to all requested positions.
+   * 0 to 1. */
+  float getCacheHitRate() const;
+
+signals:
+  /* Sent for each request once its batch is finished. Altitude is given in meter. */
+  void elevationsAvailable(quint64 requestId, const atools::geo::LineString& elevations);
+
+private:
+  struct Request
+  {
+    quint64 id;
+    atools::geo::LineString positions;
+  };
+
+  /* Work package for the background thread */
+  struct Batch
+  {
+    QVector<quint64> keys; /* Cache key for each position */
+    QVector<float> lonX, latY, elevations; /* Snapped coordinates and result in meter */
+    int generation = 0; /* Results are not cached if cache was cleared in the meantime */
+  };
+
+  void startBatch();
+  void batchFinished();
+  void finishRequests(const Batch& batch);
+
+  static Batch calculateBatch(ElevationProvider *provider, Batch batch);
+
+  /* Snapped position key. Quarter of a GLOBE cell is about 230 meters. */
+  static quint64 positionKey(const atools::geo::Pos& pos);
+  static atools::geo::Pos keyPosition(quint64 key);
+
+  ElevationProvider *provider;
+
+  /* Waiting for the next batch and requests of the running batch */
+  QVector<Request> queuedRequests, runningRequests;
+
+  /* Elevation in meter by position key */
+  QCache<quint64, float> cache;
+
+  QFutureWatcher<Batch> watcher;
+
+  /* Zero interval timer to coalesce requests */
+  QTimer batchTimer;
+
+  quint64 nextRequestId = 1L, cacheHits = 0L, cacheMisses = 0L;
+  int generation = 0;
+};
+
+#endif // LITTLENAVMAP_ELEVATIONSERVICE_H
@@ -0,0 +1,253 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/globemappedreader.h"
+
+#include "geo/calculations.h"
+#include "geo/line.h"
+#include "geo/linestring.h"
+#include "geo/pos.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/* First global row and number of rows for each of the four latitude bands */
+const int BAND_START_ROW[4] = {0, 4800, 10800, 16800};
+const int BAND_ROWS[4] = {4800, 6000, 6000, 4800};
+
+/* Number of points processed at once in batch methods */
+const int BATCH_SIZE = 256;
+
+const float METER_PER_DEGREE = 111319.5f;
+
+int bandForRow(int y)
+{
+  return y < BAND_START_ROW[1] ? 0 : (y < BAND_START_ROW[2] ? 1 : (y < BAND_START_ROW[3] ? 2 : 3));
+}
+
+}
+
+GlobeMappedReader::GlobeMappedReader(const QString& dataDirParam)
+  : dataDir(dataDirParam)
+{
+
+}
+
+GlobeMappedReader::~GlobeMappedReader()
+{
+  for(Tile& tile : tiles)
+  {
+    if(tile.file != nullptr)
+    {
+      // Unmaps memory
+      tile.file->close();
+      delete tile.file;
+    }
+  }
+}
+
+bool GlobeMappedReader::openFiles()
+{
+  for(int i = 0; i < 16; i++)
+  {
+    // Files are named a10g to p10g
+    QString filename = QDir(dataDir).filePath(QString(QChar('a' + i)) + "10g");
+    qint64 expectedSize = static_cast<qint64>(TILE_COLUMNS) * BAND_ROWS[i / 4] * 2;
+
+    Tile& tile = tiles[i];
+    tile.file = new QFile(filename);
+    if(!tile.file->open(QIODevice::ReadOnly))
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot open" << filename << tile.file->errorString();
+      return false;
+    }
+
+    if(tile.file->size() != expectedSize)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid size" << filename << tile.file->size();
+      return false;
+    }
+
+    // File can be closed after mapping but keep it for unmapping
+    tile.data = tile.file->map(0, expectedSize);
+    if(tile.data == nullptr)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot map" << filename << tile.file->errorString();
+      return false;
+    }
+  }
+  return true;
+}
+
+float GlobeMappedReader::getGridValue(int x, int y) const
+{
+  int band = bandForRow(y);
+  const Tile& tile = tiles[band * 4 + x / TILE_COLUMNS];
+  if(tile.data == nullptr)
+    return 0.f;
+
+  // Row major 16 bit little endian values
+  qint64 index = static_cast<qint64>(y - BAND_START_ROW[band]) * TILE_COLUMNS + x % TILE_COLUMNS;
+  qint16 value = qFromLittleEndian<qint16>(tile.data + index * 2);
+  return value == GLOBE_OCEAN ? 0.f : static_cast<float>(value);
+}
+
+float GlobeMappedReader::getElevation(const atools::geo::Pos& pos) const
+{
+  float lonX = pos.getLonX(), latY = pos.getLatY(), elevation;
+  getElevations(&elevation, &lonX, &latY, 1);
+  return elevation;
+}
+
+void GlobeMappedReader::getElevations(float *elevations, const float *lonX, const float *latY, int size) const
+{
+  int x0[BATCH_SIZE], y0[BATCH_SIZE];
+  float wx[BATCH_SIZE], wy[BATCH_SIZE], v00[BATCH_SIZE], v10[BATCH_SIZE], v01[BATCH_SIZE], v11[BATCH_SIZE];
+
+  for(int start = 0; start < size; start += BATCH_SIZE)
+  {
+    int num = std::min(BATCH_SIZE, size - start);
+    const float *lon = lonX + start, *lat = latY + start;
+
+    // Grid coordinates and weights - grid points are at the center of each cell
+    for(int i = 0; i < num; i++)
+    {
+      float fx = (lon[i] + 180.f) * GRID_PER_DEGREE - 0.5f;
+      float fy = (90.f - lat[i]) * GRID_PER_DEGREE - 0.5f;
+      float flx = std::floor(fx), fly = std::floor(fy);
+      wx[i] = fx - flx;
+      wy[i] = fy - fly;
+      x0[i] = static_cast<int>(flx);
+      y0[i] = static_cast<int>(fly);
+    }
+
+    // Fetch the four neighbors - wrap around at the anti-meridian and clamp at the poles
+    for(int i = 0; i < num; i++)
+    {
+      int xa = (x0[i] % GRID_COLUMNS + GRID_COLUMNS) % GRID_COLUMNS;
+      int xb = (xa + 1) % GRID_COLUMNS;
+      int ya = std::min(std::max(y0[i], 0), GRID_ROWS - 1);
+      int yb = std::min(std::max(y0[i] + 1, 0), GRID_ROWS - 1);
+      v00[i] = getGridValue(xa, ya);
+      v10[i] = getGridValue(xb, ya);
+      v01[i] = getGridValue(xa, yb);
+      v11[i] = getGridValue(xb, yb);
+    }
+
+    // Bilinear interpolation
+    float *result = elevations + start;
+    for(int i = 0; i < num; i++)
+    {
+      float top = v00[i] + (v10[i] - v00[i]) * wx[i];
+      float bottom = v01[i] + (v11[i] - v01[i]) * wx[i];
+      result[i] = top + (bottom - top) * wy[i];
+    }
+  }
+}
+
+void GlobeMappedReader::getElevations(atools::geo::LineString& elevations, const atools::geo::Line& line) const
+{
+  using atools::geo::Pos;
+
+  float lengthMeter = line.lengthMeter();
+  int num = std::max(2, static_cast<int>(std::ceil(lengthMeter / SAMPLE_DISTANCE_METER)) + 1);
+
+  // Collect positions along the great circle in structure of arrays layout
+  QVector<Pos> positions;
+  QVector<float> lonX, latY, alt(num);
+  positions.reserve(num);
+  lonX.reserve(num);
+  latY.reserve(num);
+  for(int i = 0; i < num; i++)
+  {
+    Pos pos = line.getPos1().interpolate(line.getPos2(), lengthMeter, static_cast<float>(i) / (num - 1));
+    positions.append(pos);
+    lonX.append(pos.getLonX());
+    latY.append(pos.getLatY());
+  }
+
+  getElevations(alt.data(), lonX.constData(), latY.constData(), num);
+
+  // Remove consecutive points with same elevation but keep the last one of a stretch
+  for(int i = 0; i < num; i++)
+  {
+    bool same = i > 0 && i < num - 1 && alt.at(i) == alt.at(i - 1) && alt.at(i) == alt.at(i + 1);
+    if(!same)
+      elevations.append(Pos(positions.at(i).getLonX(), positions.at(i).getLatY(), alt.at(i)));
+  }
+}
+
+void GlobeMappedReader::getCorridorElevations(atools::geo::LineString& elevations, const atools::geo::Line& line,
+                                              float corridorMeter) const
+{
+  using atools::geo::Pos;
+
+  float lengthMeter = line.lengthMeter();
+  int num = std::max(2, static_cast<int>(std::ceil(lengthMeter / SAMPLE_DISTANCE_METER)) + 1);
+
+  // Crosswise offsets in meter - same for all stations
+  int numSide = std::max(1, static_cast<int>(std::ceil(corridorMeter / CORRIDOR_SAMPLE_METER)));
+  int numCross = numSide * 2 + 1;
+  QVector<float> offsets(numCross), lonX(numCross), latY(numCross), alt(numCross);
+  for(int k = 0; k < numCross; k++)
+    offsets[k] = corridorMeter * (k - numSide) / numSide;
+
+  QVector<Pos> positions;
+  QVector<float> maxAlt;
+  positions.reserve(num);
+  maxAlt.reserve(num);
+
+  float course = line.getPos1().angleDegTo(line.getPos2());
+  for(int i = 0; i < num; i++)
+  {
+    Pos pos = line.getPos1().interpolate(line.getPos2(), lengthMeter, static_cast<float>(i) / (num - 1));
+    if(i < num - 1)
+      // Keep course of the previous station for the last one
+      course = pos.angleDegTo(line.getPos2());
+
+    // Offsets perpendicular to the course in a local flat approximation which is good enough for a few miles
+    float perpendicular = atools::geo::toRadians(course + 90.f);
+    float latFactor = std::cos(perpendicular) / METER_PER_DEGREE;
+    float lonFactor = std::sin(perpendicular) /
+                      (METER_PER_DEGREE * std::max(std::cos(atools::geo::toRadians(pos.getLatY())), 0.01f));
+    for(int k = 0; k < numCross; k++)
+    {
+      lonX[k] = pos.getLonX() + offsets.at(k) * lonFactor;
+      latY[k] = pos.getLatY() + offsets.at(k) * latFactor;
+    }
+
+    getElevations(alt.data(), lonX.constData(), latY.constData(), numCross);
+
+    positions.append(pos);
+    maxAlt.append(*std::max_element(alt.constBegin(), alt.constEnd()));
+  }
+
+  // Remove consecutive points with same elevation but keep the last one of a stretch
+  for(int i = 0; i < num; i++)
+  {
+    bool same = i > 0 && i < num - 1 && maxAlt.at(i) == maxAlt.at(i - 1) && maxAlt.at(i) == maxAlt.at(i + 1);
+    if(!same)
+      elevations.append(Pos(positions.at(i).getLonX(), positions.at(i).getLatY(), maxAlt.at(i)));
+  }
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_GLOBEMAPPEDREADER_H
+#define LITTLENAVMAP_GLOBEMAPPEDREADER_H
+
+#include <QString>
+#include <QVector>
+
+class QFile;
+
+namespace atools {
+namespace geo {
+class Pos;
+class Line;
+class LineString;
+}
+}
+
+/*
+ * Reads GLOBE elevation data (tiles a10g to p10g) from memory mapped files.
+ *
+ * All data is read only once the files are opened. Methods are const and can be called concurrently
+ * from any number of threads without locking.
+ *
+ * Elevation is interpolated bilinear between the four nearest grid points. Ocean is returned as zero.
+ * Batch methods use a structure of arrays layout which allows the compiler to vectorize index
+ * calculation and interpolation.
+ */
+class GlobeMappedReader
+{
+public:
+  GlobeMappedReader(const QString& dataDirParam);
+  ~GlobeMappedReader();
+
+  /* Map all tiles into memory. Returns false if a tile is missing or cannot be mapped. */
+  bool openFiles();
+
+  /* Elevation in meter. Thread safe. */
+  float getElevation(const atools::geo::Pos& pos) const;
+
+  /* Get elevations in meter for size coordinates in degree. Thread safe. */
+  void getElevations(float *elevations, const float *lonX, const float *latY, int size) const;
+
+  /* Get elevations along a great circle line with a point every SAMPLE_DISTANCE_METER.
+   * Consecutive points with the same elevation are removed. Elevation given in meter. Thread safe. */
+  void getElevations(atools::geo::LineString& elevations, const atools::geo::Line& line) const;
+
+  /* Get the highest elevation across a corridor of corridorMeter to each side of a great circle line.
+   * Stations are placed like in getElevations() and each one is sampled crosswise every CORRIDOR_SAMPLE_METER.
+   * Consecutive points with the same elevation are removed. Elevation given in meter. Thread safe. */
+  void getCorridorElevations(atools::geo::LineString& elevations, const atools::geo::Line& line,
+                             float corridorMeter) const;
+
+  /* Raw value in meter at global grid coordinates. x from west, y from north. Ocean is zero. */
+  float getGridValue(int x, int y) const;
+
+  const QString& getDataDir() const
+  {
+    return dataDir;
+  }
+
+  /* Grid points per degree (30 arc seconds) */
+  static Q_DECL_CONSTEXPR int GRID_PER_DEGREE = 120;
+  static Q_DECL_CONSTEXPR int GRID_COLUMNS = 360 * GRID_PER_DEGREE;
+  static Q_DECL_CONSTEXPR int GRID_ROWS = 180 * GRID_PER_DEGREE;
+
+private:
+  /* One GLOBE file covering 90 degree longitude */
+  struct Tile
+  {
+    QFile *file = nullptr;
+    const uchar *data = nullptr;
+  };
+
+  QString dataDir;
+
+  /* Tiles ordered from north west to south east in rows of four */
+  Tile tiles[16];
+
+  static Q_DECL_CONSTEXPR int TILE_COLUMNS = 90 * GRID_PER_DEGREE;
+
+  /* Distance between points along lines */
+  static Q_DECL_CONSTEXPR float SAMPLE_DISTANCE_METER = 500.f;
+
+  /* Distance between points across corridors */
+  static Q_DECL_CONSTEXPR float CORRIDOR_SAMPLE_METER = 500.f;
+
+  /* Value for ocean in the GLOBE files */
+  static Q_DECL_CONSTEXPR qint16 GLOBE_OCEAN = -500;
+};
+
+#endif // LITTLENAVMAP_GLOBEMAPPEDREADER_H
@@ -1736,6 +1736,23 @@ void HtmlInfoBuilder::waypointText(const MapWaypoint& waypoint, HtmlBuilder& htm
 }
 
 void HtmlInfoBuilder::bearingText(const atools::geo::Pos& pos, float magVar, HtmlBuilder& html) const
+{
+  if(showBearing)
+    bearingRow(pos, magVar, html);
+}
+
+void HtmlInfoBuilder::bearingTextTable(const atools::geo::Pos& pos, float magVar, HtmlBuilder& html) const
+{
+  if(!pos.isValid() || !NavApp::isConnectedAndAircraft())
+    return;
+
+  HtmlBuilder row(html.cleared());
+  bearingRow(pos, magVar, row);
+  if(!row.isEmpty())
+    html.table().textHtml(row).tableEnd();
+}
+
+void HtmlInfoBuilder::bearingRow(const atools::geo::Pos& pos, float magVar, HtmlBuilder& html) const
 {
   const atools::fs::sc::SimConnectUserAircraft& userAircraft = NavApp::getUserAircraft();
 
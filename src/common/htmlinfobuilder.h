@@ -259,6 +259,16 @@ public:
   void aircraftOnlineText(const atools::fs::sc::SimConnectAircraft& aircraft, const atools::sql::SqlRecord& onlineRec,
                           atools::util::HtmlBuilder& html);
 
+  /* Separate table with bearing and distance to the simulator aircraft if connected and close enough.
+   * Used to add the bearing to texts created with setBearingText(false). */
+  void bearingTextTable(const atools::geo::Pos& pos, float magVar, atools::util::HtmlBuilder& html) const;
+
+  /* Omit bearing and distance to the simulator aircraft in airport and navaid texts if false. Default is true. */
+  void setBearingText(bool value)
+  {
+    showBearing = value;
+  }
+
   void setSymbolSize(const QSize& value)
   {
     symbolSize = value;
@@ -286,8 +296,9 @@ private:
   void addCoordinates(const atools::sql::SqlRecord *rec, atools::util::HtmlBuilder& html) const;
   void addCoordinates(const atools::geo::Pos& pos, atools::util::HtmlBuilder& html) const;
 
-  /* Bearing to simulator aircraft if connected */
+  /* Bearing to simulator aircraft if connected and not disabled by setBearingText() */
   void bearingText(const atools::geo::Pos& pos, float magVar, atools::util::HtmlBuilder& html) const;
+  void bearingRow(const atools::geo::Pos& pos, float magVar, atools::util::HtmlBuilder& html) const;
 
   void navaidTitle(atools::util::HtmlBuilder& html, const QString& text) const;
 
@@ -355,7 +366,7 @@ private:
   AirportQuery *airportQuerySim, *airportQueryNav;
   InfoQuery *infoQuery;
   atools::fs::util::MorseCode *morse;
-  bool info, print;
+  bool info, print, showBearing = true;
   QLocale locale;
 };
 
@@ -83,6 +83,7 @@ QColor compassRoseTextColor(Qt::black);
 /* Elevation profile colors and pens */
 QColor profileSkyColor(QColor(204, 204, 255));
 QColor profileLandColor(QColor(0, 128, 0));
+QColor profileLandCorridorColor(QColor(128, 170, 110));
 QColor profileLabelColor(QColor(0, 0, 0));
 
 QColor profileVasiAboveColor(QColor("#70ffffff"));
@@ -97,6 +98,8 @@ QPen profileWaypointLinePen(Qt::gray, 1, Qt::SolidLine, Qt::FlatCap);
 QPen profileElevationScalePen(Qt::gray, 1, Qt::SolidLine, Qt::FlatCap);
 QPen profileSafeAltLinePen(Qt::red, 4, Qt::SolidLine, Qt::FlatCap);
 QPen profileSafeAltLegLinePen(QColor(255, 100, 0), 3, Qt::SolidLine, Qt::FlatCap);
+QPen profilePredictionPen(QColor(0, 0, 0), 2, Qt::DashLine, Qt::FlatCap);
+QColor profileTerrainConflictColor(Qt::red);
 
 /* Objects highlighted because of selection in search */
 QColor highlightBackColor(Qt::black);
@@ -605,6 +608,7 @@ void syncColors()
   colorSettings.beginGroup("Profile");
   syncColor(colorSettings, "SkyColor", profileSkyColor);
   syncColor(colorSettings, "LandColor", profileLandColor);
+  syncColor(colorSettings, "LandCorridorColor", profileLandCorridorColor);
   syncColor(colorSettings, "LabelColor", profileLabelColor);
   syncColorArgb(colorSettings, "VasiAboveColor", profileVasiAboveColor);
   syncColorArgb(colorSettings, "VasiBelowColor", profileVasiBelowColor);
@@ -615,6 +619,8 @@ void syncColors()
   syncPen(colorSettings, "ElevationScalePen", profileElevationScalePen);
   syncPen(colorSettings, "SafeAltLinePen", profileSafeAltLinePen);
   syncPen(colorSettings, "SafeAltLegLinePen", profileSafeAltLegLinePen);
+  syncPen(colorSettings, "PredictionPen", profilePredictionPen);
+  syncColor(colorSettings, "TerrainConflictColor", profileTerrainConflictColor);
   syncPen(colorSettings, "VasiCenterPen", profileVasiCenterPen);
   colorSettings.endGroup();
 
@@ -84,6 +84,7 @@ extern QColor minimumAltitudeNumberColor;
 /* Elevation profile colors and pens */
 extern QColor profileSkyColor;
 extern QColor profileLandColor;
+extern QColor profileLandCorridorColor;
 extern QColor profileLabelColor;
 extern QColor profileVasiAboveColor;
 extern QColor profileVasiBelowColor;
@@ -96,6 +97,8 @@ extern QPen profileWaypointLinePen;
 extern QPen profileElevationScalePen;
 extern QPen profileSafeAltLinePen;
 extern QPen profileSafeAltLegLinePen;
+extern QPen profilePredictionPen;
+extern QColor profileTerrainConflictColor;
 
 /* Objects highlighted because of selection in search */
 extern QColor highlightBackColor;
@@ -101,7 +101,8 @@ enum MapObjectDisplayType
 {
   DISPLAY_TYPE_NONE = 0,
   AIRPORT_WEATHER = 1 << 0, /* Airport weather icons */
-  MINIMUM_ALTITUDE = 1 << 1 /* MORA (minimum off route altitude) */
+  MINIMUM_ALTITUDE = 1 << 1, /* MORA (minimum off route altitude) */
+  TERRAIN_SHADING = 1 << 2 /* Hillshade and elevation tints from offline GLOBE data */
 };
 
 Q_DECLARE_FLAGS(MapObjectDisplayTypes, MapObjectDisplayType);
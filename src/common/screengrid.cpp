@@ -0,0 +1,169 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/screengrid.h"
+
+#include <QLine>
+
+#include <algorithm>
+#include <cmath>
+
+ScreenGrid::ScreenGrid(int cellSizePixel)
+  : cellSize(std::max(cellSizePixel, 1))
+{
+
+}
+
+void ScreenGrid::reset(const QRect& screenRect, int margin)
+{
+  clear();
+
+  rect = screenRect.normalized().adjusted(-margin, -margin, margin, margin);
+  columns = rect.width() / cellSize + 1;
+  rows = rect.height() / cellSize + 1;
+  cells.resize(columns * rows);
+}
+
+void ScreenGrid::clear()
+{
+  cells.clear();
+  largeObjects.clear();
+  rect = QRect();
+  columns = rows = numEntries = 0;
+}
+
+void ScreenGrid::insertCell(int index, int column, int row)
+{
+  QVector<int>& cell = cells[row * columns + column];
+
+  // Objects are inserted one after the other - avoid duplicates from neighboring line segments
+  if(cell.isEmpty() || cell.last() != index)
+  {
+    cell.append(index);
+    numEntries++;
+  }
+}
+
+void ScreenGrid::insert(int index, int x, int y)
+{
+  if(isValid() && rect.contains(x, y))
+    insertCell(index, column(x), row(y));
+}
+
+void ScreenGrid::insert(int index, const QLine& line)
+{
+  if(!isValid())
+    return;
+
+  // Clip line to grid rectangle using Liang-Barsky to avoid walking along long off-screen lines
+  double x1 = line.x1(), y1 = line.y1(), dx = line.dx(), dy = line.dy();
+  double t0 = 0., t1 = 1.;
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {x1 - rect.left(), rect.right() - x1, y1 - rect.top(), rect.bottom() - y1};
+
+  for(int i = 0; i < 4; i++)
+  {
+    if(p[i] == 0.)
+    {
+      // Parallel to edge and outside
+      if(q[i] < 0.)
+        return;
+    }
+    else
+    {
+      double t = q[i] / p[i];
+      if(p[i] < 0.)
+        t0 = std::max(t0, t);
+      else
+        t1 = std::min(t1, t);
+
+      if(t0 > t1)
+        return;
+    }
+  }
+
+  // Walk along the clipped line in steps of half a cell and add the bounding cells of each step
+  double length = std::max(std::abs(dx), std::abs(dy)) * (t1 - t0);
+  int steps = static_cast<int>(length / (cellSize / 2.)) + 1;
+  int lastColumn = column(static_cast<int>(x1 + dx * t0)), lastRow = row(static_cast<int>(y1 + dy * t0));
+
+  for(int i = 1; i <= steps; i++)
+  {
+    double t = t0 + (t1 - t0) * i / steps;
+    int col = column(static_cast<int>(x1 + dx * t)), rw = row(static_cast<int>(y1 + dy * t));
+
+    for(int c = std::min(col, lastColumn); c <= std::max(col, lastColumn); c++)
+    {
+      for(int r = std::min(rw, lastRow); r <= std::max(rw, lastRow); r++)
+        insertCell(index, std::min(std::max(c, 0), columns - 1), std::min(std::max(r, 0), rows - 1));
+    }
+
+    lastColumn = col;
+    lastRow = rw;
+  }
+}
+
+void ScreenGrid::insert(int index, const QRect& objRect)
+{
+  if(!isValid())
+    return;
+
+  QRect clipped = objRect.normalized().intersected(rect);
+  if(clipped.isEmpty())
+    return;
+
+  int col1 = column(clipped.left()), col2 = column(clipped.right());
+  int row1 = row(clipped.top()), row2 = row(clipped.bottom());
+
+  if((col2 - col1 + 1) * (row2 - row1 + 1) > MAX_RECT_CELLS)
+  {
+    // Too large - would fill too many cells
+    largeObjects.append(index);
+    numEntries++;
+  }
+  else
+  {
+    for(int r = row1; r <= row2; r++)
+    {
+      for(int c = col1; c <= col2; c++)
+        insertCell(index, c, r);
+    }
+  }
+}
+
+void ScreenGrid::getNearest(int x, int y, int maxDistance, QVector<int>& indexes) const
+{
+  indexes = largeObjects;
+
+  if(!isValid())
+    return;
+
+  QRect search = QRect(x - maxDistance, y - maxDistance, maxDistance * 2 + 1, maxDistance * 2 + 1).intersected(rect);
+
+  if(!search.isEmpty())
+  {
+    for(int r = row(search.top()); r <= row(search.bottom()); r++)
+    {
+      for(int c = column(search.left()); c <= column(search.right()); c++)
+        indexes.append(cells.at(r * columns + c));
+    }
+  }
+
+  // Restore original order of objects and remove duplicates from lines and rectangles spanning several cells
+  std::sort(indexes.begin(), indexes.end());
+  indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+}
@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_SCREENGRID_H
+#define LITTLENAVMAP_SCREENGRID_H
+
+#include <QRect>
+#include <QVector>
+
+class QLine;
+
+/*
+ * Uniform grid of buckets in screen coordinates. Allows to find objects near a screen position like the
+ * mouse cursor by looking only at the few cells around it instead of iterating over all objects.
+ *
+ * Stores only indexes into an external list of objects which must not change while the grid is in use.
+ * Cells may contain objects which are not near the position. Exact distance has to be checked by the caller.
+ */
+class ScreenGrid
+{
+public:
+  explicit ScreenGrid(int cellSizePixel = DEFAULT_CELL_SIZE);
+
+  /* Remove all objects and set the covered screen rectangle which is enlarged by margin on all sides.
+   * Objects outside are ignored. */
+  void reset(const QRect& screenRect, int margin = 0);
+
+  /* Remove all objects and the rectangle. */
+  void clear();
+
+  /* Add object with index at a point */
+  void insert(int index, int x, int y);
+
+  /* Add object with index to all cells touched by line */
+  void insert(int index, const QLine& line);
+
+  /* Add object with index to all cells covered by the rectangle like the bounding rectangle of a polygon */
+  void insert(int index, const QRect& rect);
+
+  /* Get indexes of all objects in cells within maxDistance of x/y.
+   * indexes is cleared first and returned sorted in ascending order without duplicates. */
+  void getNearest(int x, int y, int maxDistance, QVector<int>& indexes) const;
+
+  bool isEmpty() const
+  {
+    return numEntries == 0;
+  }
+
+  /* Grid is set up and covers a screen rectangle */
+  bool isValid() const
+  {
+    return !cells.isEmpty();
+  }
+
+  static Q_DECL_CONSTEXPR int DEFAULT_CELL_SIZE = 32;
+
+  /* Rectangles covering more cells are kept in a separate list which is returned for all queries */
+  static Q_DECL_CONSTEXPR int MAX_RECT_CELLS = 64;
+
+private:
+  void insertCell(int index, int column, int row);
+
+  int column(int x) const
+  {
+    return (x - rect.left()) / cellSize;
+  }
+
+  int row(int y) const
+  {
+    return (y - rect.top()) / cellSize;
+  }
+
+  /* Cells in row major order */
+  QVector<QVector<int> > cells;
+
+  /* Objects covering too many cells */
+  QVector<int> largeObjects;
+
+  QRect rect;
+  int cellSize, columns = 0, rows = 0, numEntries = 0;
+};
+
+#endif // LITTLENAVMAP_SCREENGRID_H
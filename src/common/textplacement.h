@@ -99,6 +99,17 @@ public:
     return startPoints;
   }
 
+  /* Exchange painter and converter to allow reuse of calculated positions in later paint events */
+  void setPainter(QPainter *painterParam)
+  {
+    painter = painterParam;
+  }
+
+  void setConverter(CoordinateConverter *coordinateConverter)
+  {
+    converter = coordinateConverter;
+  }
+
   /* Arrows are prepended or appendend to the given text depending on direction */
   void setArrowRight(const QString& value)
   {
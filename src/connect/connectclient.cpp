@@ -29,6 +29,7 @@
 #include "settings/settings.h"
 #include "fs/sc/simconnecthandler.h"
 #include "fs/sc/xpconnecthandler.h"
+#include "connect/flightrecorder.h"
 
 #include <QDataStream>
 #include <QTcpSocket>
@@ -70,6 +71,12 @@ ConnectClient::ConnectClient(MainWindow *parent)
   connect(dataReader, &DataReaderThread::disconnectedFromSimulator, this,
           &ConnectClient::disconnectedFromSimulatorDirect);
 
+  // Replayed packets are passed on like the ones received from the simulator
+  flightRecorder = new FlightRecorder(this);
+  connect(flightRecorder, &FlightRecorder::replayPacket, this, &ConnectClient::dataPacketReceived);
+  connect(flightRecorder, &FlightRecorder::replayStarted, this, &ConnectClient::replayStarted);
+  connect(flightRecorder, &FlightRecorder::replayStopped, this, &ConnectClient::replayStopped);
+
   dialog = new ConnectDialog(mainWindow, simConnectHandler->isLoaded());
   connect(dialog, &ConnectDialog::directUpdateRateChanged, this, &ConnectClient::directUpdateRateChanged);
   connect(dialog, &ConnectDialog::fetchOptionsChanged, this, &ConnectClient::fetchOptionsChanged);
@@ -105,6 +112,9 @@ ConnectClient::~ConnectClient()
 
   qDebug() << Q_FUNC_INFO << "delete dialog";
   delete dialog;
+
+  qDebug() << Q_FUNC_INFO << "delete flightRecorder";
+  delete flightRecorder;
 }
 
 void ConnectClient::flushQueuedRequests()
@@ -179,6 +189,10 @@ void ConnectClient::connectedToSimulatorDirect()
 {
   qDebug() << Q_FUNC_INFO;
 
+  // Live data takes precedence over a replay
+  if(flightRecorder->isReplaying())
+    flightRecorder->pauseReplay();
+
   mainWindow->setConnectionStatusMessageText(tr("Connected (%1)").arg(simShortName()),
                                              tr("Connected to local flight simulator (%1).").arg(simName()));
   dialog->setConnected(isConnected());
@@ -227,6 +241,8 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
   if(NavApp::getOnlinedataController()->isShadowAircraft(userAircraft))
     userAircraft.setFlags(atools::fs::sc::SIM_ONLINE_SHADOW | userAircraft.getFlags());
 
+  flightRecorder->recordPacket(dataPacket);
+
   emit dataPacketReceived(dataPacket);
 
   if(!dataPacket.getMetars().isEmpty())
@@ -483,9 +499,35 @@ void ConnectClient::connectInternal()
   }
 }
 
+bool ConnectClient::startReplay()
+{
+  if((socket != nullptr && socket->isOpen()) || (dataReader != nullptr && dataReader->isConnected()))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot replay while connected to a simulator";
+    return false;
+  }
+
+  flightRecorder->startReplay();
+  return true;
+}
+
+void ConnectClient::replayStarted()
+{
+  mainWindow->setConnectionStatusMessageText(tr("Replay"), tr("Replaying recorded flight."));
+  emit connectedToSimulator();
+}
+
+void ConnectClient::replayStopped()
+{
+  mainWindow->setConnectionStatusMessageText(tr("Disconnected"), tr("Replay stopped."));
+  emit disconnectedFromSimulator();
+}
+
 bool ConnectClient::isConnected() const
 {
-  if(dataReader != nullptr)
+  if(flightRecorder != nullptr && flightRecorder->isReplaying())
+    return true;
+  else if(dataReader != nullptr)
     return (socket != nullptr && socket->isOpen()) || dataReader->isConnected();
   else
     return socket != nullptr && socket->isOpen();
@@ -633,6 +675,10 @@ void ConnectClient::connectedToServerSocket()
   socketConnected = true;
   reconnectNetworkTimer.stop();
 
+  // Live data takes precedence over a replay
+  if(flightRecorder->isReplaying())
+    flightRecorder->pauseReplay();
+
   mainWindow->setConnectionStatusMessageText(tr("Connected"),
                                              tr("Connected to remote flight simulator on \"%1\".").
                                              arg(socket->peerName()));
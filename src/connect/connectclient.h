@@ -29,6 +29,7 @@
 class QTcpSocket;
 class ConnectDialog;
 class MainWindow;
+class FlightRecorder;
 
 namespace atools {
 namespace fs {
@@ -83,6 +84,16 @@ public:
   bool isFetchAiShip() const;
   bool isFetchAiAircraft() const;
 
+  /* Start or resume replay of the flight recording opened in the recorder. Returns false and does nothing
+   * if connected to a simulator or Little Navconnect. */
+  bool startReplay();
+
+  /* Records received packets or replays them through dataPacketReceived */
+  FlightRecorder *getFlightRecorder() const
+  {
+    return flightRecorder;
+  }
+
 signals:
   /* Emitted when new data was received from the server (Little Navconnect), SimConnect or X-Plane.
    * can be aircraft position or weather update */
@@ -119,6 +130,8 @@ private:
   void writeReplyToSocket(atools::fs::sc::SimConnectReply& reply);
   void disconnectClicked();
   void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
+  void replayStarted();
+  void replayStopped();
   void postLogMessage(QString message, bool warning);
   void connectedToSimulatorDirect();
   void disconnectedFromSimulatorDirect();
@@ -140,6 +153,7 @@ private:
   atools::fs::sc::DataReaderThread *dataReader = nullptr;
   atools::fs::sc::SimConnectHandler *simConnectHandler = nullptr;
   atools::fs::sc::XpConnectHandler *xpConnectHandler = nullptr;
+  FlightRecorder *flightRecorder = nullptr;
 
   /* Have to keep it since it is read multiple times */
   atools::fs::sc::SimConnectData *simConnectData = nullptr;
@@ -0,0 +1,318 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/flightrecorder.h"
+
+#include "fs/sc/simconnectdata.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QTextStream>
+
+#include <algorithm>
+
+using atools::fs::sc::SimConnectData;
+
+FlightRecorder::FlightRecorder(QObject *parent)
+  : QObject(parent)
+{
+  replayTimer.setSingleShot(true);
+  connect(&replayTimer, &QTimer::timeout, this, &FlightRecorder::replayTimeout);
+
+  flushTimer.setInterval(FLUSH_INTERVAL_MS);
+  connect(&flushTimer, &QTimer::timeout, this, [this]()
+  {
+    if(isRecording())
+      recordFile.flush();
+  });
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  // No signals on shutdown
+  replayTimer.stop();
+  replaying = false;
+  stopRecording();
+  recordFile.close();
+}
+
+bool FlightRecorder::startRecording(const QString& filename)
+{
+  closeReplay();
+  stopRecording();
+
+  recordFile.setFileName(filename);
+  if(recordFile.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&recordFile);
+    out << FILE_MAGIC_NUMBER << FILE_VERSION << static_cast<quint32>(SimConnectData::getDataVersion());
+    recordTimer.start();
+    flushTimer.start();
+    qInfo() << Q_FUNC_INFO << "Recording to" << filename;
+    return true;
+  }
+  else
+  {
+    qWarning() << "Cannot open recording" << filename << ":" << recordFile.errorString();
+    return false;
+  }
+}
+
+void FlightRecorder::stopRecording()
+{
+  flushTimer.stop();
+  if(isRecording())
+  {
+    qInfo() << Q_FUNC_INFO << "Recorded" << recordTimer.elapsed() << "ms";
+    recordFile.close();
+  }
+}
+
+void FlightRecorder::recordPacket(atools::fs::sc::SimConnectData& data)
+{
+  if(!isRecording())
+    return;
+
+  // Serialize packet first to get the size
+  QByteArray bytes;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::WriteOnly);
+  data.write(&buffer);
+  buffer.close();
+
+  QDataStream out(&recordFile);
+  out << static_cast<qint64>(recordTimer.elapsed()) << static_cast<quint32>(bytes.size());
+  out.writeRawData(bytes.constData(), bytes.size());
+}
+
+bool FlightRecorder::openReplay(const QString& filename)
+{
+  closeReplay();
+  stopRecording();
+
+  recordFile.setFileName(filename);
+  if(!recordFile.open(QIODevice::ReadOnly))
+  {
+    qWarning() << "Cannot open recording" << filename << ":" << recordFile.errorString();
+    return false;
+  }
+
+  quint32 magic, dataVersion;
+  quint16 version;
+  QDataStream in(&recordFile);
+  in >> magic >> version >> dataVersion;
+
+  if(magic != FILE_MAGIC_NUMBER || version != FILE_VERSION ||
+     dataVersion != static_cast<quint32>(SimConnectData::getDataVersion()))
+  {
+    qWarning() << "Cannot read recording" << filename << ". Invalid magic number or version:"
+               << magic << version << dataVersion;
+    recordFile.close();
+    return false;
+  }
+
+  // Build time index by skipping over the packets - stops at an incomplete frame at the end
+  while(!in.atEnd())
+  {
+    Frame frame;
+    in >> frame.timeMs >> frame.size;
+    frame.offset = recordFile.pos();
+
+    if(in.status() != QDataStream::Ok || in.skipRawData(static_cast<int>(frame.size)) != static_cast<int>(frame.size))
+      break;
+
+    frames.append(frame);
+  }
+
+  replayIndex = 0;
+  qInfo() << Q_FUNC_INFO << "Replay" << filename << "frames" << frames.size() << "duration" << getDurationMs() << "ms";
+  return true;
+}
+
+void FlightRecorder::closeReplay()
+{
+  pauseReplay();
+
+  if(recordFile.isOpen() && !isRecording())
+    recordFile.close();
+  frames.clear();
+  replayIndex = 0;
+}
+
+void FlightRecorder::startReplay()
+{
+  if(frames.isEmpty() || replaying)
+    return;
+
+  if(replayIndex >= frames.size())
+    // Restart at end
+    replayIndex = 0;
+
+  replaying = true;
+  resetReplayClock(frames.at(replayIndex).timeMs);
+  emit replayStarted();
+  replayTimeout();
+}
+
+void FlightRecorder::pauseReplay()
+{
+  replayTimer.stop();
+
+  if(replaying)
+  {
+    replaying = false;
+    emit replayStopped();
+  }
+}
+
+void FlightRecorder::setReplaySpeed(int speed)
+{
+  // Keep current position when changing speed
+  qint64 timeMs = replayTimeMs();
+  replaySpeed = std::min(std::max(speed, static_cast<int>(MIN_SPEED)), static_cast<int>(MAX_SPEED));
+  resetReplayClock(timeMs);
+}
+
+bool FlightRecorder::seek(qint64 timeMs)
+{
+  int index = frameIndex(timeMs);
+  if(index >= frames.size())
+    return false;
+
+  replayIndex = index;
+  resetReplayClock(frames.at(replayIndex).timeMs);
+
+  if(replaying)
+  {
+    // Show new position immediately - otherwise it is sent by startReplay()
+    replayTimer.stop();
+    replayTimeout();
+  }
+  return true;
+}
+
+void FlightRecorder::replayTimeout()
+{
+  // Emit all frames which are due at the current replay time
+  qint64 timeMs = replayTimeMs();
+  SimConnectData data;
+  while(replayIndex < frames.size() && frames.at(replayIndex).timeMs <= timeMs)
+  {
+    if(readFrame(replayIndex, data))
+      emit replayPacket(data);
+    replayIndex++;
+  }
+
+  if(replayIndex < frames.size())
+  {
+    qint64 waitMs = (frames.at(replayIndex).timeMs - timeMs) / replaySpeed;
+    replayTimer.start(static_cast<int>(std::max(waitMs, static_cast<qint64>(MIN_REPLAY_INTERVAL_MS))));
+  }
+  else
+    // End of recording
+    pauseReplay();
+}
+
+bool FlightRecorder::exportUserAircraft(const QString& filename, qint64 intervalMs)
+{
+  if(frames.isEmpty() || isRecording())
+    return false;
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    qWarning() << "Cannot open export" << filename << ":" << file.errorString();
+    return false;
+  }
+
+  QTextStream out(&file);
+  out.setCodec("UTF-8");
+  out << "TimeMs,ZuluTime,Longitude,Latitude,AltitudeFt,GroundSpeedKts,TrackTrue,OnGround" << endl;
+
+  intervalMs = std::max(intervalMs, static_cast<qint64>(1));
+  SimConnectData data;
+  int numExported = 0;
+  qint64 timeMs = 0L;
+  while(timeMs <= getDurationMs())
+  {
+    int index = frameIndex(timeMs);
+    if(index >= frames.size())
+      break;
+
+    if(readFrame(index, data))
+    {
+      const atools::fs::sc::SimConnectUserAircraft& aircraft = data.getUserAircraftConst();
+      if(aircraft.isValid())
+      {
+        const atools::geo::Pos& pos = aircraft.getPosition();
+        out << frames.at(index).timeMs << ","
+            << aircraft.getZuluTime().toString(Qt::ISODate) << ","
+            << QString::number(pos.getLonX(), 'f', 6) << "," << QString::number(pos.getLatY(), 'f', 6) << ","
+            << QString::number(pos.getAltitude(), 'f', 0) << ","
+            << QString::number(aircraft.getGroundSpeedKts(), 'f', 0) << ","
+            << QString::number(aircraft.getTrackDegTrue(), 'f', 0) << ","
+            << (aircraft.isOnGround() ? 1 : 0) << endl;
+        numExported++;
+      }
+    }
+
+    // Next sample time relative to the frame found to skip all frames within the interval
+    timeMs = frames.at(index).timeMs + intervalMs;
+  }
+
+  file.close();
+  qInfo() << Q_FUNC_INFO << "Exported" << numExported << "positions to" << filename;
+  return out.status() == QTextStream::Ok;
+}
+
+int FlightRecorder::frameIndex(qint64 timeMs) const
+{
+  auto lessThan = [](const Frame& frame, qint64 time) -> bool
+  {
+    return frame.timeMs < time;
+  };
+  return static_cast<int>(std::lower_bound(frames.begin(), frames.end(), timeMs, lessThan) - frames.begin());
+}
+
+bool FlightRecorder::readFrame(int index, atools::fs::sc::SimConnectData& data)
+{
+  const Frame& frame = frames.at(index);
+  if(!recordFile.seek(frame.offset))
+    return false;
+
+  QByteArray bytes = recordFile.read(frame.size);
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::ReadOnly);
+
+  data = SimConnectData();
+  bool ok = data.read(&buffer) && data.getStatus() == atools::fs::sc::OK;
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Cannot read frame" << index << data.getStatusText();
+  return ok;
+}
+
+qint64 FlightRecorder::replayTimeMs() const
+{
+  return replaying ? replayBaseMs + replayClock.elapsed() * replaySpeed : replayBaseMs;
+}
+
+void FlightRecorder::resetReplayClock(qint64 timeMs)
+{
+  replayBaseMs = timeMs;
+  replayClock.start();
+}
@@ -0,0 +1,163 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_FLIGHTRECORDER_H
+#define LITTLENAVMAP_FLIGHTRECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+/*
+ * Records all packets received by the ConnectClient into a file and replays them.
+ *
+ * Each frame in the file has the time in milliseconds since start of recording and the packet as sent by
+ * Little Navconnect. A time index of all frames is kept in memory which allows to seek without reading the
+ * whole file.
+ *
+ * Replay emits the packets with the original timing multiplied by a speed factor.
+ */
+class FlightRecorder :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  FlightRecorder(QObject *parent);
+  virtual ~FlightRecorder();
+
+  /* Start recording into a new file. Stops any recording or replay. */
+  bool startRecording(const QString& filename);
+  void stopRecording();
+
+  bool isRecording() const
+  {
+    return recordFile.isOpen() && recordFile.openMode() & QIODevice::WriteOnly;
+  }
+
+  /* Add a packet to the recording if active. */
+  void recordPacket(atools::fs::sc::SimConnectData& data);
+
+  /* Open a recorded file for replay and build the time index. Stops any recording or replay. */
+  bool openReplay(const QString& filename);
+  void closeReplay();
+
+  /* Start or resume replay at the current position */
+  void startReplay();
+  void pauseReplay();
+
+  bool isReplaying() const
+  {
+    return replaying;
+  }
+
+  /* Replay speed factor from MIN_SPEED to MAX_SPEED */
+  void setReplaySpeed(int speed);
+
+  int getReplaySpeed() const
+  {
+    return replaySpeed;
+  }
+
+  /* Moves replay position to the first frame at or after the given time in milliseconds from start of the
+   * recording. The frame is emitted at once if replay is active or otherwise when replay starts.
+   * Binary search on the time index. */
+  bool seek(qint64 timeMs);
+
+  /* Writes the user aircraft position of the opened recording as CSV with at most one line per intervalMs.
+   * Only the frames at the sample times are read by using the time index. */
+  bool exportUserAircraft(const QString& filename, qint64 intervalMs);
+
+  /* Duration of the opened recording */
+  qint64 getDurationMs() const
+  {
+    return frames.isEmpty() ? 0L : frames.last().timeMs;
+  }
+
+  static Q_DECL_CONSTEXPR int MIN_SPEED = 1;
+  static Q_DECL_CONSTEXPR int MAX_SPEED = 64;
+
+signals:
+  /* Emitted for each replayed packet */
+  void replayPacket(atools::fs::sc::SimConnectData data);
+
+  /* Emitted when replay starts or resumes */
+  void replayStarted();
+
+  /* Emitted when replay has reached the end or was stopped */
+  void replayStopped();
+
+private:
+  /* Index entry for one frame */
+  struct Frame
+  {
+    qint64 timeMs, offset;
+    quint32 size;
+  };
+
+  void replayTimeout();
+
+  /* Get index of first frame at or after time */
+  int frameIndex(qint64 timeMs) const;
+  bool readFrame(int index, atools::fs::sc::SimConnectData& data);
+
+  /* Recording time at the replay clock */
+  qint64 replayTimeMs() const;
+
+  /* Set replay clock to the given recording time */
+  void resetReplayClock(qint64 timeMs);
+
+  /* Opened for writing when recording and for reading when replaying */
+  QFile recordFile;
+  QElapsedTimer recordTimer;
+
+  /* Flushes the recording periodically. A crash loses only the frames of the last interval since
+   * openReplay() ignores an incomplete last frame. */
+  QTimer flushTimer;
+
+  QVector<Frame> frames;
+
+  /* Next frame to be emitted */
+  int replayIndex = 0;
+  int replaySpeed = 1;
+  bool replaying = false;
+
+  /* Recording time when replay clock was started */
+  qint64 replayBaseMs = 0L;
+  QElapsedTimer replayClock;
+  QTimer replayTimer;
+
+  static Q_DECL_CONSTEXPR int FLUSH_INTERVAL_MS = 2000;
+
+  /* Minimum timer interval to avoid flooding the event queue */
+  static Q_DECL_CONSTEXPR int MIN_REPLAY_INTERVAL_MS = 20;
+
+  static Q_DECL_CONSTEXPR quint32 FILE_MAGIC_NUMBER = 0x3A7C9E14;
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 1;
+};
+
+#endif // LITTLENAVMAP_FLIGHTRECORDER_H
@@ -30,6 +30,7 @@
 #include "weather/weatherreporter.h"
 #include "connect/connectclient.h"
 #include "common/elevationprovider.h"
+#include "common/elevationservice.h"
 #include "db/databasemanager.h"
 #include "gui/dialog.h"
 #include "gui/errorhandler.h"
@@ -1073,6 +1074,13 @@ void MainWindow::connectAllSlots()
   connect(mapWidget, &MapWidget::shownMapFeaturesChanged, routeController, &RouteController::shownMapFeaturesChanged);
   connect(mapWidget, &MapWidget::addUserpointFromMap,
           NavApp::getUserdataController(), &UserdataController::addUserpointFromMap);
+  connect(NavApp::getElevationService(), &ElevationService::elevationsAvailable,
+          mapWidget, &MapWidget::elevationsAvailable);
+  connect(NavApp::getElevationProvider(), &ElevationProvider::updateAvailable,
+          mapWidget, &MapWidget::elevationUpdateAvailable);
+  // Terrain shading action depends on the elevation source
+  connect(NavApp::getElevationProvider(), &ElevationProvider::updateAvailable,
+          this, &MainWindow::updateActionStates);
   connect(mapWidget, &MapWidget::editUserpointFromMap,
           NavApp::getUserdataController(), &UserdataController::editUserpointFromMap);
   connect(mapWidget, &MapWidget::deleteUserpointFromMap,
@@ -1114,6 +1122,7 @@ void MainWindow::connectAllSlots()
 
   // Map object/feature display
   connect(ui->actionMapShowMinimumAltitude, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
+  connect(ui->actionMapShowTerrainShading, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowAirportWeather, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowCities, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowGrid, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
@@ -2949,6 +2958,9 @@ void MainWindow::updateActionStates()
   // Enable MORA button depending on available data
   ui->actionMapShowMinimumAltitude->setEnabled(NavApp::getMoraReader()->isDataAvailable());
 
+  // Terrain shading needs memory mapped offline elevation data - same condition as in MapPainterTerrain
+  ui->actionMapShowTerrainShading->setEnabled(NavApp::getElevationProvider()->isMappedGlobeProvider());
+
   bool hasFlightplan = !NavApp::getRouteConst().isFlightplanEmpty();
   ui->actionRouteAppend->setEnabled(hasFlightplan);
   ui->actionRouteSave->setEnabled(hasFlightplan /* && routeController->hasChanged()*/);
@@ -3195,7 +3207,8 @@ void MainWindow::restoreStateMain()
                        ui->actionMapShowCities, ui->actionMapShowHillshading, ui->actionRouteEditMode,
                        ui->actionWorkOffline, ui->actionRouteSaveSidStarWaypoints, ui->actionRouteSaveApprWaypoints,
                        ui->actionUserdataCreateLogbook,
-                       ui->actionMapShowSunShading, ui->actionMapShowAirportWeather, ui->actionMapShowMinimumAltitude});
+                       ui->actionMapShowSunShading, ui->actionMapShowAirportWeather, ui->actionMapShowMinimumAltitude,
+                       ui->actionMapShowTerrainShading});
   widgetState.setBlockSignals(false);
 
   firstApplicationStart = settings.valueBool(lnm::MAINWINDOW_FIRSTAPPLICATIONSTART, true);
@@ -3340,7 +3353,7 @@ void MainWindow::saveActionStates()
                     ui->actionMapShowAircraftTrack, ui->actionInfoApproachShowMissedAppr,
                     ui->actionMapShowGrid, ui->actionMapShowCities, ui->actionMapShowSunShading,
                     ui->actionMapShowHillshading, ui->actionMapShowAirportWeather,
-                    ui->actionMapShowMinimumAltitude,
+                    ui->actionMapShowMinimumAltitude, ui->actionMapShowTerrainShading,
                     ui->actionRouteEditMode,
                     ui->actionWorkOffline,
                     ui->actionRouteSaveSidStarWaypoints, ui->actionRouteSaveApprWaypoints,
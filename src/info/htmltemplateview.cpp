@@ -0,0 +1,232 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "info/htmltemplateview.h"
+
+#include "gui/widgetutil.h"
+
+#include <QTextDocument>
+#include <QTextEdit>
+#include <QTextTable>
+#include <QTextCursor>
+#include <QTextDocumentFragment>
+#include <QDebug>
+
+HtmlTemplateView::HtmlTemplateView(QTextEdit *textEditParam)
+  : textEdit(textEditParam)
+{
+  // Patching cells would fill the undo stack otherwise
+  textEdit->document()->setUndoRedoEnabled(false);
+
+  // Document revisions are not reliable without undo - watch the document for outside changes instead
+  contentsConnection = QObject::connect(textEdit->document(), &QTextDocument::contentsChanged, [this]()
+  {
+    if(!updating)
+      changedOutside = true;
+  });
+}
+
+HtmlTemplateView::~HtmlTemplateView()
+{
+  QObject::disconnect(contentsConnection);
+}
+
+void HtmlTemplateView::reset()
+{
+  valid = false;
+  canPatch = true;
+  lastTemplate.clear();
+  lastCells.clear();
+}
+
+void HtmlTemplateView::updateHtml(const QString& html)
+{
+  QString templateHtml;
+  QStringList cells;
+
+  if(!splitHtml(html, templateHtml, cells))
+  {
+    // Cannot patch this one
+    reset();
+    fullUpdate(html);
+    return;
+  }
+
+  // Document changed from outside, e.g. by clear() or setPlainText()
+  if(changedOutside)
+    valid = false;
+
+  if(valid && templateHtml == lastTemplate && cells.size() == lastCells.size())
+  {
+    if(cells == lastCells)
+      // Nothing changed
+      return;
+
+    if(canPatch)
+    {
+      updating = true;
+      bool patched = patchCells(cells);
+      updating = false;
+
+      if(patched)
+      {
+        lastCells = cells;
+        changedOutside = false;
+        return;
+      }
+
+      // Do not try again until the template changes
+      canPatch = false;
+    }
+  }
+  else
+    canPatch = true;
+
+  // Template changed or patching not possible - replace all
+  fullUpdate(html);
+  lastTemplate = templateHtml;
+  lastCells = cells;
+  valid = true;
+}
+
+void HtmlTemplateView::fullUpdate(const QString& html)
+{
+  updating = true;
+  atools::gui::util::updateTextEdit(textEdit, html, false /* scroll to top*/, true /* keep selection */);
+  updating = false;
+  changedOutside = false;
+  numFullUpdates++;
+}
+
+bool HtmlTemplateView::patchCells(const QStringList& newCells)
+{
+  QVector<QTextTableCell> docCells;
+  collectCells(textEdit->document()->rootFrame(), docCells);
+
+  if(docCells.size() != newCells.size())
+  {
+    // Document structure does not match HTML - for example caused by empty or spanned cells
+    qWarning() << Q_FUNC_INFO << "Cell number mismatch" << docCells.size() << newCells.size();
+    return false;
+  }
+
+  // Layout is done once at the end of the edit block
+  QTextCursor editCursor(textEdit->document());
+  editCursor.beginEditBlock();
+
+  for(int i = 0; i < newCells.size(); i++)
+  {
+    const QString& content = newCells.at(i);
+    if(content == lastCells.at(i))
+      continue;
+
+    const QTextTableCell& cell = docCells.at(i);
+    int start = cell.firstCursorPosition().position(), end = cell.lastCursorPosition().position();
+
+    QTextCursor cursor(textEdit->document());
+    cursor.setPosition(start);
+
+    if(content.contains('<'))
+    {
+      // Formatted content - replace with new HTML
+      cursor.setPosition(end, QTextCursor::KeepAnchor);
+      cursor.insertHtml(content);
+    }
+    else
+    {
+      // Plain value - keep the format of the first character in the cell
+      if(start < end)
+        cursor.movePosition(QTextCursor::NextCharacter);
+      QTextCharFormat format = cursor.charFormat();
+
+      cursor.setPosition(start);
+      cursor.setPosition(end, QTextCursor::KeepAnchor);
+      cursor.insertText(QTextDocumentFragment::fromHtml(content).toPlainText(), format);
+    }
+    numPatchedCells++;
+  }
+
+  editCursor.endEditBlock();
+  return true;
+}
+
+void HtmlTemplateView::collectCells(QTextFrame *frame, QVector<QTextTableCell>& cells)
+{
+  for(QTextFrame *child : frame->childFrames())
+  {
+    QTextTable *table = qobject_cast<QTextTable *>(child);
+    if(table != nullptr)
+    {
+      for(int row = 0; row < table->rows(); row++)
+      {
+        for(int col = 0; col < table->columns(); col++)
+        {
+          // Skip columns covered by a spanning cell
+          QTextTableCell cell = table->cellAt(row, col);
+          if(cell.row() == row && cell.column() == col)
+            cells.append(cell);
+        }
+      }
+    }
+    else
+      collectCells(child, cells);
+  }
+}
+
+bool HtmlTemplateView::splitHtml(const QString& html, QString& templateHtml, QStringList& cells)
+{
+  int pos = 0, last = 0;
+  while(pos < html.size())
+  {
+    // Find start of next cell
+    int cellStart = html.indexOf('<', pos);
+    if(cellStart == -1 || cellStart + 3 >= html.size())
+      break;
+
+    QString tag = html.mid(cellStart + 1, 2).toLower();
+    QChar next = html.at(cellStart + 3);
+    if((tag != "td" && tag != "th") || (next != '>' && !next.isSpace()))
+    {
+      pos = cellStart + 1;
+      continue;
+    }
+
+    int contentStart = html.indexOf('>', cellStart);
+    if(contentStart == -1)
+      return false;
+    contentStart++;
+
+    int contentEnd = html.indexOf("</" + tag, contentStart, Qt::CaseInsensitive);
+    if(contentEnd == -1)
+      return false;
+
+    QString content = html.mid(contentStart, contentEnd - contentStart);
+
+    // Nested tables or unclosed cells cannot be mapped to document cells
+    if(content.contains("<table", Qt::CaseInsensitive) || content.contains("<td", Qt::CaseInsensitive) ||
+       content.contains("<th", Qt::CaseInsensitive))
+      return false;
+
+    templateHtml.append(html.midRef(last, contentStart - last));
+    cells.append(content);
+
+    pos = last = contentEnd;
+  }
+
+  templateHtml.append(html.midRef(last));
+  return true;
+}
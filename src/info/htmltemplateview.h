@@ -0,0 +1,93 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_HTMLTEMPLATEVIEW_H
+#define LITTLENAVMAP_HTMLTEMPLATEVIEW_H
+
+#include <QMetaObject>
+#include <QStringList>
+#include <QVector>
+
+class QTextEdit;
+class QTextTableCell;
+class QTextFrame;
+
+/*
+ * Updates a text browser with frequently changing HTML like the aircraft progress.
+ *
+ * The HTML is split into a template consisting of all text outside of table cells and the
+ * list of cell contents. The document is fully replaced only if the template changes.
+ * Otherwise only cells with changed values are patched in place which avoids the expensive
+ * layout of the whole document on each simulator update.
+ */
+class HtmlTemplateView
+{
+public:
+  HtmlTemplateView(QTextEdit *textEditParam);
+  ~HtmlTemplateView();
+
+  HtmlTemplateView(const HtmlTemplateView& other) = delete;
+  HtmlTemplateView& operator=(const HtmlTemplateView& other) = delete;
+
+  /* Show the given HTML by either patching cells or replacing the whole document */
+  void updateHtml(const QString& html);
+
+  /* Force a full update on next call of updateHtml. Call after changing the text edit contents directly. */
+  void reset();
+
+  /* Number of full document replacements and patched cells for debugging */
+  int getNumFullUpdates() const
+  {
+    return numFullUpdates;
+  }
+
+  int getNumPatchedCells() const
+  {
+    return numPatchedCells;
+  }
+
+private:
+  /* Split HTML into template and cell contents. Returns false if the HTML cannot be patched
+   * like for nested tables. */
+  static bool splitHtml(const QString& html, QString& templateHtml, QStringList& cells);
+  static void collectCells(QTextFrame *frame, QVector<QTextTableCell>& cells);
+
+  void fullUpdate(const QString& html);
+  bool patchCells(const QStringList& newCells);
+
+  QTextEdit *textEdit;
+
+  /* Template and values currently shown in the document */
+  QString lastTemplate;
+  QStringList lastCells;
+  bool valid = false;
+
+  /* Cleared if the document cells do not match the HTML cells for the current template */
+  bool canPatch = true;
+
+  /* Set if the document was changed from outside, e.g. by clear() or setPlainText() */
+  bool changedOutside = false;
+
+  /* true while this class changes the document */
+  bool updating = false;
+
+  QMetaObject::Connection contentsConnection;
+
+  int numFullUpdates = 0, numPatchedCells = 0;
+};
+
+#endif // LITTLENAVMAP_HTMLTEMPLATEVIEW_H
@@ -23,6 +23,7 @@
 #include "common/maptools.h"
 #include "common/htmlinfobuilder.h"
 #include "common/tabindexes.h"
+#include "info/htmltemplateview.h"
 #include "online/onlinedatacontroller.h"
 #include "gui/tools.h"
 #include "gui/mainwindow.h"
@@ -59,6 +60,10 @@ InfoController::InfoController(MainWindow *parent)
 
   // Get base font size for widgets
   Ui::MainWindow *ui = NavApp::getMainUi();
+  aircraftView = new HtmlTemplateView(ui->textBrowserAircraftInfo);
+  aircraftProgressView = new HtmlTemplateView(ui->textBrowserAircraftProgressInfo);
+  aircraftAiView = new HtmlTemplateView(ui->textBrowserAircraftAiInfo);
+
   infoFontPtSize = static_cast<float>(ui->textBrowserAirportInfo->font().pointSizeF());
   simInfoFontPtSize = static_cast<float>(ui->textBrowserAircraftInfo->font().pointSizeF());
 
@@ -104,6 +109,9 @@ InfoController::InfoController(MainWindow *parent)
 InfoController::~InfoController()
 {
   delete infoBuilder;
+  delete aircraftView;
+  delete aircraftProgressView;
+  delete aircraftAiView;
 }
 
 void InfoController::visibilityChangedAircraft(bool visible)
@@ -347,8 +355,7 @@ void InfoController::updateProgress()
     html.clear();
     infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst(),
                                       true /* show more/less switch */, lessAircraftProgress);
-    atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(),
-                                      false /* scroll to top*/, true /* keep selection */);
+    aircraftProgressView->updateHtml(html.getHtml());
   }
 }
 
@@ -856,15 +863,20 @@ void InfoController::updateUserAircraftText()
         HtmlBuilder html(true /* has background color */);
         infoBuilder->aircraftText(lastSimData.getUserAircraftConst(), html);
         infoBuilder->aircraftTextWeightAndFuel(lastSimData.getUserAircraftConst(), html);
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftInfo, html.getHtml(),
-                                          false /* scroll to top*/, true /* keep selection */);
+        aircraftView->updateHtml(html.getHtml());
       }
     }
     else
+    {
+      aircraftView->reset();
       ui->textBrowserAircraftInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    aircraftView->reset();
     ui->textBrowserAircraftInfo->clear();
+  }
 }
 
 void InfoController::updateAircraftProgressText()
@@ -884,15 +896,20 @@ void InfoController::updateAircraftProgressText()
         HtmlBuilder html(true /* has background color */);
         infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst(),
                                           true /* show more/less switch */, lessAircraftProgress);
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(),
-                                          false /* scroll to top*/, true /* keep selection */);
+        aircraftProgressView->updateHtml(html.getHtml());
       }
     }
     else
+    {
+      aircraftProgressView->reset();
       ui->textBrowserAircraftProgressInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    aircraftProgressView->reset();
     ui->textBrowserAircraftProgressInfo->clear();
+  }
 }
 
 void InfoController::updateAiAircraftText()
@@ -922,8 +939,7 @@ void InfoController::updateAiAircraftText()
             num++;
           }
 
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, html.getHtml(),
-                                            false /* scroll to top*/, true /* keep selection */);
+          aircraftAiView->updateHtml(html.getHtml());
         }
         else
         {
@@ -936,16 +952,21 @@ void InfoController::updateAiAircraftText()
           text += tr("No AI or multiplayer aircraft selected.<br/>"
                      "Found %1 AI or multiplayer aircraft.").
                   arg(numAi > 0 ? QLocale().toString(numAi) : tr("no"));
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, text,
-                                            false /* scroll to top*/, true /* keep selection */);
+          aircraftAiView->updateHtml(text);
         }
       }
     }
     else
+    {
+      aircraftAiView->reset();
       ui->textBrowserAircraftAiInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    aircraftAiView->reset();
     ui->textBrowserAircraftAiInfo->clear();
+  }
 }
 
 void InfoController::simDataChanged(atools::fs::sc::SimConnectData data)
@@ -1042,6 +1063,10 @@ void InfoController::updateAircraftInfo()
 
 void InfoController::optionsChanged()
 {
+  // Rebuild aircraft texts completely since symbol sizes or units might change
+  aircraftView->reset();
+  aircraftProgressView->reset();
+  aircraftAiView->reset();
   updateTextEditFontSizes();
   updateAllInformation();
   updateAircraftInfo();
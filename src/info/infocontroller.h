@@ -29,6 +29,7 @@ class AirportQuery;
 class AirspaceQuery;
 class InfoQuery;
 class HtmlInfoBuilder;
+class HtmlTemplateView;
 class QTextEdit;
 
 /*
@@ -136,6 +137,9 @@ private:
   AirportQuery *airportQuery = nullptr;
   HtmlInfoBuilder *infoBuilder = nullptr;
 
+  /* Patch only changed values in the aircraft tabs on simulator updates */
+  HtmlTemplateView *aircraftView = nullptr, *aircraftProgressView = nullptr, *aircraftAiView = nullptr;
+
   float simInfoFontPtSize = 10.f, infoFontPtSize = 10.f;
   bool lessAircraftProgress = false;
 };
@@ -39,6 +39,9 @@
 #include "common/unit.h"
 #include "fs/weather/metarparser.h"
 #include "userdata/userdataicons.h"
+#include "mapgui/mapbenchmark.h"
+#include "connect/connectclient.h"
+#include "connect/flightrecorder.h"
 
 #include <QCommandLineParser>
 #include <QDebug>
@@ -50,6 +53,8 @@
 #include <QLibrary>
 #include <QPixmapCache>
 #include <QFontDatabase>
+#include <QTimer>
+#include <QTextStream>
 
 #include <marble/MarbleGlobal.h>
 #include <marble/MarbleDirs.h>
@@ -164,6 +169,50 @@ int main(int argc, char *argv[])
                                       QObject::tr("settings-directory"));
     parser.addOption(settingsDirOpt);
 
+    QCommandLineOption mapBenchmarkOpt("map-benchmark",
+                                       QObject::tr("Run the map rendering benchmark, print a report to "
+                                                   "stdout and exit. Use \"-platform offscreen\" to run "
+                                                   "without display."));
+    parser.addOption(mapBenchmarkOpt);
+
+    QCommandLineOption mapBenchmarkScriptOpt("map-benchmark-script",
+                                             QObject::tr("Use frames from <script> for the map rendering benchmark."),
+                                             QObject::tr("script"));
+    parser.addOption(mapBenchmarkScriptOpt);
+
+    QCommandLineOption recordFlightOpt("record-flight",
+                                       QObject::tr("Record all data received from the simulator into <file>."),
+                                       QObject::tr("file"));
+    parser.addOption(recordFlightOpt);
+
+    QCommandLineOption replayFlightOpt("replay-flight",
+                                       QObject::tr("Replay a flight recorded with \"--record-flight\" from <file> "
+                                                   "instead of connecting to a simulator."),
+                                       QObject::tr("file"));
+    parser.addOption(replayFlightOpt);
+
+    QCommandLineOption replaySpeedOpt("replay-speed",
+                                      QObject::tr("Replay speed factor from %1 to %2.").
+                                      arg(FlightRecorder::MIN_SPEED).arg(FlightRecorder::MAX_SPEED),
+                                      QObject::tr("speed"), "1");
+    parser.addOption(replaySpeedOpt);
+
+    QCommandLineOption replayStartOpt("replay-start",
+                                      QObject::tr("Start replay at <seconds> after start of the recording."),
+                                      QObject::tr("seconds"), "0");
+    parser.addOption(replayStartOpt);
+
+    QCommandLineOption replayExportOpt("replay-export",
+                                       QObject::tr("Export the user aircraft positions of the flight given by "
+                                                   "\"--replay-flight\" as CSV into <file> before replay."),
+                                       QObject::tr("file"));
+    parser.addOption(replayExportOpt);
+
+    QCommandLineOption replayExportIntervalOpt("replay-export-interval",
+                                               QObject::tr("Export one position every <seconds>."),
+                                               QObject::tr("seconds"), "1");
+    parser.addOption(replayExportIntervalOpt);
+
     // Process the actual command line arguments given by the user
     parser.process(*QCoreApplication::instance());
 
@@ -367,6 +416,43 @@ int main(int argc, char *argv[])
       // Hide splash once main window is shown
       NavApp::finishSplashScreen();
 
+      if(parser.isSet(mapBenchmarkOpt))
+      {
+        // Run benchmark from the event loop and exit application. The benchmark waits for loading per frame.
+        QString script = parser.isSet(mapBenchmarkScriptOpt) ? parser.value(mapBenchmarkScriptOpt) :
+                         Settings::getOverloadedPath(lnm::MAPBENCHMARK_CONFIG);
+
+        QTimer::singleShot(0, [script]()
+        {
+          MapBenchmark benchmark(NavApp::getMapWidget());
+          int result = 1;
+          if(benchmark.loadScript(script))
+          {
+            QTextStream out(stdout);
+            benchmark.run(out);
+            result = 0;
+          }
+          QApplication::exit(result);
+        });
+      }
+
+      FlightRecorder *recorder = NavApp::getConnectClient()->getFlightRecorder();
+      if(parser.isSet(replayFlightOpt))
+      {
+        if(recorder->openReplay(parser.value(replayFlightOpt)))
+        {
+          if(parser.isSet(replayExportOpt))
+            recorder->exportUserAircraft(parser.value(replayExportOpt),
+                                         static_cast<qint64>(parser.value(replayExportIntervalOpt).toDouble() * 1000.));
+
+          recorder->setReplaySpeed(parser.value(replaySpeedOpt).toInt());
+          recorder->seek(parser.value(replayStartOpt).toLongLong() * 1000L);
+          NavApp::getConnectClient()->startReplay();
+        }
+      }
+      else if(parser.isSet(recordFlightOpt))
+        recorder->startRecording(parser.value(recordFlightOpt));
+
       qDebug() << "Before app.exec()";
       retval = app.exec();
     }
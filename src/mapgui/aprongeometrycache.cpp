@@ -19,24 +19,37 @@
 #include "fs/common/xpgeometry.h"
 #include "common/coordinateconverter.h"
 #include "common/maptypes.h"
-
+#include "geo/calculations.h"
+#include "navapp.h"
+#include "query/querytypes.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+
+#include <cmath>
+#include <QDebug>
+#include <QHash>
 #include <QPainterPath>
+#include <QTransform>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <marble/ViewportParams.h>
 
 // ======= Key  ===============================================================
 uint qHash(const ApronGeometryCache::Key& key)
 {
-  return static_cast<uint>(key.apronId) ^ key.fast ^ static_cast<uint>(key.zoomDistanceMeter);
+  return static_cast<uint>(key.apronId) ^ key.fast ^ (static_cast<uint>(key.zoomBucket) << 24);
 }
 
-ApronGeometryCache::Key::Key(int apronIdParam, float zoomDistanceMeterParam, bool fastParam)
-  : apronId(apronIdParam), zoomDistanceMeter(static_cast<int>(zoomDistanceMeterParam)), fast(fastParam)
+ApronGeometryCache::Key::Key(int apronIdParam, int zoomBucketParam, bool fastParam)
+  : apronId(apronIdParam), zoomBucket(zoomBucketParam), fast(fastParam)
 {
 
 }
 
 bool ApronGeometryCache::Key::operator==(const ApronGeometryCache::Key& other) const
 {
-  return apronId == other.apronId && fast == other.fast && zoomDistanceMeter == other.zoomDistanceMeter;
+  return apronId == other.apronId && fast == other.fast && zoomBucket == other.zoomBucket;
 }
 
 bool ApronGeometryCache::Key::operator!=(const ApronGeometryCache::Key& other) const
@@ -44,21 +57,70 @@ bool ApronGeometryCache::Key::operator!=(const ApronGeometryCache::Key& other) c
   return !(*this == other);
 }
 
+/* Combined key for the set of prefetched airports */
+static quint64 airportKey(int airportId, int zoomBucket)
+{
+  return (static_cast<quint64>(static_cast<quint32>(airportId)) << 32) | static_cast<quint32>(zoomBucket);
+}
+
+/* Connection used by the background thread only */
+static const QString DATABASE_NAME_APRON = "LNMDBAPRON";
+static const QString DATABASE_TYPE = "QSQLITE";
+
 // ======= ApronGeometryCache ===============================================================
 ApronGeometryCache::ApronGeometryCache()
-  : geometryCache(CACHE_SIZE)
+  : geometryCache(CACHE_SIZE_BYTES)
 {
+  QObject::connect(&buildWatcher, &QFutureWatcher<BuildBatch>::finished, [this]()
+  {
+    BuildBatch batch = buildFuture.result();
 
+    if(!discardResults)
+    {
+      for(const BuildResult& result : batch.results)
+      {
+        if(!geometryCache.contains(result.key))
+          insertPath(result.key, new QPainterPath(result.path));
+      }
+
+      for(quint64 key : batch.airportKeys)
+        prefetchedAirports.insert(key);
+
+      if(!batch.complete)
+        // Request again to load the remaining airports
+        requestedZoomBucket = -1;
+    }
+    discardResults = false;
+
+    // Continue with the latest request queued in the meantime
+    if(hasPendingRect)
+    {
+      hasPendingRect = false;
+      prefetchApronGeometry(pendingRect);
+    }
+  });
 }
 
 ApronGeometryCache::~ApronGeometryCache()
 {
+  buildWatcher.disconnect();
+  buildFuture.waitForFinished();
   delete converter;
 }
 
 void ApronGeometryCache::clear()
 {
   geometryCache.clear();
+  prefetchedAirports.clear();
+  requestedZoomBucket = -1;
+  hasPendingRect = false;
+
+  if(buildFuture.isRunning())
+  {
+    // Ids might not be valid anymore after switching databases - wait to release the database file
+    discardResults = true;
+    buildFuture.waitForFinished();
+  }
 }
 
 void ApronGeometryCache::setViewportParams(const Marble::ViewportParams *viewport)
@@ -70,56 +132,52 @@ void ApronGeometryCache::setViewportParams(const Marble::ViewportParams *viewpor
   converter = new CoordinateConverter(viewport);
 }
 
-QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, float zoomDistanceMeter, bool fast)
+int ApronGeometryCache::currentZoomBucket() const
+{
+  return static_cast<int>(std::floor(std::log2(std::max(converter->getViewport()->radius(), 1))));
+}
+
+double ApronGeometryCache::radiusForBucket(int zoomBucket)
+{
+  return std::pow(2., zoomBucket);
+}
+
+QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, bool fast)
 {
   Q_ASSERT(converter != nullptr);
 
+  // Calculate the coordinates of the reference point (first one)
+  bool visible;
+  QPointF refPoint = converter->wToSF(apron.geometry.boundary.first().node,
+                                      CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+
 #if !defined(DEBUG_NO_XP_APRON_CACHE)
+  int zoomBucket = currentZoomBucket();
+  double scale = converter->getViewport()->radius() / radiusForBucket(zoomBucket);
 
   // Build key and get path from the cache
-  Key key(apron.apronId, zoomDistanceMeter, fast);
+  Key key(apron.apronId, zoomBucket, fast);
   QPainterPath *painterPath = geometryCache.object(key);
 
   if(painterPath != nullptr)
-  {
-    // Found - create a copy and translate it to the needed coordinates
-    QPainterPath boundaryPath(*painterPath);
-
-    // Calculate the coordinates of the reference point (first one) and move the whole path into required place for drawing
-    bool visible;
-    QPointF refPoint = converter->wToSF(apron.geometry.boundary.first().node,
-                                        CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-    boundaryPath.translate(refPoint.x(), refPoint.y());
-
-    return boundaryPath;
-  }
+    // Found - scale a copy from bucket to current zoom and move it into required place for drawing
+    return QTransform(scale, 0., 0., scale, refPoint.x(), refPoint.y()).map(*painterPath);
   else
 #endif
   {
     // qDebug() << Q_FUNC_INFO << "Creating new apron";
 
     // Nothing in cache - create the apron boundary
-    QPainterPath boundaryPath = pathForBoundary(apron.geometry.boundary, fast);
-
-    // Substract holes
-    for(atools::fs::common::Boundary hole : apron.geometry.holes)
-      boundaryPath = boundaryPath.subtracted(pathForBoundary(hole, fast));
+    QPainterPath boundaryPath = pathForGeometry(*converter, apron.geometry, fast);
 
 #if !defined(DEBUG_NO_XP_APRON_CACHE)
-
-    // Calculate reference point (first)
-    bool visible;
-    QPointF refPoint = converter->wToSF(
-      apron.geometry.boundary.first().node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-
-    // Create a copy for the cache
-    painterPath = new QPainterPath(boundaryPath);
-
-    // Move the whole path, so that the reference is at 0,0
-    painterPath->translate(-refPoint.x(), -refPoint.y());
+    // Move the whole path, so that the reference is at 0,0 and scale it to the bucket radius
+    QTransform transform;
+    transform.scale(1. / scale, 1. / scale);
+    transform.translate(-refPoint.x(), -refPoint.y());
 
     // Insert path with reference 0,0
-    geometryCache.insert(key, painterPath);
+    insertPath(key, new QPainterPath(transform.map(boundaryPath)));
 #endif
 
     // Return copy with correct position for drawing
@@ -127,8 +185,157 @@ QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, fl
   }
 }
 
+void ApronGeometryCache::prefetchApronGeometry(const Marble::GeoDataLatLonBox& rect)
+{
+#if !defined(DEBUG_NO_XP_APRON_CACHE)
+  Q_ASSERT(converter != nullptr);
+
+  int zoomBucket = currentZoomBucket();
+  if(zoomBucket == requestedZoomBucket && requestedRect.contains(rect))
+    // Already loaded or loading
+    return;
+
+  if(buildFuture.isRunning())
+  {
+    // Remember only the latest request
+    pendingRect = rect;
+    hasPendingRect = true;
+  }
+  else
+    startPrefetch(rect, zoomBucket);
+#else
+  Q_UNUSED(rect);
+#endif
+}
+
+void ApronGeometryCache::startPrefetch(const Marble::GeoDataLatLonBox& rect, int zoomBucket)
+{
+  requestedRect = rect;
+  requestedZoomBucket = zoomBucket;
+
+  buildFuture = QtConcurrent::run(&ApronGeometryCache::loadAndBuildPaths,
+                                  NavApp::getDatabaseSim()->getQSqlDatabase().databaseName(),
+                                  static_cast<int>(converter->getViewport()->projection()), rect, zoomBucket,
+                                  prefetchedAirports);
+  buildWatcher.setFuture(buildFuture);
+}
+
+void ApronGeometryCache::insertPath(const Key& key, QPainterPath *path)
+{
+  // Approximate size - path data plus overhead for cache entry
+  int bytes = path->elementCount() * static_cast<int>(sizeof(QPainterPath::Element)) + 64;
+  geometryCache.insert(key, path, bytes);
+}
+
+ApronGeometryCache::BuildBatch ApronGeometryCache::loadAndBuildPaths(QString databaseFile, int projection,
+                                                                     Marble::GeoDataLatLonBox rect, int zoomBucket,
+                                                                     QSet<quint64> prefetched)
+{
+  BuildBatch batch;
+
+  // Load geometry using an own connection since the ones of the main thread cannot be used here
+  QHash<int, atools::fs::common::XpGeo> geometries;
+  try
+  {
+    atools::sql::SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME_APRON);
+    {
+      atools::sql::SqlDatabase db(DATABASE_NAME_APRON);
+      db.setDatabaseName(databaseFile);
+      db.open();
+
+      atools::sql::SqlQuery query(&db);
+      query.prepare("select a.apron_id, a.airport_id, a.geometry from apron a "
+                    "join airport p on a.airport_id = p.airport_id "
+                    "where a.geometry is not null and "
+                    "p.lonx between :leftx and :rightx and p.laty between :bottomy and :topy "
+                    "order by a.airport_id");
+
+      int lastAirportId = -1;
+      for(const Marble::GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, 0., 0.))
+      {
+        query::bindCoordinatePointInRect(r, &query);
+        query.exec();
+        while(query.next())
+        {
+          int airportId = query.valueInt("airport_id");
+          if(prefetched.contains(airportKey(airportId, zoomBucket)))
+            continue;
+
+          if(airportId != lastAirportId)
+          {
+            if(batch.airportKeys.size() >= MAX_PREFETCH_AIRPORTS)
+            {
+              batch.complete = false;
+              break;
+            }
+            batch.airportKeys.append(airportKey(airportId, zoomBucket));
+            lastAirportId = airportId;
+          }
+
+          atools::fs::common::XpGeometry geo(query.value("geometry").toByteArray());
+          geometries.insert(query.valueInt("apron_id"), geo.getGeometry());
+        }
+        query.finish();
+
+        if(!batch.complete)
+          break;
+      }
+      db.close();
+    }
+    atools::sql::SqlDatabase::removeDatabase(DATABASE_NAME_APRON);
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Error loading aprons" << e.what();
+    atools::sql::SqlDatabase::removeDatabase(DATABASE_NAME_APRON);
+    batch.airportKeys.clear();
+    batch.complete = false;
+    return batch;
+  }
+
+  // Build fast and detailed paths for the current and the next closer zoom buckets
+  for(auto it = geometries.constBegin(); it != geometries.constEnd(); ++it)
+  {
+    const atools::fs::common::XpGeo& geometry = it.value();
+    if(geometry.boundary.isEmpty())
+      continue;
+
+    for(int bucket = zoomBucket; bucket <= zoomBucket + NUM_PREFETCH_BUCKETS; bucket++)
+    {
+      // Use own viewport centered at the reference point since the one of the map widget cannot be used in
+      // this thread
+      const atools::geo::Pos& ref = geometry.boundary.first().node;
+      Marble::ViewportParams viewport(static_cast<Marble::Projection>(projection),
+                                      atools::geo::toRadians(static_cast<double>(ref.getLonX())),
+                                      atools::geo::toRadians(static_cast<double>(ref.getLatY())),
+                                      static_cast<int>(radiusForBucket(bucket)), QSize(256, 256));
+      CoordinateConverter conv(&viewport);
+
+      bool visible;
+      QPointF refPoint = conv.wToSF(ref, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+      for(bool fast : {true, false})
+        batch.results.append({Key(it.key(), bucket, fast),
+                              pathForGeometry(conv, geometry, fast).translated(-refPoint)});
+    }
+  }
+  return batch;
+}
+
+QPainterPath ApronGeometryCache::pathForGeometry(const CoordinateConverter& conv,
+                                                 const atools::fs::common::XpGeo& geometry, bool fast)
+{
+  QPainterPath boundaryPath = pathForBoundary(conv, geometry.boundary, fast);
+
+  // Substract holes
+  for(const atools::fs::common::Boundary& hole : geometry.holes)
+    boundaryPath = boundaryPath.subtracted(pathForBoundary(conv, hole, fast));
+
+  return boundaryPath;
+}
+
 /* Calculate X-Plane aprons including bezier curves */
-QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast)
+QPainterPath ApronGeometryCache::pathForBoundary(const CoordinateConverter& conv,
+                                                 const atools::fs::common::Boundary& boundaryNodes, bool fast)
 {
   bool visible;
   QPainterPath apronPath;
@@ -143,12 +350,12 @@ QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Bound
   int i = 0;
   for(const atools::fs::common::Node& node : boundary)
   {
-    QPointF lastPt = converter->wToSF(lastNode.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-    QPointF pt = converter->wToSF(node.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+    QPointF lastPt = conv.wToSF(lastNode.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+    QPointF pt = conv.wToSF(node.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
 
     if(i == 0)
       // First point
-      apronPath.moveTo(converter->wToS(node.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible));
+      apronPath.moveTo(pt);
     else if(fast)
       // Use lines only for fast drawing
       apronPath.lineTo(pt);
@@ -157,23 +364,23 @@ QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Bound
       if(lastNode.control.isValid() && node.control.isValid())
       {
         // Two successive control points - use cubic curve
-        QPointF controlPoint1 = converter->wToSF(lastNode.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-        QPointF controlPoint2 = converter->wToSF(node.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+        QPointF controlPoint1 = conv.wToSF(lastNode.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+        QPointF controlPoint2 = conv.wToSF(node.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
         apronPath.cubicTo(controlPoint1, pt + (pt - controlPoint2), pt);
       }
       else if(lastNode.control.isValid())
       {
         // One control point from last - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(converter->wToSF(lastNode.control,
-                                            CoordinateConverter::DEFAULT_WTOS_SIZE, &visible), pt);
+          apronPath.quadTo(conv.wToSF(lastNode.control,
+                                      CoordinateConverter::DEFAULT_WTOS_SIZE, &visible), pt);
       }
       else if(node.control.isValid())
       {
         // One control point from current - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(pt + (pt - converter->wToSF(node.control,
-                                                       CoordinateConverter::DEFAULT_WTOS_SIZE, &visible)), pt);
+          apronPath.quadTo(pt + (pt - conv.wToSF(node.control,
+                                                 CoordinateConverter::DEFAULT_WTOS_SIZE, &visible)), pt);
       }
       else
         // No control point - simple line
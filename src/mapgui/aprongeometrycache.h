@@ -21,7 +21,12 @@
 #include "fs/common/xpgeometry.h"
 
 #include <QCache>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QPainterPath>
+#include <QSet>
+
+#include <marble/GeoDataLatLonBox.h>
 
 class QPainterPath;
 class CoordinateConverter;
@@ -34,9 +39,13 @@ struct MapApron;
 }
 
 /*
- * Caches the complex X-Plane apron geometry in screen coordinates by zoom level and draw fast flag.
+ * Caches the complex X-Plane apron geometry in screen coordinates by zoom bucket and draw fast flag.
+ *
+ * Zoom is quantized into buckets of one power of two of the globe radius. Paths are stored for the
+ * bucket radius with the first boundary point at 0,0 and are scaled and moved into place when requested.
  *
- * This will keep a copy of a QPainterPath of an apron for a given zoomlevel until the cache overflows.
+ * The cache is limited by the approximate size of all paths in bytes. Paths for airports which are about
+ * to become visible can be loaded and built in a background thread using prefetchApronGeometry().
  */
 class ApronGeometryCache
 {
@@ -45,10 +54,15 @@ public:
   ~ApronGeometryCache();
 
   /* Get apron geometry in screen coordinates from the cache or create it from map::MapApron.
-   * Combined key is apron ID, zoom and draw fast flag */
-  QPainterPath getApronGeometry(const map::MapApron& apron, float zoomDistanceMeter, bool fast);
+   * Combined key is apron ID, zoom bucket and draw fast flag */
+  QPainterPath getApronGeometry(const map::MapApron& apron, bool fast);
+
+  /* Load X-Plane aprons of all airports in rect in a background thread using an own database connection and
+   * build fast and detailed paths for the current and the next closer zoom bucket.
+   * Does nothing if the rect was already covered at this zoom. Call only for X-Plane databases. */
+  void prefetchApronGeometry(const Marble::GeoDataLatLonBox& rect);
 
-  /* Clear the cache */
+  /* Clear the cache and drop all queued background work */
   void clear();
 
   /* Has to be set before using it */
@@ -58,11 +72,15 @@ private:
   /* Cache key used to identify a QPainterPath for an apron */
   struct Key
   {
-    Key(int apronIdParam, float zoomDistanceMeterParam, bool fastParam);
+    Key()
+    {
+    }
 
-    int apronId;
-    int zoomDistanceMeter;
-    bool fast; /* Draw fast flag - no curves if true */
+    Key(int apronIdParam, int zoomBucketParam, bool fastParam);
+
+    int apronId = -1;
+    int zoomBucket = 0; /* Quantized radius of the globe */
+    bool fast = false; /* Draw fast flag - no curves if true */
 
     bool operator!=(const ApronGeometryCache::Key& other) const;
     bool operator==(const ApronGeometryCache::Key& other) const;
@@ -71,15 +89,74 @@ private:
 
   friend uint qHash(const ApronGeometryCache::Key& key);
 
+  /* Path for bucket radius with reference point at 0,0 */
+  struct BuildResult
+  {
+    Key key;
+    QPainterPath path;
+  };
+
+  /* Output of background thread */
+  struct BuildBatch
+  {
+    QVector<BuildResult> results;
+    QVector<quint64> airportKeys; /* Airports loaded for the zoom bucket */
+    bool complete = true; /* false if the number of airports was limited */
+  };
+
   /* Calculate X-Plane aprons including bezier curves */
-  QPainterPath pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast);
+  static QPainterPath pathForBoundary(const CoordinateConverter& conv,
+                                      const atools::fs::common::Boundary& boundaryNodes, bool fast);
+
+  /* Build boundary and subtract holes */
+  static QPainterPath pathForGeometry(const CoordinateConverter& conv, const atools::fs::common::XpGeo& geometry,
+                                      bool fast);
+
+  /* Runs in background thread using an own database connection and own viewports centered at the aprons.
+   * Airports in prefetched are skipped. */
+  static BuildBatch loadAndBuildPaths(QString databaseFile, int projection, Marble::GeoDataLatLonBox rect,
+                                      int zoomBucket, QSet<quint64> prefetched);
 
-  /* Some airport have more than 100 apron parts */
-  static const int CACHE_SIZE = 2000;
+  /* Add path to cache using the approximate size in bytes as cost */
+  void insertPath(const Key& key, QPainterPath *path);
+
+  /* Start background thread for rect at the given zoom bucket */
+  void startPrefetch(const Marble::GeoDataLatLonBox& rect, int zoomBucket);
+
+  /* Get zoom bucket for the current radius */
+  int currentZoomBucket() const;
+
+  static double radiusForBucket(int zoomBucket);
+
+  /* Aprons take about 100 bytes per node and some airport have more than 100 apron parts */
+  static const int CACHE_SIZE_BYTES = 32 * 1024 * 1024;
+
+  /* Number of closer zoom buckets to prepare in background */
+  static const int NUM_PREFETCH_BUCKETS = 1;
+
+  /* Limit number of airports loaded by one background run. The rest is loaded by the next one. */
+  static const int MAX_PREFETCH_AIRPORTS = 20;
 
   /* Used to convert world to screen coordinates */
   CoordinateConverter *converter = nullptr;
   QCache<Key, QPainterPath> geometryCache;
+
+  /* Airport id and zoom bucket combined */
+  QSet<quint64> prefetchedAirports;
+
+  /* Rectangle and zoom bucket of the last started background run. Bucket is -1 if not covered completely. */
+  Marble::GeoDataLatLonBox requestedRect;
+  int requestedZoomBucket = -1;
+
+  /* Latest rectangle requested while the thread was running */
+  Marble::GeoDataLatLonBox pendingRect;
+  bool hasPendingRect = false;
+
+  QFuture<BuildBatch> buildFuture;
+  QFutureWatcher<BuildBatch> buildWatcher;
+
+  /* Set by clear() to drop the results of a running thread */
+  bool discardResults = false;
 };
 
 #endif // LNM_APRONGEOMETRYCACHE_H
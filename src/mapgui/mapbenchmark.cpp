@@ -0,0 +1,248 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapbenchmark.h"
+
+#include "mapgui/mapwidget.h"
+#include "mapgui/mappaintlayer.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QSettings>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtMath>
+
+const QSize MapBenchmark::DEFAULT_IMAGE_SIZE(1280, 1024);
+
+MapBenchmark::MapBenchmark(MapWidget *mapWidgetParam)
+  : mapWidget(mapWidgetParam)
+{
+
+}
+
+bool MapBenchmark::loadScript(const QString& filename)
+{
+  qInfo() << Q_FUNC_INFO << "Loading benchmark script from" << filename;
+
+  frames.clear();
+
+  if(!QFileInfo::exists(filename))
+  {
+    qWarning() << Q_FUNC_INFO << "Benchmark script" << filename << "not found";
+    return false;
+  }
+
+  QSettings settings(filename, QSettings::IniFormat);
+  for(const QString& group : settings.childGroups())
+  {
+    settings.beginGroup(group);
+
+    bool okLon, okLat, okDist;
+    Frame keyFrame;
+    keyFrame.label = settings.value("label", group).toString();
+    keyFrame.center = atools::geo::Pos(settings.value("lonx").toFloat(&okLon), settings.value("laty").toFloat(&okLat));
+    keyFrame.distanceKm = settings.value("distance").toDouble(&okDist);
+    keyFrame.projection = settings.value("projection", "mercator").toString().toLower() == "spherical" ?
+                          Marble::Spherical : Marble::Mercator;
+    int steps = qMax(settings.value("steps", 1).toInt(), 1);
+    settings.endGroup();
+
+    if(!okLon || !okLat || !okDist || keyFrame.distanceKm <= 0.)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid or missing values in frame" << group;
+      continue;
+    }
+
+    if(frames.isEmpty() || steps == 1)
+      frames.append(keyFrame);
+    else
+    {
+      // Interpolate from last key frame - position linear and distance logarithmic for constant zoom speed
+      const Frame last = frames.last();
+      double lastDistLog = std::log(last.distanceKm), distLog = std::log(keyFrame.distanceKm);
+      for(int i = 1; i <= steps; i++)
+      {
+        double t = static_cast<double>(i) / steps;
+        Frame frame(keyFrame);
+        frame.label = QString("%1 %2/%3").arg(keyFrame.label).arg(i).arg(steps);
+        frame.center = atools::geo::Pos(
+          static_cast<float>(last.center.getLonX() + (keyFrame.center.getLonX() - last.center.getLonX()) * t),
+          static_cast<float>(last.center.getLatY() + (keyFrame.center.getLatY() - last.center.getLatY()) * t));
+        frame.distanceKm = std::exp(lastDistLog + (distLog - lastDistLog) * t);
+        frames.append(frame);
+      }
+    }
+  }
+
+  qInfo() << Q_FUNC_INFO << "Loaded" << frames.size() << "frames";
+  return !frames.isEmpty();
+}
+
+void MapBenchmark::run(QTextStream& out, const QSize& size)
+{
+  qInfo() << Q_FUNC_INFO << "Running benchmark with" << frames.size() << "frames and size" << size;
+
+  MapPaintLayer *paintLayer = mapWidget->getMapPaintLayer();
+  paintLayer->setCollectPainterTimes(true);
+
+  // Keep projection to restore it later
+  Marble::Projection projection = mapWidget->projection();
+  mapWidget->resize(size);
+
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  QVector<FrameResult> results;
+  for(const Frame& frame : frames)
+    results.append(renderFrame(frame, image));
+
+  paintLayer->setCollectPainterTimes(false);
+  mapWidget->setProjection(projection);
+
+  // Collect names of all painters that were called at least once for the report columns
+  QStringList painterNames;
+  for(const FrameResult& result : results)
+  {
+    for(const QString& name : result.painterTimesNs.keys())
+    {
+      if(!painterNames.contains(name))
+        painterNames.append(name);
+    }
+  }
+  painterNames.sort();
+
+  // Write CSV report ======================================
+  out << "frame;label;projection;lonx;laty;distance;frame_ms;layer_ms";
+  for(const QString& name : painterNames)
+    out << ";" << name << "_ms";
+  out << ";complete;hash" << endl;
+
+  double totalMs = 0., maxMs = 0.;
+  for(int i = 0; i < results.size(); i++)
+  {
+    const Frame& frame = frames.at(i);
+    const FrameResult& result = results.at(i);
+
+    out << i << ";\"" << frame.label << "\";"
+        << (frame.projection == Marble::Spherical ? "spherical" : "mercator") << ";"
+        << frame.center.getLonX() << ";" << frame.center.getLatY() << ";" << frame.distanceKm << ";"
+        << result.frameMs << ";" << result.layerMs;
+
+    for(const QString& name : painterNames)
+      out << ";" << result.painterTimesNs.value(name, 0) / 1000000.;
+    out << ";" << (result.complete ? 1 : 0) << ";" << result.hash << endl;
+
+    totalMs += result.frameMs;
+    maxMs = qMax(maxMs, result.frameMs);
+  }
+
+  if(!results.isEmpty())
+    qInfo() << Q_FUNC_INFO << "Frames" << results.size() << "total ms" << totalMs
+            << "average ms" << totalMs / results.size() << "max ms" << maxMs;
+}
+
+MapBenchmark::FrameResult MapBenchmark::renderFrame(const Frame& frame, QImage& image)
+{
+  FrameResult result;
+
+  mapWidget->setProjection(frame.projection);
+  mapWidget->centerOn(frame.center.getLonX(), frame.center.getLatY(), false /* animated */);
+  mapWidget->setDistance(frame.distanceKm);
+
+  // Load all tiles and data for this view before measuring
+  result.complete = waitForIdle(image);
+  if(!result.complete)
+    qWarning() << Q_FUNC_INFO << frame.label << "loading not finished after" << IDLE_TIMEOUT_MS << "ms";
+
+  image.fill(Qt::white);
+
+  QPainter painter(&image);
+  QElapsedTimer timer;
+  timer.start();
+  mapWidget->render(&painter);
+  result.frameMs = timer.nsecsElapsed() / 1000000.;
+  painter.end();
+
+  const MapPaintLayer *paintLayer = mapWidget->getMapPaintLayer();
+  result.painterTimesNs = paintLayer->getPainterTimesNs();
+
+  // Sum up painters since the layer total is rounded to milliseconds
+  qint64 layerNs = 0;
+  for(qint64 ns : result.painterTimesNs)
+    layerNs += ns;
+  result.layerMs = layerNs / 1000000.;
+
+  result.hash = imageHash(image);
+
+  qDebug() << Q_FUNC_INFO << frame.label << "frame ms" << result.frameMs << "layer ms" << result.layerMs
+           << result.hash;
+  return result;
+}
+
+bool MapBenchmark::waitForIdle(QImage& image)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  int numIdle = 0;
+  while(timer.elapsed() < IDLE_TIMEOUT_MS)
+  {
+    // Rendering requests missing tiles and data and updates the render status
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    mapWidget->render(&painter);
+    painter.end();
+
+    // Receive downloaded tiles, results of background threads and progressive render timers
+    QCoreApplication::processEvents(QEventLoop::AllEvents, IDLE_POLL_MS);
+    QThread::msleep(IDLE_POLL_MS);
+    QCoreApplication::processEvents(QEventLoop::AllEvents, IDLE_POLL_MS);
+
+    if(isIdle())
+    {
+      if(++numIdle >= IDLE_NUM_CHECKS)
+        return true;
+    }
+    else
+      numIdle = 0;
+  }
+  return false;
+}
+
+bool MapBenchmark::isIdle() const
+{
+  return mapWidget->renderStatus() == Marble::Complete &&
+         QThreadPool::globalInstance()->activeThreadCount() == 0 &&
+         mapWidget->getMapPaintLayer()->isProgressiveComplete();
+}
+
+QString MapBenchmark::imageHash(const QImage& image)
+{
+  QCryptographicHash hash(QCryptographicHash::Md5);
+
+  // Hash line by line since lines can be padded
+  int lineBytes = image.width() * image.depth() / 8;
+  for(int y = 0; y < image.height(); y++)
+    hash.addData(reinterpret_cast<const char *>(image.constScanLine(y)), lineBytes);
+
+  return QString::fromLatin1(hash.result().toHex());
+}
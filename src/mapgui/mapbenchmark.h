@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_MAPBENCHMARK_H
+#define LITTLENAVMAP_MAPBENCHMARK_H
+
+#include "geo/pos.h"
+
+#include <QMap>
+#include <QSize>
+#include <QVector>
+
+#include <marble/MarbleGlobal.h>
+
+class MapWidget;
+class QTextStream;
+
+/*
+ * Rendering benchmark for the map painters. Reads a script of key frames, moves the map through all frames and
+ * renders each one into an offscreen image. Reports frame and painter timings as well as an image hash
+ * which can be used to detect rendering changes.
+ *
+ * Each frame is rendered repeatedly until Marble has loaded all tiles, no background jobs are running and
+ * progressive rendering has reached full detail. Only the last rendering is measured.
+ *
+ * Started by the command line option "--map-benchmark". Can run headless using the Qt offscreen platform plugin
+ * (command line "-platform offscreen").
+ */
+class MapBenchmark
+{
+public:
+  MapBenchmark(MapWidget *mapWidgetParam);
+
+  /* Load key frames from an INI script file. See mapbenchmark.cfg for the format.
+   * @return false if the file could not be read or contains no frames. */
+  bool loadScript(const QString& filename);
+
+  /* Render all frames into an image of the given size and write a CSV report into the stream */
+  void run(QTextStream& out, const QSize& size = DEFAULT_IMAGE_SIZE);
+
+  int getNumFrames() const
+  {
+    return frames.size();
+  }
+
+  static const QSize DEFAULT_IMAGE_SIZE;
+
+private:
+  struct Frame
+  {
+    QString label;
+    atools::geo::Pos center;
+    double distanceKm;
+    Marble::Projection projection;
+  };
+
+  struct FrameResult
+  {
+    double frameMs, layerMs;
+    QMap<QString, qint64> painterTimesNs;
+    QString hash;
+    bool complete; /* false if loading did not finish within IDLE_TIMEOUT_MS */
+  };
+
+  /* Render a single frame into image and collect the timings */
+  FrameResult renderFrame(const Frame& frame, QImage& image);
+
+  /* Render the current view into image until all tiles and data are loaded.
+   * @return false if loading did not finish within IDLE_TIMEOUT_MS */
+  bool waitForIdle(QImage& image);
+
+  /* true if Marble has all tiles, no background jobs are running and all detail is drawn */
+  bool isIdle() const;
+
+  /* Maximum time to wait for loading per frame */
+  static Q_DECL_CONSTEXPR int IDLE_TIMEOUT_MS = 30000;
+
+  /* Time to process events between two checks */
+  static Q_DECL_CONSTEXPR int IDLE_POLL_MS = 50;
+
+  /* Number of successive idle checks needed to consider a frame as loaded */
+  static Q_DECL_CONSTEXPR int IDLE_NUM_CHECKS = 3;
+
+  /* MD5 hash of all pixels excluding any padding bytes */
+  static QString imageHash(const QImage& image);
+
+  QVector<Frame> frames;
+  MapWidget *mapWidget;
+};
+
+#endif // LITTLENAVMAP_MAPBENCHMARK_H
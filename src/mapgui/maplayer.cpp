@@ -31,6 +31,32 @@ MapLayer MapLayer::clone(float maximumRange) const
   return retval;
 }
 
+MapLayer MapLayer::withoutText() const
+{
+  // Query parameters are not changed to keep the cached results valid
+  MapLayer retval = *this;
+  retval.layerApproachTextAndDetail = false;
+  retval.layerAirportIdent = retval.layerAirportName = retval.layerAirportInfo = false;
+  retval.layerAirportWeatherDetails = false;
+  retval.layerWaypointName = false;
+  retval.layerVorIdent = retval.layerVorInfo = false;
+  retval.layerNdbIdent = retval.layerNdbInfo = false;
+  retval.layerIlsIdent = retval.layerIlsInfo = false;
+  retval.layerMarkerInfo = false;
+  retval.layerAirwayIdent = retval.layerAirwayInfo = false;
+  retval.layerUserpointInfo = false;
+  retval.layerAiAircraftGroundText = retval.layerAiAircraftText = retval.layerOnlineAircraftText = false;
+  return retval;
+}
+
+MapLayer MapLayer::withoutDetail() const
+{
+  MapLayer retval = *this;
+  retval.layerAirportDiagramDetail = retval.layerAirportDiagramDetail2 = retval.layerAirportDiagramDetail3 = false;
+  retval.layerVorLarge = false;
+  return retval;
+}
+
 bool MapLayer::hasSameQueryParametersAirport(const MapLayer *other) const
 {
   // Either the source query changes or minimum runway length which need a new query
@@ -59,6 +59,12 @@ public:
    */
   MapLayer clone(float maximumRange) const;
 
+  /* Create a copy with all navaid, airport and aircraft labels disabled. Used for progressive rendering. */
+  MapLayer withoutText() const;
+
+  /* Create a copy with airport diagram details and large VOR symbols disabled. Used for progressive rendering. */
+  MapLayer withoutDetail() const;
+
   /* @return true if a query for this layer will give the same result set */
   bool hasSameQueryParametersAirport(const MapLayer *other) const;
   bool hasSameQueryParametersAirspace(const MapLayer *other) const;
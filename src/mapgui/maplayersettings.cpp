@@ -17,8 +17,132 @@
 
 #include "mapgui/maplayersettings.h"
 
+#include <QSettings>
+#include <QHash>
+
 #include <algorithm>
 #include <functional>
+#include <cmath>
+
+namespace {
+typedef MapLayer& (MapLayer::*BoolSetterType)(bool);
+typedef MapLayer& (MapLayer::*IntSetterType)(int);
+
+/* Maps configuration file keys to MapLayer builder methods */
+const QHash<QString, BoolSetterType>& boolSetters()
+{
+  static const QHash<QString, BoolSetterType> SETTERS(
+  {
+    {"airport", &MapLayer::airport},
+    {"approach", &MapLayer::approach},
+    {"approachTextAndDetail", &MapLayer::approachTextAndDetail},
+    {"routeTextAndDetail", &MapLayer::routeTextAndDetail},
+    {"airportOverviewRunway", &MapLayer::airportOverviewRunway},
+    {"airportDiagramRunway", &MapLayer::airportDiagramRunway},
+    {"airportDiagram", &MapLayer::airportDiagram},
+    {"airportDiagramDetail", &MapLayer::airportDiagramDetail},
+    {"airportDiagramDetail2", &MapLayer::airportDiagramDetail2},
+    {"airportDiagramDetail3", &MapLayer::airportDiagramDetail3},
+    {"airportSoft", &MapLayer::airportSoft},
+    {"airportNoRating", &MapLayer::airportNoRating},
+    {"airportIdent", &MapLayer::airportIdent},
+    {"airportName", &MapLayer::airportName},
+    {"airportInfo", &MapLayer::airportInfo},
+    {"airportRouteInfo", &MapLayer::airportRouteInfo},
+    {"airportWeather", &MapLayer::airportWeather},
+    {"airportWeatherDetails", &MapLayer::airportWeatherDetails},
+    {"waypoint", &MapLayer::waypoint},
+    {"waypointName", &MapLayer::waypointName},
+    {"waypointRouteName", &MapLayer::waypointRouteName},
+    {"userpoint", &MapLayer::userpoint},
+    {"userpointInfo", &MapLayer::userpointInfo},
+    {"vor", &MapLayer::vor},
+    {"vorLarge", &MapLayer::vorLarge},
+    {"vorIdent", &MapLayer::vorIdent},
+    {"vorInfo", &MapLayer::vorInfo},
+    {"vorRouteIdent", &MapLayer::vorRouteIdent},
+    {"vorRouteInfo", &MapLayer::vorRouteInfo},
+    {"ndb", &MapLayer::ndb},
+    {"ndbIdent", &MapLayer::ndbIdent},
+    {"ndbInfo", &MapLayer::ndbInfo},
+    {"ndbRouteIdent", &MapLayer::ndbRouteIdent},
+    {"ndbRouteInfo", &MapLayer::ndbRouteInfo},
+    {"marker", &MapLayer::marker},
+    {"markerInfo", &MapLayer::markerInfo},
+    {"ils", &MapLayer::ils},
+    {"ilsIdent", &MapLayer::ilsIdent},
+    {"ilsInfo", &MapLayer::ilsInfo},
+    {"airway", &MapLayer::airway},
+    {"airwayWaypoint", &MapLayer::airwayWaypoint},
+    {"airwayIdent", &MapLayer::airwayIdent},
+    {"airwayInfo", &MapLayer::airwayInfo},
+    {"airspaceCenter", &MapLayer::airspaceCenter},
+    {"airspaceIcao", &MapLayer::airspaceIcao},
+    {"airspaceFir", &MapLayer::airspaceFir},
+    {"airspaceRestricted", &MapLayer::airspaceRestricted},
+    {"airspaceSpecial", &MapLayer::airspaceSpecial},
+    {"airspaceOther", &MapLayer::airspaceOther},
+    {"aiAircraftGround", &MapLayer::aiAircraftGround},
+    {"aiAircraftSmall", &MapLayer::aiAircraftSmall},
+    {"aiAircraftLarge", &MapLayer::aiAircraftLarge},
+    {"aiShipSmall", &MapLayer::aiShipSmall},
+    {"aiShipLarge", &MapLayer::aiShipLarge},
+    {"aiAircraftGroundText", &MapLayer::aiAircraftGroundText},
+    {"aiAircraftText", &MapLayer::aiAircraftText},
+    {"onlineAircraft", &MapLayer::onlineAircraft},
+    {"onlineAircraftText", &MapLayer::onlineAircraftText},
+    {"minimumAltitude", &MapLayer::minimumAltitude}
+  });
+  return SETTERS;
+}
+
+const QHash<QString, IntSetterType>& intSetters()
+{
+  static const QHash<QString, IntSetterType> SETTERS(
+  {
+    {"airportSymbolSize", &MapLayer::airportSymbolSize},
+    {"minRunwayLength", &MapLayer::minRunwayLength},
+    {"airportMaxTextLength", &MapLayer::airportMaxTextLength},
+    {"waypointSymbolSize", &MapLayer::waypointSymbolSize},
+    {"userpointSymbolSize", &MapLayer::userpoinSymbolSize},
+    {"userpointMaxTextLength", &MapLayer::userpointMaxTextLength},
+    {"vorSymbolSize", &MapLayer::vorSymbolSize},
+    {"ndbSymbolSize", &MapLayer::ndbSymbolSize},
+    {"markerSymbolSize", &MapLayer::markerSymbolSize}
+  });
+  return SETTERS;
+}
+
+/* Apply all keys in the current group of settings to the layer */
+void readLayer(QSettings& settings, MapLayer& layer)
+{
+  for(const QString& key : settings.childKeys())
+  {
+    if(key == "range")
+      continue;
+
+    if(key == "airportSource")
+    {
+      QString source = settings.value(key).toString().toLower();
+      if(source == "all")
+        layer.airportSource(layer::ALL);
+      else if(source == "medium")
+        layer.airportSource(layer::MEDIUM);
+      else if(source == "large")
+        layer.airportSource(layer::LARGE);
+      else
+        qWarning() << Q_FUNC_INFO << "Invalid airport source" << source << "in" << settings.group();
+    }
+    else if(boolSetters().contains(key))
+      (layer.*boolSetters().value(key))(settings.value(key).toBool());
+    else if(intSetters().contains(key))
+      (layer.*intSetters().value(key))(settings.value(key).toInt());
+    else
+      qWarning() << Q_FUNC_INFO << "Unknown key" << key << "in" << settings.group();
+  }
+}
+
+}
 
 MapLayerSettings::MapLayerSettings()
 {
@@ -33,30 +157,93 @@ MapLayerSettings& MapLayerSettings::append(const MapLayer& layer)
 
 void MapLayerSettings::finishAppend()
 {
+  using namespace std::placeholders;
+
   std::sort(layers.begin(), layers.end());
+
+  // Build lookup table with the index of the first layer for the lower boundary of each bucket
+  layerIndexByBucket.clear();
+  layerIndexByBucket.reserve(NUM_BUCKETS);
+  for(int bucket = 0; bucket < NUM_BUCKETS; bucket++)
+  {
+    float distance = std::pow(2.f, static_cast<float>(bucket) / BUCKETS_PER_OCTAVE + MIN_OCTAVE);
+    layerIndexByBucket.append(static_cast<int>(std::lower_bound(layers.begin(), layers.end(), distance,
+                                                                std::bind(&MapLayerSettings::compare, this, _1, _2))
+                                               - layers.begin()));
+  }
 }
 
-const MapLayer *MapLayerSettings::getLayer(float distance, int detailFactor) const
+bool MapLayerSettings::loadFromFile(const QString& filename)
 {
-  using namespace std::placeholders;
+  qInfo() << Q_FUNC_INFO << "Loading map layers from" << filename;
+
+  QSettings settings(filename, QSettings::IniFormat);
+
+  // Template for all layers
+  MapLayer defLayer(0.f);
+  settings.beginGroup("default");
+  readLayer(settings, defLayer);
+  settings.endGroup();
+
+  layers.clear();
+  for(const QString& group : settings.childGroups())
+  {
+    if(group == "default")
+      continue;
 
+    settings.beginGroup(group);
+    bool ok;
+    float range = settings.value("range").toFloat(&ok);
+    if(ok && range > 0.f)
+    {
+      MapLayer layer = defLayer.clone(range);
+      readLayer(settings, layer);
+      layers.append(layer);
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Missing or invalid range in layer" << group;
+    settings.endGroup();
+  }
+
+  finishAppend();
+  return !layers.isEmpty();
+}
+
+int MapLayerSettings::bucketForDistance(float distance) const
+{
+  if(distance <= 0.f)
+    return 0;
+
+  int bucket = static_cast<int>((std::log2(distance) - MIN_OCTAVE) * BUCKETS_PER_OCTAVE);
+  return std::max(0, std::min(bucket, NUM_BUCKETS - 1));
+}
+
+int MapLayerSettings::findLayerIndex(float distance) const
+{
+  // Table gives the first candidate - move if the bucket contains a layer boundary or for rounding errors
+  int index = layerIndexByBucket.at(bucketForDistance(distance));
+  while(index < layers.size() && compare(layers.at(index), distance))
+    index++;
+  while(index > 0 && !compare(layers.at(index - 1), distance))
+    index--;
+  return index;
+}
+
+const MapLayer *MapLayerSettings::getLayer(float distance, int detailFactor) const
+{
   // Get the layer with the next lowest zoom distance
-  QList<MapLayer>::const_iterator it = std::lower_bound(layers.begin(), layers.end(), distance,
-                                                        std::bind(&MapLayerSettings::compare, this, _1, _2));
+  int index = findLayerIndex(distance);
 
-  // Adjust iterator for detail level changes
-  if(detailFactor > MAP_DEFAULT_DETAIL_FACTOR)
-    it -= detailFactor - MAP_DEFAULT_DETAIL_FACTOR;
-  else if(detailFactor < MAP_DEFAULT_DETAIL_FACTOR)
-    it += MAP_DEFAULT_DETAIL_FACTOR - detailFactor;
+  // Adjust index for detail level changes
+  index -= detailFactor - MAP_DEFAULT_DETAIL_FACTOR;
 
-  if(it >= layers.end())
+  if(index >= layers.size())
     return &layers.last();
 
-  if(it < layers.begin())
-    return &(*(layers.begin()));
+  if(index < 0)
+    return &layers.first();
 
-  return &(*it);
+  return &layers.at(index);
 }
 
 bool MapLayerSettings::compare(const MapLayer& layer, float distance) const
@@ -21,6 +21,7 @@
 #include "mapgui/maplayer.h"
 
 #include <QList>
+#include <QVector>
 
 /*
  * A list of map layers that defines what is painted at what zoom distance
@@ -33,9 +34,14 @@ public:
   /* Add a map layer. Call finishAppend when done. */
   MapLayerSettings& append(const MapLayer& layer);
 
-  /* Call when done appending layers. Sorts all layers by zoom distance. */
+  /* Call when done appending layers. Sorts all layers by zoom distance and builds the lookup table. */
   void finishAppend();
 
+  /* Load all layers from the given INI file. Section "default" is used as template for all other layers
+   * and each other section defines a layer. Calls finishAppend.
+   * @return false if no layers could be loaded */
+  bool loadFromFile(const QString& filename);
+
   static Q_DECL_CONSTEXPR int MAP_DEFAULT_DETAIL_FACTOR = 10;
   static Q_DECL_CONSTEXPR int MAP_MAX_DETAIL_FACTOR = 15;
   static Q_DECL_CONSTEXPR int MAP_MIN_DETAIL_FACTOR = 5;
@@ -48,7 +54,22 @@ private:
 
   bool compare(const MapLayer& layer, float distance) const;
 
+  /* Index into the lookup table for the given distance */
+  int bucketForDistance(float distance) const;
+
+  /* Index of the layer with the next lowest zoom distance. Same as lower_bound */
+  int findLayerIndex(float distance) const;
+
+  /* Lookup table is built for zoom distances with this resolution on a logarithmic scale */
+  static Q_DECL_CONSTEXPR int BUCKETS_PER_OCTAVE = 8;
+  static Q_DECL_CONSTEXPR int MIN_OCTAVE = -10; /* 2^-10 = 0.001 NM */
+  static Q_DECL_CONSTEXPR int MAX_OCTAVE = 18; /* 2^18 = 262144 NM */
+  static Q_DECL_CONSTEXPR int NUM_BUCKETS = (MAX_OCTAVE - MIN_OCTAVE) * BUCKETS_PER_OCTAVE + 1;
+
   QList<MapLayer> layers;
+
+  /* Index of the lowest layer covering the lower end of each bucket */
+  QVector<int> layerIndexByBucket;
 };
 
 #endif // LITTLENAVMAP_MAPLAYERSETTINGS_H
@@ -57,12 +57,14 @@ struct PaintContext
                              *  should be used to visibility of map objects */
   const MapLayer *mapLayerEffective; /* layer for the current zoom distance not affected by detail level.
                                       *  Should be used to determine text visibility and object sizes. */
+  const MapLayer *mapLayerZoomIn; /* Effective layer for the next closer zoom step to prepare data in background */
   Marble::GeoPainter *painter;
   Marble::ViewportParams *viewport;
   Marble::ViewContext viewContext;
   float zoomDistanceMeter;
   bool drawFast; /* true if reduced details should be used */
   bool lazyUpdate; /* postpone reloading until map is still */
+  bool drawDetail; /* false in the first progressive stages - omit area fills and detailed geometry */
   map::MapObjectTypes objectTypes; /* Object types that should be drawn */
   map::MapObjectDisplayTypes objectDisplayTypes; /* Object types that should be drawn */
   map::MapAirspaceFilter airspaceFilterByLayer; /* Airspaces */
@@ -22,6 +22,7 @@
 #include "online/onlinedatacontroller.h"
 #include "mapgui/maplayer.h"
 #include "mapgui/mapfunctions.h"
+#include "mapgui/trafficstore.h"
 #include "util/paintercontextsaver.h"
 #include "geo/calculations.h"
 
@@ -47,6 +48,8 @@ MapPainterAircraft::~MapPainterAircraft()
 
 void MapPainterAircraft::render(PaintContext *context)
 {
+  userAircraftRect = windPointerRect = QRect();
+
   if(!(context->objectTypes & map::AIRCRAFT_ALL) && !context->objectTypes.testFlag(map::AIRCRAFT_TRACK))
     // If actions are unchecked return
     return;
@@ -64,37 +67,41 @@ void MapPainterAircraft::render(PaintContext *context)
   if(context->objectTypes & map::AIRCRAFT_AI)
   {
     // Merge simulator aircraft and online aircraft
-    QVector<const atools::fs::sc::SimConnectAircraft *> allAircraft;
+    QVector<TrafficStore::Vehicle> allAircraft;
 
     // Filters duplicates from simulator and user aircraft out
     const QList<atools::fs::sc::SimConnectAircraft> *onlineAircraft = NavApp::getOnlinedataController()->getAircraft(
       context->viewport->viewLatLonAltBox(), context->mapLayer, context->lazyUpdate);
 
     for(const atools::fs::sc::SimConnectAircraft& ac : *onlineAircraft)
-      allAircraft.append(&ac);
+      allAircraft.append({&ac, ac.getPosition()});
 
     if(NavApp::isConnected() || mapWidget->getUserAircraft().isDebug())
     {
-      for(const SimConnectAircraft& ac : mapWidget->getAiAircraft())
+      // Get only simulator aircraft in view with interpolated positions
+      QVector<TrafficStore::Vehicle> vehicles;
+      mapWidget->getTraffic().getVehicles(vehicles, context->viewport->viewLatLonAltBox());
+
+      for(const TrafficStore::Vehicle& vehicle : vehicles)
       {
-        if(ac.getCategory() != atools::fs::sc::BOAT)
-          allAircraft.append(&ac);
+        if(vehicle.aircraft->getCategory() != atools::fs::sc::BOAT)
+          allAircraft.append(vehicle);
       }
     }
 
     // Sort by distance to user aircraft
     struct AiDistType
     {
-      const SimConnectAircraft *aircraft;
+      const TrafficStore::Vehicle *vehicle;
       float distanceLateralMeter, distanceVerticalFt;
     };
 
     QVector<AiDistType> aiSorted;
 
-    for(const SimConnectAircraft *ac : allAircraft)
-      aiSorted.append({ac,
-                       pos.distanceMeterTo(ac->getPosition()),
-                       std::abs(pos.getAltitude() - ac->getPosition().getAltitude())});
+    for(const TrafficStore::Vehicle& vehicle : allAircraft)
+      aiSorted.append({&vehicle,
+                       pos.distanceMeterTo(vehicle.position),
+                       std::abs(pos.getAltitude() - vehicle.position.getAltitude())});
 
     std::sort(aiSorted.begin(), aiSorted.end(), [](const AiDistType& ai1,
                                                    const AiDistType& ai2) -> bool
@@ -106,10 +113,10 @@ void MapPainterAircraft::render(PaintContext *context)
     int num = aiSorted.size();
     for(const AiDistType& adt : aiSorted)
     {
-      const SimConnectAircraft& ac = *adt.aircraft;
+      const SimConnectAircraft& ac = *adt.vehicle->aircraft;
       if(mapfunc::aircraftVisible(ac, context->mapLayer))
       {
-        paintAiVehicle(context, ac,
+        paintAiVehicle(context, ac, adt.vehicle->position,
                        --num < NUM_CLOSEST_AI_LABELS &&
                        adt.distanceLateralMeter < DIST_METER_CLOSEST_AI_LABELS &&
                        adt.distanceVerticalFt < DIST_FT_CLOSEST_AI_LABELS);
@@ -22,6 +22,7 @@
 #include "mapgui/maplayer.h"
 #include "query/mapquery.h"
 #include "query/airportquery.h"
+#include "query/querytypes.h"
 #include "geo/calculations.h"
 #include "common/maptypes.h"
 #include "common/mapcolors.h"
@@ -51,6 +52,9 @@ static const int TAXIWAY_TEXT_MIN_LENGTH = 20;
 static const int RUNWAY_OVERVIEW_MIN_LENGTH_FEET = 8000;
 static const float AIRPORT_DIAGRAM_BACKGROUND_METER = 200.f;
 
+/* Inflation factor of the view rectangle for loading aprons in background */
+static const double APRON_PREFETCH_RECT_FACTOR = 1.;
+
 using namespace Marble;
 using namespace atools::geo;
 using namespace map;
@@ -79,6 +83,12 @@ void MapPainterAirport::render(PaintContext *context)
     }
   }
 
+  // Prepare X-Plane aprons in background if diagrams are shown at this or the next closer zoom step
+  if(context->objectTypes.testFlag(map::AIRPORT) && context->flags2 & opts::MAP_AIRPORT_DIAGRAM &&
+     NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11 &&
+     (context->mapLayerEffective->isAirportDiagram() || context->mapLayerZoomIn->isAirportDiagram()))
+    prefetchXplaneAprons(context);
+
   if((!context->objectTypes.testFlag(map::AIRPORT) || !context->mapLayer->isAirport()) &&
      (!context->mapLayerEffective->isAirportDiagramRunway()) && routeAirportIdMap.isEmpty())
     return;
@@ -262,13 +272,20 @@ void MapPainterAirport::drawFsApron(const PaintContext *context, const map::MapA
 void MapPainterAirport::drawXplaneApron(const PaintContext *context, const map::MapApron& apron, bool fast)
 {
   // Create the apron boundary or get it from the cache for this zoom distance
-  QPainterPath boundaryPath =
-    NavApp::getApronGeometryCache()->getApronGeometry(apron, context->zoomDistanceMeter, fast);
+  QPainterPath boundaryPath = NavApp::getApronGeometryCache()->getApronGeometry(apron, fast);
 
   if(!boundaryPath.isEmpty())
     context->painter->drawPath(boundaryPath);
 }
 
+/* Load and build X-Plane aprons in background for airports in and around the view */
+void MapPainterAirport::prefetchXplaneAprons(const PaintContext *context)
+{
+  GeoDataLatLonBox rect = context->viewport->viewLatLonAltBox();
+  query::inflateQueryRect(rect, APRON_PREFETCH_RECT_FACTOR, 0.);
+  NavApp::getApronGeometryCache()->prefetchApronGeometry(rect);
+}
+
 /* Draws the full airport diagram including runway, taxiways, apron, parking and more */
 void MapPainterAirport::drawAirportDiagram(const PaintContext *context, const map::MapAirport& airport)
 {
@@ -334,7 +351,7 @@ void MapPainterAirport::drawAirportDiagram(const PaintContext *context, const ma
 
         // X-Plane geometry
         if(!apron.geometry.boundary.isEmpty())
-          drawXplaneApron(context, apron, context->drawFast);
+          drawXplaneApron(context, apron, context->drawFast || !context->drawDetail);
       }
 
       // Draw taxiways ---------------------------------
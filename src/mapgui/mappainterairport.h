@@ -63,6 +63,7 @@ private:
                     QList<QRect> *innerRects, QList<QRect> *outlineRects, bool overview);
   void drawFsApron(const PaintContext *context, const map::MapApron& apron);
   void drawXplaneApron(const PaintContext *context, const map::MapApron& apron, bool fast);
+  void prefetchXplaneAprons(const PaintContext *context);
 
   const Route *route;
 
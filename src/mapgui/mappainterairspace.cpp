@@ -95,6 +95,7 @@ void MapPainterAirspace::render(PaintContext *context)
 
     painter->setBackgroundMode(Qt::TransparentMode);
 
+    QPolygonF polygon;
     for(const MapAirspace *airspace : airspaces)
     {
       if(!(airspace->type & context->airspaceFilterByLayer.types))
@@ -107,22 +108,53 @@ void MapPainterAirspace::render(PaintContext *context)
 
         // qDebug() << airspace.getId() << airspace.name;
 
-        Marble::GeoDataLinearRing linearRing;
-        linearRing.setTessellate(true);
-
         painter->setPen(mapcolors::penForAirspace(*airspace));
 
-        if(!context->drawFast)
+        if(!context->drawFast && context->drawDetail)
           painter->setBrush(mapcolors::colorForAirspaceFill(*airspace));
 
         const LineString *lines =
           (airspace->online ? airspaceQueryOnline : airspaceQuery)->getAirspaceGeometry(airspace->id);
 
-        for(const Pos& pos : *lines)
-          linearRing.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0, DEG));
+        if(buildScreenPolygon(context, *lines, polygon))
+          // Short segments only - draw directly
+          painter->drawPolygon(polygon);
+        else
+        {
+          Marble::GeoDataLinearRing linearRing;
+          linearRing.setTessellate(true);
+
+          for(const Pos& pos : *lines)
+            linearRing.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0, DEG));
 
-        painter->drawPolygon(linearRing);
+          painter->drawPolygon(linearRing);
+        }
       }
     }
   }
 }
+
+bool MapPainterAirspace::buildScreenPolygon(const PaintContext *context, const LineString& lines, QPolygonF& polygon)
+{
+  polygon.clear();
+  if(lines.size() < 3)
+    return false;
+
+  // Use a size of four times the screen for visibility to catch polygons extending far out of the screen
+  QSize size(context->viewport->width() * 4, context->viewport->height() * 4);
+  wToSBatchPos(lines, batch, size);
+
+  polygon.reserve(batch.size());
+  for(int i = 0; i < batch.size(); i++)
+  {
+    if(!batch.isVisible(i))
+      return false;
+
+    QPointF pt = batch.pointF(i);
+    if(!polygon.isEmpty() && QLineF(polygon.last(), pt).length() > MAX_SEGMENT_LENGTH_PIXEL)
+      return false;
+
+    polygon.append(pt);
+  }
+  return true;
+}
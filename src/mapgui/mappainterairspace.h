@@ -40,7 +40,16 @@ public:
   virtual void render(PaintContext *context) override;
 
 private:
+  /* Convert the airspace polygon in one batch. Returns false if the polygon has to be drawn by
+   * Marble which is needed for long segments (great circle tessellation), points hidden behind the globe
+   * or points far outside of the screen. */
+  bool buildScreenPolygon(const PaintContext *context, const atools::geo::LineString& lines, QPolygonF& polygon);
+
+  /* Maximum length of a polygon segment in pixel to allow drawing without tessellation */
+  static Q_DECL_CONSTEXPR double MAX_SEGMENT_LENGTH_PIXEL = 30.;
+
   const Route *route;
+  ScreenPointBatch batch;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERAIRSPACE_H
@@ -45,17 +45,80 @@ MapPainterAltitude::~MapPainterAltitude()
 {
 }
 
-void MapPainterAltitude::render(PaintContext *context)
+void MapPainterAltitude::clearCache()
+{
+  cells.clear();
+  cellsValid = false;
+}
+
+void MapPainterAltitude::updateCells(int west, int east, int south, int north)
 {
   using atools::fs::common::MoraReader;
 
+  if(cellsValid && west == cellsWest && east == cellsEast && south == cellsSouth && north == cellsNorth)
+    return;
+
+  cells.clear();
+  cellsWest = west;
+  cellsEast = east;
+  cellsSouth = south;
+  cellsNorth = north;
+  cellsValid = true;
+
+  // Split at anit-meridian if needed
+  QVector<std::pair<int, int> > ranges;
+  if(west <= east)
+    ranges.append(std::make_pair(west - 1, east));
+  else
+  {
+    ranges.append(std::make_pair(west - 1, 179));
+    ranges.append(std::make_pair(-180, east));
+  }
+
+  MoraReader *moraReader = NavApp::getMoraReader();
+  for(int laty = south; laty <= north + 1; laty++)
+  {
+    // Iterate over anti-meridian split
+    for(const std::pair<int, int>& range : ranges)
+    {
+      for(int lonx = range.first; lonx <= range.second; lonx++)
+      {
+        int moraFt100 = moraReader->getMoraFt(lonx, laty);
+        if(moraFt100 > 10 && moraFt100 != MoraReader::OCEAN && moraFt100 != MoraReader::UNKNOWN &&
+           moraFt100 != MoraReader::ERROR)
+        {
+          MoraCell cell;
+
+          // Build rectangle
+          cell.rect = Marble::GeoDataLineString(Marble::Tessellate | Marble::RespectLatitudeCircle);
+          cell.rect.append(GeoDataCoordinates(lonx, laty, 0, DEG));
+          cell.rect.append(GeoDataCoordinates(lonx + 1, laty, 0, DEG));
+          cell.rect.append(GeoDataCoordinates(lonx + 1, laty - 1, 0, DEG));
+          cell.rect.append(GeoDataCoordinates(lonx, laty - 1, 0, DEG));
+          cell.rect.append(GeoDataCoordinates(lonx, laty, 0, DEG));
+
+          cell.center = GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG);
+          cell.left = GeoDataCoordinates(lonx, laty - .5, 0, DEG);
+          cell.right = GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG);
+
+          // Big thousands and smaller hundreds numbers
+          cell.thousands = QString::number(moraFt100 / 10);
+          cell.hundreds = QString::number(moraFt100 - (moraFt100 / 10 * 10));
+          cells.append(cell);
+        }
+      } // for(int lonx = range.first; lonx <= range.second; lonx++)
+    } // for(const std::pair<int, int>& range : ranges)
+  } // for(int laty = south; laty <= north + 1; laty++)
+}
+
+void MapPainterAltitude::render(PaintContext *context)
+{
   if(!context->objectDisplayTypes.testFlag(map::MINIMUM_ALTITUDE))
     return;
 
   if(context->mapLayer->isMinimumAltitude())
   {
-    MoraReader *moraReader = NavApp::getMoraReader();
-    if(moraReader->isDataAvailable())
+    if(NavApp::getMoraReader()->isDataAvailable())
     {
       atools::util::PainterContextSaver paintContextSaver(context->painter);
 
@@ -63,67 +126,26 @@ void MapPainterAltitude::render(PaintContext *context)
 
       // Get covered one degree coordinate rectangles
       const GeoDataLatLonBox& curBox = context->viewport->viewLatLonAltBox();
-      int west = static_cast<int>(curBox.west(DEG));
-      int east = static_cast<int>(curBox.east(DEG));
-      int north = static_cast<int>(curBox.north(DEG));
-      int south = static_cast<int>(curBox.south(DEG));
-
-      // Split at anit-meridian if needed
-      QVector<std::pair<int, int> > ranges;
-      if(west <= east)
-        ranges.append(std::make_pair(west - 1, east));
-      else
-      {
-        ranges.append(std::make_pair(west - 1, 179));
-        ranges.append(std::make_pair(-180, east));
-      }
+      updateCells(static_cast<int>(curBox.west(DEG)), static_cast<int>(curBox.east(DEG)),
+                  static_cast<int>(curBox.south(DEG)), static_cast<int>(curBox.north(DEG)));
 
-      // Altitude values
-      QVector<int> altitudes;
       // Minimum rectangle width on screen in pixel
       float minWidth = std::numeric_limits<float>::max();
-      // Center points for rectangles for text placement
-      QVector<GeoDataCoordinates> centers;
 
-      // Draw rectangles and collect other values for text placement ================================
-      Marble::GeoDataLineString line(Marble::Tessellate | Marble::RespectLatitudeCircle);
-      for(int laty = south; laty <= north + 1; laty++)
+      // Draw rectangles and calculate minimum width for text placement ================================
+      for(const MoraCell& cell : cells)
       {
-        // Iterate over anti-meridian split
-        for(const std::pair<int, int>& range : ranges)
+        context->painter->drawPolyline(cell.rect);
+
+        if(!context->drawFast)
         {
-          for(int lonx = range.first; lonx <= range.second; lonx++)
-          {
-            int moraFt100 = moraReader->getMoraFt(lonx, laty);
-            if(moraFt100 > 10 && moraFt100 != MoraReader::OCEAN && moraFt100 != MoraReader::UNKNOWN &&
-               moraFt100 != MoraReader::ERROR)
-            {
-              // Build rectangle
-              line.clear();
-              line.append(GeoDataCoordinates(lonx, laty, 0, DEG));
-              line.append(GeoDataCoordinates(lonx + 1, laty, 0, DEG));
-              line.append(GeoDataCoordinates(lonx + 1, laty - 1, 0, DEG));
-              line.append(GeoDataCoordinates(lonx, laty - 1, 0, DEG));
-              line.append(GeoDataCoordinates(lonx, laty, 0, DEG));
-              context->painter->drawPolyline(line);
-
-              if(!context->drawFast)
-              {
-                // Calculate rectangle screen width
-                bool visibleDummy;
-                QPointF leftPt = wToSF(GeoDataCoordinates(lonx, laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
-                QPointF rightPt =
-                  wToSF(GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
-
-                minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
-
-                centers.append(GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG));
-                altitudes.append(moraFt100);
-              }
-            }
-          } // for(int lonx = range.first; lonx <= range.second; lonx++)
-        } // for(const std::pair<int, int>& range : ranges)
-      } // for(int laty = south; laty <= north + 1; laty++)
+          // Calculate rectangle screen width
+          bool visibleDummy;
+          QPointF leftPt = wToSF(cell.left, DEFAULT_WTOS_SIZE, &visibleDummy);
+          QPointF rightPt = wToSF(cell.right, DEFAULT_WTOS_SIZE, &visibleDummy);
+          minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
+        }
+      }
 
       // Draw texts =================================================================
       if(!context->drawFast && minWidth > 20.f)
@@ -136,40 +158,35 @@ void MapPainterAltitude::render(PaintContext *context)
         QFont font = context->painter->font();
         font.setItalic(true);
         font.setPixelSize(atools::roundToInt(minWidth));
-        context->painter->setFont(font);
-        QFontMetricsF fontmetrics = context->painter->fontMetrics();
+        QFont smallFont = font;
+        smallFont.setPixelSize(font.pixelSize() * 7 / 10);
+        QFontMetricsF fontmetrics(font), smallFontmetrics(smallFont);
 
         // Draw big thousands numbers ===============================
+        context->painter->setFont(font);
         bool visible, hidden;
-        QVector<double> xpos;
-        for(int i = 0; i < centers.size(); i++)
+        QVector<QPointF> smallPoints(cells.size());
+        for(int i = 0; i < cells.size(); i++)
         {
-          QString txt = QString::number(altitudes.at(i) / 10);
-          QPointF pt = wToSF(centers.at(i), DEFAULT_WTOS_SIZE, &visible, &hidden);
-
-          qreal w = fontmetrics.width(txt);
-          pt += QPointF(-w * 0.7, fontmetrics.height() / 2. - fontmetrics.descent());
-          xpos.append(pt.x() + w);
-          if(!hidden)
-            context->painter->drawText(pt, txt);
+          const MoraCell& cell = cells.at(i);
+          QPointF center = wToSF(cell.center, DEFAULT_WTOS_SIZE, &visible, &hidden);
+          if(hidden)
+            continue;
+
+          qreal w = fontmetrics.width(cell.thousands);
+          QPointF pt = center + QPointF(-w * 0.7, fontmetrics.height() / 2. - fontmetrics.descent());
+          context->painter->drawText(pt, cell.thousands);
+
+          // Smaller number goes right of the big one
+          smallPoints[i] = QPointF(pt.x() + w, center.y() + smallFontmetrics.height() - smallFontmetrics.descent());
         }
 
         // Draw smaller hundreds numbers ==============================
-        font.setPixelSize(font.pixelSize() * 7 / 10);
-        context->painter->setFont(font);
-        fontmetrics = context->painter->fontMetrics();
-
-        for(int i = 0; i < centers.size(); i++)
+        context->painter->setFont(smallFont);
+        for(int i = 0; i < cells.size(); i++)
         {
-          QString txt = QString::number(altitudes.at(i) / 10);
-          QPointF pt = wToSF(centers.at(i), DEFAULT_WTOS_SIZE, &visible, &hidden);
-
-          if(!hidden)
-          {
-            pt += QPointF(0., fontmetrics.height() - fontmetrics.descent());
-            pt.setX(xpos.at(i));
-            context->painter->drawText(pt, QString::number(altitudes.at(i) - (altitudes.at(i) / 10 * 10)));
-          }
+          if(!smallPoints.at(i).isNull())
+            context->painter->drawText(smallPoints.at(i), cells.at(i).hundreds);
         }
       } // if(!context->drawFast)
     } // if(moraReader->isDataAvailable())
@@ -20,10 +20,15 @@
 
 #include "mapgui/mappainter.h"
 
+#include <marble/GeoDataLineString.h>
+
 class SymbolPainter;
 
 /*
- * Draws MORA (minimum off route altitude) data and grid on the map
+ * Draws MORA (minimum off route altitude) data and grid on the map.
+ *
+ * Cell rectangles and formatted labels for the visible one degree grid are kept between frames and
+ * rebuilt only if the range of visible cells changes or new data is loaded.
  */
 class MapPainterAltitude :
   public MapPainter
@@ -34,6 +39,26 @@ public:
 
   virtual void render(PaintContext *context) override;
 
+  /* Drop cached cells. Call after loading a new database. */
+  void clearCache();
+
+private:
+  /* One grid cell with MORA value */
+  struct MoraCell
+  {
+    Marble::GeoDataLineString rect;
+    Marble::GeoDataCoordinates center, left, right; /* Center and middle of left and right border */
+    QString thousands, hundreds; /* Labels */
+  };
+
+  /* Fill cells for given range if it differs from the cached one */
+  void updateCells(int west, int east, int south, int north);
+
+  QVector<MoraCell> cells;
+
+  /* Cell range used to fill cells */
+  int cellsWest = 0, cellsEast = 0, cellsSouth = 0, cellsNorth = 0;
+  bool cellsValid = false;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERALTITUDE_H
@@ -281,17 +281,21 @@ void MapPainterNav::paintWaypoints(PaintContext *context, const QList<MapWaypoin
 
   bool fill = context->flags2 & opts::MAP_NAVAID_TEXT_BACKGROUND;
 
-  for(const MapWaypoint& waypoint : *waypoints)
+  // Convert all positions at once
+  wToSBatch(*waypoints, batch);
+
+  for(int i = 0; i < waypoints->size(); i++)
   {
+    const MapWaypoint& waypoint = waypoints->at(i);
+
     // If waypoints are off, airways are on and waypoint has no airways skip it
     if(!(drawWaypoint || (drawAirwayV && waypoint.hasVictorAirways) || (drawAirwayJ && waypoint.hasJetAirways)))
       continue;
 
-    int x, y;
-    bool visible = wToS(waypoint.position, x, y);
-
-    if(visible)
+    if(batch.isVisible(i))
     {
+      int x = batch.xInt(i), y = batch.yInt(i);
+
       if(context->objCount())
         return;
 
@@ -311,13 +315,15 @@ void MapPainterNav::paintVors(PaintContext *context, const QList<MapVor> *vors,
 {
   bool fill = context->flags2 & opts::MAP_NAVAID_TEXT_BACKGROUND;
 
-  for(const MapVor& vor : *vors)
-  {
-    int x, y;
-    bool visible = wToS(vor.position, x, y);
+  wToSBatch(*vors, batch);
 
-    if(visible)
+  for(int i = 0; i < vors->size(); i++)
+  {
+    if(batch.isVisible(i))
     {
+      const MapVor& vor = vors->at(i);
+      int x = batch.xInt(i), y = batch.yInt(i);
+
       if(context->objCount())
         return;
 
@@ -342,13 +348,15 @@ void MapPainterNav::paintNdbs(PaintContext *context, const QList<MapNdb> *ndbs,
 {
   bool fill = context->flags2 & opts::MAP_NAVAID_TEXT_BACKGROUND;
 
-  for(const MapNdb& ndb : *ndbs)
-  {
-    int x, y;
-    bool visible = wToS(ndb.position, x, y);
+  wToSBatch(*ndbs, batch);
 
-    if(visible)
+  for(int i = 0; i < ndbs->size(); i++)
+  {
+    if(batch.isVisible(i))
     {
+      const MapNdb& ndb = ndbs->at(i);
+      int x = batch.xInt(i), y = batch.yInt(i);
+
       if(context->objCount())
         return;
 
@@ -371,13 +379,15 @@ void MapPainterNav::paintMarkers(PaintContext *context, const QList<MapMarker> *
 {
   int transparency = context->flags2 & opts::MAP_NAVAID_TEXT_BACKGROUND ? 255 : 0;
 
-  for(const MapMarker& marker : *markers)
-  {
-    int x, y;
-    bool visible = wToS(marker.position, x, y);
+  wToSBatch(*markers, batch);
 
-    if(visible)
+  for(int i = 0; i < markers->size(); i++)
+  {
+    if(batch.isVisible(i))
     {
+      const MapMarker& marker = markers->at(i);
+      int x = batch.xInt(i), y = batch.yInt(i);
+
       if(context->objCount())
         return;
 
@@ -45,6 +45,9 @@ private:
   void paintWaypoints(PaintContext *context, const QList<map::MapWaypoint> *waypoints, bool drawWaypoint);
   void paintAirways(PaintContext *context, const QList<map::MapAirway> *airways, bool fast);
 
+  /* Screen coordinates for all navaids of one type. Kept to avoid reallocation on each frame. */
+  ScreenPointBatch batch;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERAIRPORT_H
@@ -31,6 +31,7 @@
 #include <QBitArray>
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using namespace Marble;
 using namespace atools::geo;
@@ -46,7 +47,7 @@ MapPainterRoute::MapPainterRoute(MapWidget *mapWidget, MapScale *mapScale, const
 
 MapPainterRoute::~MapPainterRoute()
 {
-
+  delete routeCache.textPlacement;
 }
 
 void MapPainterRoute::render(PaintContext *context)
@@ -79,10 +80,6 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
   if(context->mapLayer->isRouteTextAndDetail())
     drawStartParking(context);
 
-  // Collect line text and geometry from the route
-  QStringList routeTexts;
-  QVector<Line> lines;
-
   float outerlinewidth = context->sz(context->thicknessFlightplan, 7);
   float innerlinewidth = context->sz(context->thicknessFlightplan, 4);
 
@@ -101,35 +98,12 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
 
   int passedRouteLeg = context->flags2 & opts::MAP_ROUTE_DIM_PASSED ? activeRouteLeg : 0;
 
-  // Collect route only coordinates and texts ===============================
-  for(int i = 1; i < route->size(); i++)
-  {
-    const RouteLeg& leg = route->at(i);
-    const RouteLeg& last = route->at(i - 1);
-
-    // Draw if at least one is part of the route - also draw empty spaces between procedures
-    if(
-      last.isRoute() || leg.isRoute() || // Draw if any is route - also covers STAR to airport
-      (last.getProcedureLeg().isAnyDeparture() && leg.getProcedureLeg().isAnyArrival()) || // empty space from SID to STAR, transition or approach
-      (last.getProcedureLeg().isStar() && leg.getProcedureLeg().isArrival()) // empty space from STAR to transition or approach
-      )
-    {
-      if(i >= passedRouteLeg || context->distance > layer::DISTANCE_CUT_OFF_LIMIT)
-        routeTexts.append(Unit::distNm(leg.getDistanceTo(), true /*addUnit*/, 20, true /*narrow*/) + tr(" / ") +
-                          QString::number(leg.getCourseToRhumbMag(), 'f', 0) + tr("°M"));
-      else
-        // No texts for passed legs
-        routeTexts.append(QString());
+  // Font is needed for text placement in the cache
+  context->szFont(context->textSizeFlightplan * 1.1f);
 
-      lines.append(Line(last.getPosition(), leg.getPosition()));
-    }
-    else
-    {
-      // Text and lines are drawn by paintProcedure
-      routeTexts.append(QString());
-      lines.append(Line());
-    }
-  }
+  // Collect line text, geometry and text placement or reuse the ones from last paint event
+  updateRouteCache(context, activeRouteLeg, passedRouteLeg, outerlinewidth);
+  const QVector<Line>& lines = routeCache.lines;
 
   QPainter *painter = context->painter;
 
@@ -138,19 +112,8 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
   painter->setBrush(Qt::NoBrush);
 
   // Draw route lines ==========================================================================
-  if(!lines.isEmpty()) // Do not draw a line from airport to runway end
+  if(!lines.isEmpty())
   {
-    if(route->hasAnyArrivalProcedure())
-    {
-      lines.last() = Line();
-      routeTexts.last().clear();
-    }
-    if(route->hasAnyDepartureProcedure())
-    {
-      lines.first() = Line();
-      routeTexts.first().clear();
-    }
-
     const OptionData& od = OptionData::instance();
     QPen routePen(od.getFlightplanColor(), innerlinewidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
     QPen routeOutlinePen(mapcolors::routeOutlineColor, outerlinewidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
@@ -162,43 +125,35 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
       // Draw gray line for passed legs
       painter->setPen(routePassedPen);
       for(int i = 0; i < passedRouteLeg; i++)
-        drawLine(context, lines.at(i));
+        drawRouteLine(context, i);
 
       // Draw background for legs ahead
       painter->setPen(routeOutlinePen);
       for(int i = passedRouteLeg; i < lines.size(); i++)
-        drawLine(context, lines.at(i));
+        drawRouteLine(context, i);
 
       // Draw center line for legs ahead
       painter->setPen(routePen);
       for(int i = passedRouteLeg; i < lines.size(); i++)
-        drawLine(context, lines.at(i));
+        drawRouteLine(context, i);
     }
 
     if(activeValid)
     {
       // Draw active leg on top of all others to keep it visible ===========================
       painter->setPen(routeOutlinePen);
-      drawLine(context, lines.at(activeRouteLeg - 1));
+      drawRouteLine(context, activeRouteLeg - 1);
 
       painter->setPen(QPen(OptionData::instance().getFlightplanActiveSegmentColor(), innerlinewidth,
                            Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-      drawLine(context, lines.at(activeRouteLeg - 1));
+      drawRouteLine(context, activeRouteLeg - 1);
     }
   }
-  context->szFont(context->textSizeFlightplan * 1.1f);
 
-  // Collect coordinates for text placement and lines first ============================
-  LineString positions;
-  for(int i = 0; i < route->size(); i++)
-    positions.append(route->at(i).getPosition());
+  TextPlacement& textPlacement = *routeCache.textPlacement;
+  textPlacement.setPainter(painter);
 
-  TextPlacement textPlacement(painter, this);
-  textPlacement.setDrawFast(context->drawFast);
-  textPlacement.setLineWidth(outerlinewidth);
-  textPlacement.calculateTextPositions(positions);
-  textPlacement.calculateTextAlongLines(lines, routeTexts);
   painter->save();
   if(!(context->flags2 & opts::MAP_ROUTE_TEXT_BACKGROUND))
     painter->setBackgroundMode(Qt::TransparentMode);
@@ -283,6 +238,172 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
 
 }
 
+void MapPainterRoute::routeChanged()
+{
+  routeRevision++;
+}
+
+bool MapPainterRoute::RouteCacheKey::operator==(const RouteCacheKey& other) const
+{
+  return routeRevision == other.routeRevision && activeRouteLeg == other.activeRouteLeg &&
+         passedRouteLeg == other.passedRouteLeg && projection == other.projection && radius == other.radius &&
+         centerLon == other.centerLon && centerLat == other.centerLat &&
+         size == other.size && drawFast == other.drawFast && textAndDetail == other.textAndDetail &&
+         cutOff == other.cutOff && textSize == other.textSize &&
+         thickness == other.thickness && fontPixelSize == other.fontPixelSize;
+}
+
+void MapPainterRoute::updateRouteCache(const PaintContext *context, int activeRouteLeg, int passedRouteLeg,
+                                       float outerlinewidth)
+{
+  const ViewportParams *viewport = context->viewport;
+  QPainter *painter = context->painter;
+
+  RouteCacheKey key;
+  key.routeRevision = routeRevision;
+  key.activeRouteLeg = activeRouteLeg;
+  key.passedRouteLeg = passedRouteLeg;
+  key.projection = viewport->projection();
+  key.radius = viewport->radius();
+  key.centerLon = viewport->centerLongitude();
+  key.centerLat = viewport->centerLatitude();
+  key.size = viewport->size();
+  key.drawFast = context->drawFast;
+  key.textAndDetail = context->mapLayer->isRouteTextAndDetail();
+  key.cutOff = context->distance > layer::DISTANCE_CUT_OFF_LIMIT;
+  key.textSize = context->textSizeFlightplan;
+  key.thickness = context->thicknessFlightplan;
+  key.fontPixelSize = painter->fontInfo().pixelSize();
+
+  if(routeCache.textPlacement != nullptr && routeCache.key == key)
+    // Nothing changed - reuse
+    return;
+
+  routeCache.key = key;
+  routeCache.lines.clear();
+  routeCache.routeTexts.clear();
+  routeCache.polylines.clear();
+
+  QStringList& routeTexts = routeCache.routeTexts;
+  QVector<Line>& lines = routeCache.lines;
+
+  // Collect route only coordinates and texts ===============================
+  for(int i = 1; i < route->size(); i++)
+  {
+    const RouteLeg& leg = route->at(i);
+    const RouteLeg& last = route->at(i - 1);
+
+    // Draw if at least one is part of the route - also draw empty spaces between procedures
+    if(
+      last.isRoute() || leg.isRoute() || // Draw if any is route - also covers STAR to airport
+      (last.getProcedureLeg().isAnyDeparture() && leg.getProcedureLeg().isAnyArrival()) || // empty space from SID to STAR, transition or approach
+      (last.getProcedureLeg().isStar() && leg.getProcedureLeg().isArrival()) // empty space from STAR to transition or approach
+      )
+    {
+      if(i >= passedRouteLeg || context->distance > layer::DISTANCE_CUT_OFF_LIMIT)
+        routeTexts.append(Unit::distNm(leg.getDistanceTo(), true /*addUnit*/, 20, true /*narrow*/) + tr(" / ") +
+                          QString::number(leg.getCourseToRhumbMag(), 'f', 0) + tr("°M"));
+      else
+        // No texts for passed legs
+        routeTexts.append(QString());
+
+      lines.append(Line(last.getPosition(), leg.getPosition()));
+    }
+    else
+    {
+      // Text and lines are drawn by paintProcedure
+      routeTexts.append(QString());
+      lines.append(Line());
+    }
+  }
+
+  if(!lines.isEmpty()) // Do not draw a line from airport to runway end
+  {
+    if(route->hasAnyArrivalProcedure())
+    {
+      lines.last() = Line();
+      routeTexts.last().clear();
+    }
+    if(route->hasAnyDepartureProcedure())
+    {
+      lines.first() = Line();
+      routeTexts.first().clear();
+    }
+  }
+
+  // Convert lines to screen coordinates ==========================================================================
+  for(const Line& line : lines)
+    routeCache.polylines.append(projectRouteLine(context, line));
+
+  // Collect coordinates for text placement and lines first ============================
+  LineString positions;
+  for(int i = 0; i < route->size(); i++)
+    positions.append(route->at(i).getPosition());
+
+  delete routeCache.textPlacement;
+  routeCache.textPlacement = new TextPlacement(painter, this);
+  routeCache.textPlacement->setDrawFast(context->drawFast);
+  routeCache.textPlacement->setLineWidth(outerlinewidth);
+  routeCache.textPlacement->calculateTextPositions(positions);
+  routeCache.textPlacement->calculateTextAlongLines(lines, routeTexts);
+}
+
+void MapPainterRoute::drawRouteLine(const PaintContext *context, int index)
+{
+  const QPolygonF& polyline = routeCache.polylines.at(index);
+  if(!polyline.isEmpty())
+    context->painter->drawPolyline(polyline);
+  else
+    // Use Marble to draw long or partially hidden lines
+    drawLine(context, routeCache.lines.at(index));
+}
+
+QPolygonF MapPainterRoute::projectRouteLine(const PaintContext *context, const Line& line)
+{
+  if(!line.isValid())
+    return QPolygonF();
+
+  float distanceMeter = line.getPos1().distanceMeterTo(line.getPos2());
+  if(distanceMeter < 1.f)
+    return QPolygonF();
+
+  // Get number of points for the great circle line from the screen distance of the endpoints
+  QLineF screenLine;
+  bool hidden = false;
+  wToS(line, screenLine, DEFAULT_WTOS_SIZE, &hidden);
+  if(hidden)
+    return QPolygonF();
+
+  int numPoints = std::min(std::max(static_cast<int>(screenLine.length() / ROUTE_LINE_SEGMENT_PIXEL) + 1, 2),
+                           ROUTE_LINE_MAX_POINTS);
+
+  LineString positions;
+  for(int i = 0; i < numPoints; i++)
+    positions.append(line.getPos1().interpolate(line.getPos2(), distanceMeter,
+                                                static_cast<float>(i) / static_cast<float>(numPoints - 1)));
+
+  // Allow points outside of the screen but avoid the ones which are hidden or far away
+  const ViewportParams *viewport = context->viewport;
+  wToSBatchPos(positions, batch, QSize(viewport->width() * 4, viewport->height() * 4));
+
+  // Jumps across the anti-meridian in Mercator projection have to be drawn by Marble
+  double maxSegmentLength = std::max(viewport->width(), viewport->height()) / 2.;
+
+  QPolygonF polyline;
+  for(int i = 0; i < batch.size(); i++)
+  {
+    if(!batch.isVisible(i))
+      return QPolygonF();
+
+    QPointF pt = batch.pointF(i);
+    if(!polyline.isEmpty() && QLineF(polyline.last(), pt).length() > maxSegmentLength)
+      return QPolygonF();
+
+    polyline.append(pt);
+  }
+  return polyline;
+}
+
 void MapPainterRoute::paintTopOfDescentAndClimb(const PaintContext *context)
 {
   if(route->size() >= 2)
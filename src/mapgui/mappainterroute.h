@@ -22,11 +22,14 @@
 
 #include "geo/line.h"
 
+#include <QPolygonF>
+
 namespace Marble {
 class GeoDataLineString;
 }
 
 class MapWidget;
+class TextPlacement;
 class RouteController;
 class Route;
 
@@ -63,7 +66,50 @@ public:
 
   virtual void render(PaintContext *context) override;
 
+  /* Invalidates the cached route screen geometry. Called when the flight plan or options change. */
+  void routeChanged();
+
 private:
+  /* All values the cached route geometry depends on. Cache is rebuilt if any of these changes. */
+  struct RouteCacheKey
+  {
+    int routeRevision = -1, activeRouteLeg = -1, passedRouteLeg = -1;
+
+    /* Viewport */
+    int projection = -1, radius = 0;
+    double centerLon = 0., centerLat = 0.;
+    QSize size;
+
+    /* Display */
+    bool drawFast = false, textAndDetail = false, cutOff = false;
+    float textSize = 0.f, thickness = 0.f;
+    int fontPixelSize = 0;
+
+    bool operator==(const RouteCacheKey& other) const;
+
+    bool operator!=(const RouteCacheKey& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  /* Projected flight plan lines and text placement which are reused between frames */
+  struct RouteCache
+  {
+    RouteCacheKey key;
+
+    QVector<atools::geo::Line> lines;
+    QStringList routeTexts;
+
+    /* Screen lines for each of "lines". Empty if the line has to be drawn by Marble */
+    QVector<QPolygonF> polylines;
+
+    /* Contains text positions and start points */
+    TextPlacement *textPlacement = nullptr;
+  };
+
+
   struct DrawText
   {
     /* Line for text placement */
@@ -119,7 +165,25 @@ private:
 
   void drawStartParking(const PaintContext *context);
 
+  /* Build key for current state and recalculate cache if changed */
+  void updateRouteCache(const PaintContext *context, int activeRouteLeg, int passedRouteLeg, float outerlinewidth);
+
+  /* Draw line from cache or fall back to Marble drawing */
+  void drawRouteLine(const PaintContext *context, int index);
+
+  /* Tessellate great circle line and convert to screen. Returns empty polygon if Marble has to do the drawing. */
+  QPolygonF projectRouteLine(const PaintContext *context, const atools::geo::Line& line);
+
+  /* Pixel length of one great circle line piece */
+  static Q_DECL_CONSTEXPR float ROUTE_LINE_SEGMENT_PIXEL = 10.f;
+  static Q_DECL_CONSTEXPR int ROUTE_LINE_MAX_POINTS = 256;
+
   const Route *route;
+
+  /* Incremented on each route change */
+  int routeRevision = 0;
+  RouteCache routeCache;
+  ScreenPointBatch batch;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERROUTE_H
@@ -20,9 +20,11 @@
 #include "navapp.h"
 #include "mapgui/mapwidget.h"
 #include "mapgui/maplayer.h"
+#include "mapgui/trafficstore.h"
 #include "util/paintercontextsaver.h"
 
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using atools::fs::sc::SimConnectAircraft;
 
@@ -50,11 +52,16 @@ void MapPainterShip::render(PaintContext *context)
       atools::util::PainterContextSaver saver(context->painter);
       Q_UNUSED(saver);
 
-      for(const SimConnectAircraft& ac : mapWidget->getAiAircraft())
+      // Get only ships in view with interpolated positions
+      QVector<TrafficStore::Vehicle> vehicles;
+      mapWidget->getTraffic().getVehicles(vehicles, context->viewport->viewLatLonAltBox());
+
+      for(const TrafficStore::Vehicle& vehicle : vehicles)
       {
+        const SimConnectAircraft& ac = *vehicle.aircraft;
         if(ac.getCategory() == atools::fs::sc::BOAT &&
            (ac.getModelRadiusCorrected() * 2 > layer::LARGE_SHIP_SIZE || context->mapLayer->isAiShipSmall()))
-          paintAiVehicle(context, ac, false /* force label */);
+          paintAiVehicle(context, ac, vehicle.position, false /* force label */);
       }
     }
   }
@@ -0,0 +1,163 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mappainterterrain.h"
+
+#include "mapgui/terraintilecache.h"
+#include "mapgui/mapwidget.h"
+#include "mapgui/mapupdatescheduler.h"
+#include "common/elevationprovider.h"
+#include "util/paintercontextsaver.h"
+#include "navapp.h"
+
+#include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
+
+#include <cmath>
+
+using namespace Marble;
+using namespace atools::geo;
+
+MapPainterTerrain::MapPainterTerrain(MapWidget *mapWidget, MapScale *mapScale)
+  : MapPainter(mapWidget, mapScale)
+{
+  // Repaint map when new tiles are available
+  tileCache = new TerrainTileCache([mapWidget]()
+  {
+    mapWidget->getUpdateScheduler()->requestFullUpdate();
+  });
+}
+
+MapPainterTerrain::~MapPainterTerrain()
+{
+  delete tileCache;
+}
+
+void MapPainterTerrain::clearCache()
+{
+  tileCache->clear();
+}
+
+void MapPainterTerrain::render(PaintContext *context)
+{
+  if(!context->objectDisplayTypes.testFlag(map::TERRAIN_SHADING) ||
+     !NavApp::getElevationProvider()->isMappedGlobeProvider())
+    return;
+
+  atools::util::PainterContextSaver saver(context->painter);
+  Q_UNUSED(saver);
+
+  // Find zoom level where one tile pixel covers about one screen pixel
+  double pixelPerDegree = context->viewport->radius() * M_PI / 180.;
+  int zoom = 0;
+  while(zoom < TerrainTileCache::MAX_ZOOM &&
+        TerrainTileCache::TILE_SIZE / TerrainTileCache::tileDegree(zoom) < pixelPerDegree)
+    zoom++;
+
+  const GeoDataLatLonBox& box = context->viewport->viewLatLonAltBox();
+  double west = box.west(DEG), east = box.east(DEG), north = box.north(DEG), south = box.south(DEG);
+  if(east < west)
+    // Crosses the anti-meridian
+    east += 360.;
+
+  // Get range of visible tiles and reduce zoom if too many
+  int x0, x1, y0, y1;
+  while(true)
+  {
+    double degree = TerrainTileCache::tileDegree(zoom);
+    x0 = static_cast<int>(std::floor((west + 180.) / degree));
+    x1 = static_cast<int>(std::floor((east + 180.) / degree));
+    y0 = std::max(static_cast<int>(std::floor((90. - north) / degree)), 0);
+    y1 = std::min(static_cast<int>(std::floor((90. - south) / degree)), TerrainTileCache::numRows(zoom) - 1);
+
+    if(zoom == 0 || (x1 - x0 + 1) * (y1 - y0 + 1) <= MAX_VISIBLE_TILES)
+      break;
+    zoom--;
+  }
+
+  int columns = TerrainTileCache::numColumns(zoom);
+  for(int y = y0; y <= y1; y++)
+  {
+    for(int x = x0; x <= std::min(x1, x0 + columns - 1); x++)
+      drawTile(context, zoom, (x % columns + columns) % columns, y);
+  }
+}
+
+void MapPainterTerrain::drawTile(PaintContext *context, int zoom, int x, int y)
+{
+  const int size = TerrainTileCache::TILE_SIZE;
+  QRectF source(0., 0., size, size);
+  const QImage *image = tileCache->getTile(zoom, x, y);
+
+  // Use part of a lower zoom tile until this one is calculated
+  for(int parentZoom = zoom - 1; image == nullptr && parentZoom >= 0; parentZoom--)
+  {
+    int shift = zoom - parentZoom;
+    int parentX = x >> shift, parentY = y >> shift;
+    image = tileCache->getCachedTile(parentZoom, parentX, parentY);
+    if(image != nullptr)
+    {
+      double partSize = static_cast<double>(size) / (1 << shift);
+      source = QRectF((x - (parentX << shift)) * partSize, (y - (parentY << shift)) * partSize, partSize, partSize);
+    }
+  }
+
+  if(image == nullptr)
+    return;
+
+  // Project corners of all parts
+  double degree = TerrainTileCache::tileDegree(zoom);
+  double west = -180. + x * degree, north = 90. - y * degree;
+  QPointF points[SUBDIVISIONS + 1][SUBDIVISIONS + 1];
+  bool hidden[SUBDIVISIONS + 1][SUBDIVISIONS + 1];
+  for(int row = 0; row <= SUBDIVISIONS; row++)
+  {
+    for(int col = 0; col <= SUBDIVISIONS; col++)
+    {
+      double px, py;
+      wToS(Pos(west + col * degree / SUBDIVISIONS, north - row * degree / SUBDIVISIONS), px, py,
+           DEFAULT_WTOS_SIZE, &hidden[row][col]);
+      points[row][col] = QPointF(px, py);
+    }
+  }
+
+  QPainter *painter = context->painter;
+  QRectF screenRect(painter->viewport());
+  double partWidth = source.width() / SUBDIVISIONS, partHeight = source.height() / SUBDIVISIONS;
+  for(int row = 0; row < SUBDIVISIONS; row++)
+  {
+    for(int col = 0; col < SUBDIVISIONS; col++)
+    {
+      if(hidden[row][col] || hidden[row][col + 1] || hidden[row + 1][col] || hidden[row + 1][col + 1])
+        continue;
+
+      QPolygonF quad({points[row][col], points[row][col + 1], points[row + 1][col + 1], points[row + 1][col]});
+      if(!quad.boundingRect().intersects(screenRect))
+        continue;
+
+      // Map unit square to the projected part
+      QTransform transform;
+      if(QTransform::squareToQuad(quad, transform))
+      {
+        painter->setTransform(transform);
+        painter->drawImage(QRectF(0., 0., 1., 1.), *image,
+                           QRectF(source.x() + col * partWidth, source.y() + row * partHeight, partWidth, partHeight));
+      }
+    }
+  }
+  painter->resetTransform();
+}
@@ -0,0 +1,55 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_MAPPAINTERTERRAIN_H
+#define LITTLENAVMAP_MAPPAINTERTERRAIN_H
+
+#include "mapgui/mappainter.h"
+
+class TerrainTileCache;
+
+/*
+ * Draws terrain shading tiles calculated from the offline GLOBE elevation data below all other map objects.
+ *
+ * Tiles which are not available yet are replaced by parts of cached lower zoom tiles until calculated.
+ */
+class MapPainterTerrain :
+  public MapPainter
+{
+public:
+  MapPainterTerrain(MapWidget *mapWidget, MapScale *mapScale);
+  virtual ~MapPainterTerrain() override;
+
+  virtual void render(PaintContext *context) override;
+
+  /* Drop all cached tiles after the elevation data or options have changed */
+  void clearCache();
+
+private:
+  /* Draw a tile or a part of a lower zoom replacement */
+  void drawTile(PaintContext *context, int zoom, int x, int y);
+
+  TerrainTileCache *tileCache = nullptr;
+
+  /* Tiles are drawn in parts of SUBDIVISIONS x SUBDIVISIONS to follow the projection */
+  static Q_DECL_CONSTEXPR int SUBDIVISIONS = 4;
+
+  /* Use a lower zoom level if more tiles are visible */
+  static Q_DECL_CONSTEXPR int MAX_VISIBLE_TILES = 48;
+};
+
+#endif // LITTLENAVMAP_MAPPAINTERTERRAIN_H
@@ -31,6 +31,8 @@
 
 #include <marble/GeoPainter.h>
 
+#include <QFontMetricsF>
+
 using namespace Marble;
 using namespace atools::geo;
 using namespace map;
@@ -49,13 +51,12 @@ MapPainterVehicle::~MapPainterVehicle()
 
 }
 
-void MapPainterVehicle::paintAiVehicle(const PaintContext *context, const SimConnectAircraft& vehicle, bool forceLabel)
+void MapPainterVehicle::paintAiVehicle(const PaintContext *context, const SimConnectAircraft& vehicle,
+                                       const Pos& pos, bool forceLabel)
 {
   if(vehicle.isUser())
     return;
 
-  const Pos& pos = vehicle.getPosition();
-
   if(!pos.isValid())
     return;
 
@@ -106,6 +107,9 @@ void MapPainterVehicle::paintUserAircraft(const PaintContext *context,
   context->szFont(context->textSizeAircraftUser);
   int offset = -(size / 2);
 
+  // Rotated symbol or track line
+  int radius = size;
+
   if(context->dOpt(opts::ITEM_USER_AIRCRAFT_TRACK_LINE) &&
      userAircraft.getGroundSpeedKts() > 30 &&
      userAircraft.getTrackDegTrue() < atools::fs::sc::SC_INVALID_FLOAT)
@@ -115,7 +119,10 @@ void MapPainterVehicle::paintUserAircraft(const PaintContext *context,
                                             userAircraft.getPosition(), context->zoomDistanceMeter);
 
     if(rotate < map::INVALID_COURSE_VALUE)
+    {
       symbolPainter->drawTrackLine(context->painter, x, y, size * 2, rotate);
+      radius = size * 2;
+    }
   }
 
   // Position is visible
@@ -131,6 +138,9 @@ void MapPainterVehicle::paintUserAircraft(const PaintContext *context,
     context->painter->drawPixmap(offset, offset, *NavApp::getVehicleIcons()->pixmapFromCache(userAircraft, size, 0));
     context->painter->resetTransform();
 
+    userAircraftPoint = QPoint(static_cast<int>(x), static_cast<int>(y));
+    userAircraftRect = QRect(userAircraftPoint.x() - radius, userAircraftPoint.y() - radius, radius * 2, radius * 2);
+
     // Build text label
     paintTextLabelUser(context, x, y, size, userAircraft);
   }
@@ -166,11 +176,26 @@ void MapPainterVehicle::paintTrack(const PaintContext *context)
     int x2 = -1, y2 = -1;
     bool hidden1, hidden2;
     QRect vpRect(painter->viewport());
-    wToS(aircraftTrack.first().pos, x1, y1, DEFAULT_WTOS_SIZE, &hidden1);
 
-    for(int i = 1; i < aircraftTrack.size(); i++)
+    // Use a simplified track having positions about two pixels apart - full track if zoomed in close
+    float pixelPerMeter = scale->getPixelForMeter(1.f);
+    const QVector<qint64> *simplified =
+      pixelPerMeter > 0.f ? aircraftTrack.getSimplifiedTrack(2.f / pixelPerMeter) : nullptr;
+    int numPoints = simplified != nullptr ? simplified->size() + 1 : aircraftTrack.size();
+
+    auto trackPosAt = [&aircraftTrack, simplified](int i) -> const Pos& {
+      if(simplified == nullptr)
+        return aircraftTrack.at(i).pos;
+      else
+        // Always end at the latest position
+        return i < simplified->size() ? aircraftTrack.atSequence(simplified->at(i)).pos : aircraftTrack.last().pos;
+    };
+
+    wToS(trackPosAt(0), x1, y1, DEFAULT_WTOS_SIZE, &hidden1);
+
+    for(int i = 1; i < numPoints; i++)
     {
-      const Pos& trackPos = aircraftTrack.at(i).pos;
+      const Pos& trackPos = trackPosAt(i);
       wToS(trackPos, x2, y2, DEFAULT_WTOS_SIZE, &hidden2);
 
       QRect rect(QPoint(x1, y1), QPoint(x2, y2));
@@ -317,6 +342,7 @@ void MapPainterVehicle::paintTextLabelUser(const PaintContext *context, float x,
 
   // Draw text label
   symbolPainter->textBoxF(context->painter, texts, QPen(Qt::black), x + size / 2.f, y + size / 2.f, atts, 255);
+  userAircraftRect = userAircraftRect.united(textBoxRect(context->painter, texts, x + size / 2.f, y + size / 2.f));
 }
 
 void MapPainterVehicle::climbSinkPointer(QString& upDown, const SimConnectAircraft& aircraft)
@@ -395,6 +421,7 @@ void MapPainterVehicle::paintWindPointer(const PaintContext *context,
   if(aircraft.getWindDirectionDegT() < atools::fs::sc::SC_INVALID_FLOAT)
   {
     symbolPainter->drawWindPointer(context->painter, x, y, WIND_POINTER_SIZE, aircraft.getWindDirectionDegT());
+    windPointerRect = QRect(x - WIND_POINTER_SIZE, y - WIND_POINTER_SIZE, WIND_POINTER_SIZE * 2, WIND_POINTER_SIZE * 2);
     context->szFont(1.f);
     paintTextLabelWind(context, x, y, WIND_POINTER_SIZE, aircraft);
   }
@@ -421,5 +448,24 @@ void MapPainterVehicle::paintTextLabelWind(const PaintContext *context, int x, i
 
     // Draw text label
     symbolPainter->textBoxF(context->painter, texts, QPen(Qt::black), x + size / 2, y + size / 2, atts, 255);
+    windPointerRect = windPointerRect.united(textBoxRect(context->painter, texts, x + size / 2, y + size / 2));
   }
 }
+
+QRect MapPainterVehicle::textBoxRect(const QPainter *painter, const QStringList& texts, float x, float y)
+{
+  if(texts.isEmpty())
+    return QRect();
+
+  // Labels are drawn bold and centered vertically
+  QFont font = painter->font();
+  font.setBold(true);
+  QFontMetricsF metrics(font);
+
+  qreal width = 0.;
+  for(const QString& text : texts)
+    width = std::max(width, metrics.width(text));
+  qreal height = texts.size() * metrics.height();
+
+  return QRectF(x, y - height / 2., width, height).marginsAdded(QMarginsF(4., 4., 4., 4.)).toAlignedRect();
+}
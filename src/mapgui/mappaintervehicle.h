@@ -53,13 +53,33 @@ public:
 
   virtual void render(PaintContext *context) = 0;
 
+  /* Screen area covered by the user aircraft including track line and label in the last rendering.
+   * Empty if not drawn. */
+  const QRect& getUserAircraftRect() const
+  {
+    return userAircraftRect;
+  }
+
+  /* Screen position of the user aircraft in the last rendering */
+  const QPoint& getUserAircraftPoint() const
+  {
+    return userAircraftPoint;
+  }
+
+  /* Screen area covered by wind pointer and label. Empty if not drawn. */
+  const QRect& getWindPointerRect() const
+  {
+    return windPointerRect;
+  }
+
 protected:
   void paintTrack(const PaintContext *context);
 
   void paintUserAircraft(const PaintContext *context,
                          const atools::fs::sc::SimConnectUserAircraft& userAircraft, float x, float y);
-  void paintAiVehicle(const PaintContext *context,
-                      const atools::fs::sc::SimConnectAircraft& vehicle, bool forceLabel);
+  /* Position can differ from the vehicle position if interpolated */
+  void paintAiVehicle(const PaintContext *context, const atools::fs::sc::SimConnectAircraft& vehicle,
+                      const atools::geo::Pos& pos, bool forceLabel);
 
   void paintTextLabelUser(const PaintContext *context, float x, float y, int size,
                           const atools::fs::sc::SimConnectUserAircraft& aircraft);
@@ -77,6 +97,9 @@ protected:
   void paintTextLabelWind(const PaintContext *context, int x, int y, int size,
                           const atools::fs::sc::SimConnectUserAircraft& aircraft);
 
+  /* Approximate area covered by a text box drawn by SymbolPainter::textBoxF() */
+  static QRect textBoxRect(const QPainter *painter, const QStringList& texts, float x, float y);
+
   /* Calculate rotation for aircraft icon */
   float calcRotation(const PaintContext *context, const atools::fs::sc::SimConnectAircraft& aircraft);
 
@@ -85,6 +108,9 @@ protected:
 
   static Q_DECL_CONSTEXPR int WIND_POINTER_SIZE = 40;
 
+  QRect userAircraftRect, windPointerRect;
+  QPoint userAircraftPoint;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERVECHICLE_H
@@ -33,11 +33,15 @@
 #include "mapgui/mappainterroute.h"
 #include "mapgui/mappainteruser.h"
 #include "mapgui/mappainteraltitude.h"
+#include "mapgui/mappainterterrain.h"
 #include "mapgui/mapscale.h"
 #include "userdata/userdatacontroller.h"
 #include "route/route.h"
 #include "geo/calculations.h"
 #include "options/optiondata.h"
+#include "settings/settings.h"
+#include "atools.h"
+#include "common/constants.h"
 
 #include <QElapsedTimer>
 
@@ -47,7 +51,7 @@ using namespace Marble;
 using namespace atools::geo;
 
 MapPaintLayer::MapPaintLayer(MapWidget *widget, MapQuery *mapQueries)
-  : mapQuery(mapQueries), mapWidget(widget)
+  : mapQuery(mapQueries), mapWidget(widget), progressiveLayer(0.f), progressiveLayerEffective(0.f)
 {
   // Create the layer configuration
   initMapLayerSettings();
@@ -65,6 +69,7 @@ MapPaintLayer::MapPaintLayer(MapWidget *widget, MapQuery *mapQueries)
   mapPainterShip = new MapPainterShip(mapWidget, mapScale);
   mapPainterUser = new MapPainterUser(mapWidget, mapScale);
   mapPainterAltitude = new MapPainterAltitude(mapWidget, mapScale);
+  mapPainterTerrain = new MapPainterTerrain(mapWidget, mapScale);
   mapPainterWeather = new MapPainterWeather(mapWidget, mapScale);
 
   // Default for visible object types
@@ -84,6 +89,7 @@ MapPaintLayer::~MapPaintLayer()
   delete mapPainterShip;
   delete mapPainterUser;
   delete mapPainterAltitude;
+  delete mapPainterTerrain;
   delete mapPainterWeather;
 
   delete layers;
@@ -98,6 +104,7 @@ void MapPaintLayer::preDatabaseLoad()
 void MapPaintLayer::postDatabaseLoad()
 {
   databaseLoadStatus = false;
+  mapPainterAltitude->clearCache();
 }
 
 void MapPaintLayer::setShowMapObjects(map::MapObjectTypes type, bool show)
@@ -121,6 +128,51 @@ void MapPaintLayer::setShowAirspaces(map::MapAirspaceFilter types)
   airspaceTypes = types;
 }
 
+bool MapPaintLayer::nextProgressiveStage()
+{
+  if(progressiveStage == STAGE_SYMBOLS)
+  {
+    progressiveStage = STAGE_TEXT;
+    return true;
+  }
+  else if(progressiveStage == STAGE_TEXT)
+  {
+    progressiveStage = STAGE_FULL;
+    return true;
+  }
+  return false;
+}
+
+int MapPaintLayer::getProgressiveDelayMs() const
+{
+  return PROGRESSIVE_MIN_DELAY_MS + std::max(0, lastRenderTimeMs - PROGRESSIVE_PASS_BUDGET_MS);
+}
+
+QRect MapPaintLayer::getUserAircraftRect() const
+{
+  return mapPainterAircraft->getUserAircraftRect();
+}
+
+QPoint MapPaintLayer::getUserAircraftPoint() const
+{
+  return mapPainterAircraft->getUserAircraftPoint();
+}
+
+QRect MapPaintLayer::getWindPointerRect() const
+{
+  return mapPainterAircraft->getWindPointerRect();
+}
+
+void MapPaintLayer::routeChanged()
+{
+  mapPainterRoute->routeChanged();
+}
+
+void MapPaintLayer::terrainChanged()
+{
+  mapPainterTerrain->clearCache();
+}
+
 void MapPaintLayer::setDetailFactor(int factor)
 {
   detailFactor = factor;
@@ -150,237 +202,22 @@ map::MapAirspaceFilter MapPaintLayer::getShownAirspacesTypesByLayer() const
 /* Initialize the layer settings that define what is drawn at what zoom distance (text, size, etc.) */
 void MapPaintLayer::initMapLayerSettings()
 {
-  // TODO move to configuration file
   if(layers != nullptr)
     delete layers;
 
   // Create a list of map layers that define content for each zoom distance
   layers = new MapLayerSettings();
 
-  // Create a default layer with all features enabled
-  MapLayer defLayer = MapLayer(0).airport().approach().approachTextAndDetail().airportName().airportIdent().
-                      airportSoft().airportNoRating().airportOverviewRunway().airportSource(layer::ALL).
-
-                      airportWeather().airportWeatherDetails().
-
-                      routeTextAndDetail().
-
-                      minimumAltitude().
-
-                      vor().ndb().waypoint().marker().ils().airway().
-
-                      userpoint().userpointInfo().
-
-                      aiAircraftGround().aiAircraftLarge().aiAircraftSmall().aiShipLarge().aiShipSmall().
-                      aiAircraftGroundText().aiAircraftText().
-
-                      onlineAircraft().onlineAircraftText().
-
-                      airspaceCenter().airspaceFir().airspaceOther().airspaceRestricted().airspaceSpecial().
-                      airspaceIcao().
-
-                      vorRouteIdent().vorRouteInfo().ndbRouteIdent().ndbRouteInfo().waypointRouteName().
-                      airportRouteInfo();
-
-  // Lowest layer including everything (airport diagram and details)
-  // airport diagram, large VOR, NDB, ILS, waypoint, airway, marker
-  layers->
-  append(defLayer.clone(0.2f).airportDiagramRunway().airportDiagram().
-         airportDiagramDetail().airportDiagramDetail2().airportDiagramDetail3().
-         airportSymbolSize(20).airportInfo().
-         waypointSymbolSize(14).waypointName().
-         vorSymbolSize(24).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(24).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayInfo().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(30).
-         markerSymbolSize(24).markerInfo().
-         airportMaxTextLength(30)).
-
-  append(defLayer.clone(0.3f).airportDiagramRunway().airportDiagram().airportDiagramDetail().airportDiagramDetail2().
-         airportSymbolSize(20).airportInfo().
-         waypointSymbolSize(14).waypointName().
-         vorSymbolSize(24).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(24).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayInfo().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(30).
-         markerSymbolSize(24).markerInfo().
-         airportMaxTextLength(30)).
-
-  // airport diagram, large VOR, NDB, ILS, waypoint, airway, marker
-  append(defLayer.clone(1.f).airportDiagramRunway().airportDiagram().airportDiagramDetail().
-         airportSymbolSize(20).airportInfo().
-         aiAircraftGroundText(false).
-         waypointSymbolSize(14).waypointName().
-         vorSymbolSize(24).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(24).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayInfo().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(30).
-         markerSymbolSize(24).markerInfo().
-         airportMaxTextLength(30)).
-
-  // airport diagram, large VOR, NDB, ILS, waypoint, airway, marker
-  append(defLayer.clone(5.f).airportDiagramRunway().airportDiagram().airportSymbolSize(20).airportInfo().
-         waypointSymbolSize(10).waypointName().
-         aiAircraftGroundText(false).
-         vorSymbolSize(24).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(24).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayInfo().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(20).
-         markerSymbolSize(24).markerInfo().
-         airportMaxTextLength(30)).
-
-  // airport, large VOR, NDB, ILS, waypoint, airway, marker
-  append(defLayer.clone(10.f).airportDiagramRunway().airportSymbolSize(18).airportInfo().
-         waypointSymbolSize(8).waypointName().
-         aiAircraftGroundText(false).
-         vorSymbolSize(22).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(22).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(20).
-         markerSymbolSize(24).
-         airportMaxTextLength(20)).
-
-  // airport, large VOR, NDB, ILS, waypoint, airway, marker
-  append(defLayer.clone(25.f).airportDiagramRunway().airportSymbolSize(18).airportInfo().
-         waypointSymbolSize(8).
-         aiAircraftGroundText(false).
-         vorSymbolSize(22).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(22).ndbIdent().ndbInfo().
-         ilsIdent().ilsInfo().
-         airwayIdent().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(20).
-         markerSymbolSize(24).
-         airportMaxTextLength(20)).
-
-  // airport, large VOR, NDB, ILS, airway
-  append(defLayer.clone(50.f).airportSymbolSize(18).airportInfo().
-         waypoint(false).
-         aiAircraftGround(false).aiShipSmall(false).aiAircraftGroundText(false).aiAircraftText(false).
-         vorSymbolSize(20).vorIdent().vorInfo().vorLarge().
-         ndbSymbolSize(20).ndbIdent().ndbInfo().
-         airwayIdent().airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(10).
-         marker(false).
-         airportMaxTextLength(16)).
-
-  // airport, VOR, NDB, ILS, airway
-  append(defLayer.clone(100.f).airportSymbolSize(12).
-         waypoint(false).
-         aiAircraftGround(false).aiShipSmall(false).aiAircraftGroundText(false).aiAircraftText(false).
-         vorSymbolSize(16).vorIdent().
-         ndbSymbolSize(16).ndbIdent().
-         airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(24).userpointMaxTextLength(10).
-         marker(false).
-         airportMaxTextLength(16)).
-
-  // airport, VOR, NDB, airway
-  append(defLayer.clone(150.f).airportSymbolSize(10).minRunwayLength(2500).
-         airportOverviewRunway(false).airportName(false).
-         approachTextAndDetail(false).
-         aiAircraftGround(false).aiShipSmall(false).aiAircraftGroundText(false).aiAircraftText(false).
-         waypoint(false).
-         vorSymbolSize(12).
-         ndbSymbolSize(12).
-         airwayWaypoint().
-         userpoint().userpointInfo().userpoinSymbolSize(22).userpointMaxTextLength(8).
-         marker(false).ils(false).
-         airportMaxTextLength(16)).
-
-  // airport > 4000, VOR
-  append(defLayer.clone(200.f).airportSymbolSize(10).minRunwayLength(layer::MAX_MEDIUM_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportSource(layer::MEDIUM).
-         approachTextAndDetail(false).
-         aiAircraftGround(false).aiShipSmall(false).aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
-         airwayWaypoint().
-         vorSymbolSize(8).ndb(false).waypoint(false).marker(false).ils(false).
-         userpoint().userpointInfo().userpoinSymbolSize(16).userpointMaxTextLength(8).
-         airportMaxTextLength(16)).
-
-  // airport > 4000
-  append(defLayer.clone(300.f).airportSymbolSize(10).minRunwayLength(layer::MAX_MEDIUM_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportSource(layer::MEDIUM).
-         approachTextAndDetail(false).
-         aiAircraftGround(false).aiAircraftSmall(false).aiShipSmall(false).
-         aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
-         ndb(false).waypoint(false).marker(false).ils(false).
-         airportRouteInfo(false).waypointRouteName(false).
-         userpoint().userpointInfo(false).userpoinSymbolSize(16).
-         airportMaxTextLength(16)).
-
-  // airport > 8000
-  append(defLayer.clone(750.f).airportSymbolSize(10).minRunwayLength(layer::MAX_LARGE_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportSource(layer::LARGE).
-         airportWeatherDetails(false).
-         approachTextAndDetail(false).
-         aiAircraftGround(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
-         aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
-         airspaceOther(false).airspaceRestricted(false).airspaceSpecial(false).
-         vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
-         airportRouteInfo(false).vorRouteInfo(false).ndbRouteInfo(false).waypointRouteName(false).
-         userpoint().userpointInfo(false).userpoinSymbolSize(12).
-         airportMaxTextLength(16)).
-
-  // airport > 8000
-  append(defLayer.clone(1200.f).airportSymbolSize(10).minRunwayLength(layer::MAX_LARGE_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportSource(layer::LARGE).
-         airportWeather(false).airportWeatherDetails(false).
-         approachTextAndDetail(false).
-         aiAircraftGround(false).aiAircraftLarge(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
-         aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
-         airspaceFir(false).airspaceOther(false).airspaceRestricted(false).airspaceSpecial(false).
-         airspaceIcao(false).
-         vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
-         airportRouteInfo(false).vorRouteInfo(false).ndbRouteInfo(false).waypointRouteName(false).
-         userpoint().userpointInfo(false).
-         airportMaxTextLength(16)).
-
-  // Display only points for airports until the cutoff limit
-  // airport > 8000
-  append(defLayer.clone(layer::DISTANCE_CUT_OFF_LIMIT).airportSymbolSize(5).
-         minRunwayLength(layer::MAX_LARGE_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportIdent(false).airportSource(layer::LARGE).
-         airportWeather(false).airportWeatherDetails(false).
-         minimumAltitude(false).
-         approach(false).approachTextAndDetail(false).
-         aiAircraftGround(false).aiAircraftLarge(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
-         aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraft(false).onlineAircraftText(false).
-         airspaceCenter(false).airspaceFir(false).airspaceOther(false).
-         airspaceRestricted(false).airspaceSpecial(false).airspaceIcao(false).
-         vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
-         airportRouteInfo(false).vorRouteInfo(false).ndbRouteInfo(false).waypointRouteName(false).
-         userpoint().userpointInfo(false).
-         airportMaxTextLength(16)).
-
-  // Make sure that there is always an layer
-  append(defLayer.clone(100000.f).airportSymbolSize(5).minRunwayLength(layer::MAX_LARGE_RUNWAY_FT).
-         airportOverviewRunway(false).airportName(false).airportIdent(false).airportSource(layer::LARGE).
-         airportWeather(false).airportWeatherDetails(false).
-         minimumAltitude(false).
-         routeTextAndDetail(false).
-         approach(false).approachTextAndDetail(false).
-         aiAircraftGround(false).aiAircraftLarge(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
-         aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraft(false).onlineAircraftText(false).
-         airspaceCenter(false).airspaceFir(false).airspaceOther(false).
-         airspaceRestricted(false).airspaceSpecial(false).airspaceIcao(false).
-         airport(false).vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
-         airportRouteInfo(false).vorRouteInfo(false).ndbRouteInfo(false).waypointRouteName(false).
-         userpoint(false).userpointInfo(false).
-         airportMaxTextLength(16));
-
-  // Sort layers
-  layers->finishAppend();
+  // Load from resources or from overloaded file in the settings folder
+  if(!layers->loadFromFile(atools::settings::Settings::instance().getOverloadedPath(lnm::MAPLAYERS_CONFIG)))
+  {
+    qWarning() << Q_FUNC_INFO << "No map layers loaded. Using default.";
+
+    // Make sure that there is always an layer
+    layers->append(MapLayer(100000.f).airport().airportSource(layer::LARGE).airportSymbolSize(5).
+                   airportMaxTextLength(16).minRunwayLength(layer::MAX_LARGE_RUNWAY_FT));
+    layers->finishAppend();
+  }
   qDebug() << *layers;
 }
 
@@ -391,6 +228,20 @@ void MapPaintLayer::updateLayers()
   // Get the uncorrected effective layer - route painting is independent of declutter
   mapLayerEffective = layers->getLayer(dist);
   mapLayer = layers->getLayer(dist, detailFactor);
+  mapLayerZoomIn = layers->getLayer(dist * ZOOM_IN_LAYER_FACTOR);
+}
+
+void MapPaintLayer::renderPainter(MapPainter *painter, PaintContext *context, const char *name)
+{
+  if(collectPainterTimes)
+  {
+    QElapsedTimer timer;
+    timer.start();
+    painter->render(context);
+    painterTimesNs[QLatin1String(name)] += timer.nsecsElapsed();
+  }
+  else
+    painter->render(context);
 }
 
 bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const QString& renderPos,
@@ -412,20 +263,91 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
        !(viewport->projection() == Marble::Mercator && // Do not draw if Mercator wraps around whole planet
          viewport->viewLatLonAltBox().width(GeoDataCoordinates::Degree) >= 359.))
     {
+      QElapsedTimer renderTimer;
+      renderTimer.start();
+
       updateLayers();
 
+      if(collectPainterTimes)
+        painterTimesNs.clear();
+
+      // Detect any view change by scrolling, zooming, resizing or jumping to a position
+      bool viewChanged = atools::almostNotEqual(viewport->centerLongitude(), lastCenterLon, 1.e-9) ||
+                         atools::almostNotEqual(viewport->centerLatitude(), lastCenterLat, 1.e-9) ||
+                         viewport->radius() != lastRadius || viewport->size() != lastViewSize;
+      lastCenterLon = viewport->centerLongitude();
+      lastCenterLat = viewport->centerLatitude();
+      lastRadius = viewport->radius();
+      lastViewSize = viewport->size();
+
+      // Start over with symbols only after each view change in progressive mode
+      bool progressive = mapScrollDetail == opts::PROGRESSIVE;
+      if(!progressive)
+        progressiveStage = STAGE_FULL;
+      else if(viewChanged || mapWidget->viewContext() == Marble::Animation)
+        progressiveStage = STAGE_SYMBOLS;
+
       PaintContext context;
-      context.mapLayer = mapLayer;
-      context.mapLayerEffective = mapLayerEffective;
+      if(progressive && progressiveStage == STAGE_SYMBOLS)
+      {
+        progressiveLayer = mapLayer->withoutText().withoutDetail();
+        progressiveLayerEffective = mapLayerEffective->withoutText().withoutDetail();
+      }
+      else if(progressive && progressiveStage == STAGE_TEXT)
+      {
+        progressiveLayer = mapLayer->withoutDetail();
+        progressiveLayerEffective = mapLayerEffective->withoutDetail();
+      }
+
+      if(progressiveStage == STAGE_FULL)
+      {
+        context.mapLayer = mapLayer;
+        context.mapLayerEffective = mapLayerEffective;
+      }
+      else
+      {
+        context.mapLayer = &progressiveLayer;
+        context.mapLayerEffective = &progressiveLayerEffective;
+      }
+      context.mapLayerZoomIn = mapLayerZoomIn;
       context.painter = painter;
       context.viewport = viewport;
       context.objectTypes = objectTypes;
       context.objectDisplayTypes = objectDisplayTypes;
       context.airspaceFilterByLayer = getShownAirspacesTypesByLayer();
       context.viewContext = mapWidget->viewContext();
-      context.drawFast = (mapScrollDetail == opts::FULL || mapScrollDetail == opts::HIGHER) ?
-                         false : mapWidget->viewContext() == Marble::Animation;
-      context.lazyUpdate = mapScrollDetail == opts::FULL ? false : mapWidget->viewContext() == Marble::Animation;
+      if(progressive)
+      {
+        switch(progressiveStage)
+        {
+          case STAGE_SYMBOLS:
+            // Use only cached data and simplified drawing without labels
+            context.drawFast = true;
+            context.lazyUpdate = true;
+            context.drawDetail = false;
+            break;
+
+          case STAGE_TEXT:
+            // Reload data and draw labels but no area fills or detailed geometry
+            context.drawFast = false;
+            context.lazyUpdate = false;
+            context.drawDetail = false;
+            break;
+
+          case STAGE_FULL:
+            context.drawFast = false;
+            context.lazyUpdate = false;
+            context.drawDetail = true;
+            break;
+        }
+      }
+      else
+      {
+        context.drawFast = (mapScrollDetail == opts::FULL || mapScrollDetail == opts::HIGHER) ?
+                           false : mapWidget->viewContext() == Marble::Animation;
+        context.lazyUpdate = mapScrollDetail == opts::FULL ? false : mapWidget->viewContext() == Marble::Animation;
+        context.drawDetail = true;
+      }
       context.mapScrollDetail = mapScrollDetail;
       context.distance = atools::geo::meterToNm(static_cast<float>(mapWidget->distance() * 1000.));
 
@@ -483,59 +405,66 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
         painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
       }
 
-      // Altitude below all others
-      mapPainterAltitude->render(&context);
+      // Terrain and altitude below all others
+      renderPainter(mapPainterTerrain, &context, "terrain");
+      renderPainter(mapPainterAltitude, &context, "altitude");
 
       // Ship below other navaids and airports
-      mapPainterShip->render(&context);
+      renderPainter(mapPainterShip, &context, "ship");
 
       if(mapWidget->distance() < layer::DISTANCE_CUT_OFF_LIMIT)
       {
         if(!context.isOverflow())
-          mapPainterAirspace->render(&context);
+          renderPainter(mapPainterAirspace, &context, "airspace");
 
         if(context.mapLayerEffective->isAirportDiagram())
         {
           // Put ILS below and navaids on top of airport diagram
-          mapPainterIls->render(&context);
+          renderPainter(mapPainterIls, &context, "ils");
 
           if(!context.isOverflow())
-            mapPainterAirport->render(&context);
+            renderPainter(mapPainterAirport, &context, "airport");
 
           if(!context.isOverflow())
-            mapPainterNav->render(&context);
+            renderPainter(mapPainterNav, &context, "nav");
         }
         else
         {
           // Airports on top of all
           if(!context.isOverflow())
-            mapPainterIls->render(&context);
+            renderPainter(mapPainterIls, &context, "ils");
 
           if(!context.isOverflow())
-            mapPainterNav->render(&context);
+            renderPainter(mapPainterNav, &context, "nav");
 
           if(!context.isOverflow())
-            mapPainterAirport->render(&context);
+            renderPainter(mapPainterAirport, &context, "airport");
         }
       }
 
       if(!context.isOverflow())
-        mapPainterUser->render(&context);
+        renderPainter(mapPainterUser, &context, "user");
 
       // if(!context.isOverflow()) always paint route even if number of objets is too large
-      mapPainterRoute->render(&context);
+      renderPainter(mapPainterRoute, &context, "route");
 
-      mapPainterWeather->render(&context);
+      renderPainter(mapPainterWeather, &context, "weather");
 
       // if(!context.isOverflow())
-      mapPainterMark->render(&context);
+      renderPainter(mapPainterMark, &context, "mark");
 
-      mapPainterAircraft->render(&context);
+      renderPainter(mapPainterAircraft, &context, "aircraft");
 
       if(context.isOverflow())
         overflow = PaintContext::MAX_OBJECT_COUNT;
       else
         overflow = 0;
+
+      lastRenderTimeMs = static_cast<int>(renderTimer.elapsed());
+
+      // Add details in the next pass once the map has stopped moving
+      if(progressive && progressiveStage != STAGE_FULL && mapWidget->viewContext() == Marble::Still)
+        mapWidget->startProgressiveRenderTimer(getProgressiveDelayMs());
     }
 
     if(!mapWidget->isPrinting())
@@ -19,8 +19,10 @@
 #define LITTLENAVMAP_MAPPAINTLAYER_H
 
 #include "mapgui/mappainter.h"
+#include "mapgui/maplayer.h"
 
 #include <QPen>
+#include <QMap>
 
 #include <marble/LayerInterface.h>
 
@@ -31,7 +33,6 @@ class ViewportParams;
 }
 
 class MapPainter;
-class MapLayer;
 class MapWidget;
 class MapLayerSettings;
 class MapScale;
@@ -45,6 +46,7 @@ class MapPainterAircraft;
 class MapPainterShip;
 class MapPainterUser;
 class MapPainterAltitude;
+class MapPainterTerrain;
 class MapPainterWeather;
 
 /*
@@ -62,6 +64,11 @@ public:
   void preDatabaseLoad();
   void postDatabaseLoad();
 
+  bool isDatabaseLoadStatus() const
+  {
+    return databaseLoadStatus;
+  }
+
   /* Get the current map layer for the zoom distance and detail level */
   const MapLayer *getMapLayer() const
   {
@@ -79,6 +86,25 @@ public:
   void setShowMapObjectsDisplay(map::MapObjectDisplayTypes type, bool show);
   void setShowAirspaces(map::MapAirspaceFilter types);
 
+  /* Advance to the next detail stage if progressive rendering is enabled.
+   * @return true if a repaint is needed */
+  bool nextProgressiveStage();
+
+  /* Delay in ms before the next progressive stage should be painted. Depends on time needed for the last pass. */
+  int getProgressiveDelayMs() const;
+
+  /* true if the last frame was drawn with full detail or progressive rendering is disabled */
+  bool isProgressiveComplete() const
+  {
+    return progressiveStage == STAGE_FULL;
+  }
+
+  /* Flight plan or options changed. Invalidates cached route geometry. Does not repaint */
+  void routeChanged();
+
+  /* Elevation data or options changed. Drops cached terrain shading tiles. Does not repaint */
+  void terrainChanged();
+
   /* Changes the detail factor (range 5-15 default is 10 */
   void setDetailFactor(int factor);
 
@@ -127,10 +153,49 @@ public:
     sunShading = value;
   }
 
+  /* Enable collection of rendering times per painter for benchmarking. Times are cleared for each rendered frame. */
+  void setCollectPainterTimes(bool value)
+  {
+    collectPainterTimes = value;
+    painterTimesNs.clear();
+  }
+
+  /* Painter name to rendering time in nanoseconds for the last frame. Empty if collection is disabled. */
+  const QMap<QString, qint64>& getPainterTimesNs() const
+  {
+    return painterTimesNs;
+  }
+
+  /* Screen areas covered by user aircraft and wind pointer in the last frame. Used for partial updates. */
+  QRect getUserAircraftRect() const;
+  QPoint getUserAircraftPoint() const;
+  QRect getWindPointerRect() const;
+
 private:
+  /* Detail stages for progressive rendering (opts::PROGRESSIVE). The map is drawn with STAGE_SYMBOLS after
+   * each view change and detail is added in idle passes after the map has stopped. */
+  enum ProgressiveStage
+  {
+    STAGE_SYMBOLS, /* Only symbols from cached data - no reload, no text and no details */
+    STAGE_TEXT, /* Reload data and add text labels */
+    STAGE_FULL /* All details like airport diagrams, aprons and airspace fill */
+  };
+
+  /* Minimum time between progressive passes to allow event processing */
+  static Q_DECL_CONSTEXPR int PROGRESSIVE_MIN_DELAY_MS = 20;
+
+  /* Time budget for one pass. Overruns are added to the delay for the next pass. */
+  static Q_DECL_CONSTEXPR int PROGRESSIVE_PASS_BUDGET_MS = 50;
+
+  /* Zoom distance factor for the layer of the next closer zoom step. Used to prepare data in background. */
+  static Q_DECL_CONSTEXPR float ZOOM_IN_LAYER_FACTOR = 0.5f;
+
   void initMapLayerSettings();
   void updateLayers();
 
+  /* Calls the painter and adds the time needed to painterTimesNs if enabled */
+  void renderPainter(MapPainter *painter, PaintContext *context, const char *name);
+
   /* Implemented from LayerInterface: We  draw above all but below user tools */
   virtual QStringList renderPosition() const override
   {
@@ -164,6 +229,7 @@ private:
   MapPainterShip *mapPainterShip;
   MapPainterUser *mapPainterUser;
   MapPainterAltitude *mapPainterAltitude;
+  MapPainterTerrain *mapPainterTerrain;
   MapPainterWeather *mapPainterWeather;
 
   /* Database source */
@@ -172,9 +238,23 @@ private:
   MapScale *mapScale = nullptr;
   MapLayerSettings *layers = nullptr;
   MapWidget *mapWidget = nullptr;
-  const MapLayer *mapLayer = nullptr, *mapLayerEffective = nullptr;
+  const MapLayer *mapLayer = nullptr, *mapLayerEffective = nullptr, *mapLayerZoomIn = nullptr;
   int overflow = 0;
 
+  /* Progressive rendering state and reduced copies of the layers above */
+  ProgressiveStage progressiveStage = STAGE_FULL;
+  MapLayer progressiveLayer, progressiveLayerEffective;
+
+  /* View of the last rendered frame to detect view changes */
+  double lastCenterLon = 0., lastCenterLat = 0.;
+  int lastRadius = 0;
+  QSize lastViewSize;
+  int lastRenderTimeMs = 0;
+
+  /* Benchmark timings */
+  bool collectPainterTimes = false;
+  QMap<QString, qint64> painterTimesNs;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTLAYER_H
@@ -36,7 +36,13 @@
 #include "common/constants.h"
 #include "settings/settings.h"
 
+#include <QDateTime>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
+
 #include <marble/GeoDataLineString.h>
+#include <marble/ViewportParams.h>
 
 using atools::geo::Pos;
 using atools::geo::Line;
@@ -52,56 +58,64 @@ MapScreenIndex::MapScreenIndex(MapWidget *parentWidget, MapPaintLayer *mapPaintL
   airspaceQuery = NavApp::getAirspaceQuery();
   airspaceQueryOnline = NavApp::getAirspaceQueryOnline();
   airportQuery = NavApp::getAirportQuerySim();
+
+  // Notification from threads that geometry is ready - take the result and check if it still fits the view
+  QObject::connect(&airwayWatcher, &QFutureWatcher<AirwayGeometry>::finished, [this]()
+  {
+    airwayGeometry = airwayFuture.result();
+
+    // Database is offline - index is updated after loading
+    if(!paintLayer->isDatabaseLoadStatus())
+      updateAirwayScreenGeometry(lastAirwayBox);
+  });
+
+  QObject::connect(&airspaceWatcher, &QFutureWatcher<AirspaceGeometry>::finished, [this]()
+  {
+    airspaceGeometry = airspaceFuture.result();
+
+    if(!paintLayer->isDatabaseLoadStatus())
+      updateAirspaceScreenGeometry(lastAirspaceBox);
+  });
 }
 
 MapScreenIndex::~MapScreenIndex()
 {
-
+  airwayWatcher.disconnect();
+  airspaceWatcher.disconnect();
+  airwayFuture.waitForFinished();
+  airspaceFuture.waitForFinished();
 }
 
-void MapScreenIndex::updateAirspaceScreenGeometry(QList<std::pair<int, QPolygon> >& polygons, AirspaceQuery *query,
+void MapScreenIndex::collectAirspaceGeometryInput(QVector<std::pair<int, atools::geo::LineString> >& input,
+                                                  uint& checksum, AirspaceQuery *query,
                                                   const Marble::GeoDataLatLonAltBox& curBox)
 {
-  CoordinateConverter conv(mapWidget->viewport());
-  const MapScale *scale = paintLayer->getMapScale();
-  if(scale->isValid())
-  {
-    const QList<map::MapAirspace> *airspaces = query->getAirspaces(
-      curBox, paintLayer->getMapLayer(), mapWidget->getShownAirspaceTypesByLayer(),
-      NavApp::getRouteConst().getCruisingAltitudeFeet(), false);
+  const QList<map::MapAirspace> *airspaces = query->getAirspaces(
+    curBox, paintLayer->getMapLayer(), mapWidget->getShownAirspaceTypesByLayer(),
+    NavApp::getRouteConst().getCruisingAltitudeFeet(), false);
 
-    if(airspaces != nullptr)
+  if(airspaces != nullptr)
+  {
+    for(const map::MapAirspace& airspace : *airspaces)
     {
-      for(const map::MapAirspace& airspace : *airspaces)
-      {
-        if(!(airspace.type & mapWidget->getShownAirspaceTypesByLayer().types))
-          continue;
+      if(!(airspace.type & mapWidget->getShownAirspaceTypesByLayer().types))
+        continue;
 
-        Marble::GeoDataLatLonBox airspacebox(airspace.bounding.getNorth(), airspace.bounding.getSouth(),
-                                             airspace.bounding.getEast(), airspace.bounding.getWest(),
-                                             Marble::GeoDataCoordinates::Degree);
+      Marble::GeoDataLatLonBox airspacebox(airspace.bounding.getNorth(), airspace.bounding.getSouth(),
+                                           airspace.bounding.getEast(), airspace.bounding.getWest(),
+                                           Marble::GeoDataCoordinates::Degree);
 
-        if(airspacebox.intersects(curBox))
+      if(airspacebox.intersects(curBox))
+      {
+        // Copy is cheap since geometry is implicitly shared
+        const atools::geo::LineString *lines = query->getAirspaceGeometry(airspace.id);
+        if(lines != nullptr)
         {
-          QPolygon polygon;
-          int x, y;
-
-          const atools::geo::LineString *lines = query->getAirspaceGeometry(airspace.id);
-
-          for(const Pos& pos : *lines)
-          {
-            conv.wToS(pos, x, y /*, QSize(2000, 2000)*/);
-            // qDebug() << airspace.name << pos << x << y;
-            polygon.append(QPoint(x, y));
-          }
-
-          // qDebug() << airspace.name << polygon;
-
-          polygon = polygon.intersected(QPolygon(mapWidget->rect()));
-
-          // qDebug() << airspace.name << polygon;
-
-          polygons.append(std::make_pair(airspace.id, polygon));
+          input.append(std::make_pair(airspace.id, *lines));
+          checksum = checksum * 31u + static_cast<uint>(airspace.id);
+          checksum = checksum * 31u + static_cast<uint>(lines->size());
+          if(!lines->isEmpty())
+            checksum = checksum * 31u + qHash(lines->first().getLonX()) + qHash(lines->first().getLatY());
         }
       }
     }
@@ -113,86 +127,327 @@ void MapScreenIndex::resetAirspaceOnlineScreenGeometry()
   // Clear internal caches
   airspaceQueryOnline->deInitQueries();
   airspaceQueryOnline->initQueries();
+
+  // Online airspaces can change geometry but keep their ids
+  airspaceGeometry = AirspaceGeometry();
 }
 
 void MapScreenIndex::updateAirspaceScreenGeometry(const Marble::GeoDataLatLonAltBox& curBox)
 {
-  airspacePolygons.clear();
-  airspacePolygonsOnline.clear();
+  lastAirspaceBox = curBox;
 
   if(!paintLayer->getMapLayer()->isAirspace() ||
      !(paintLayer->getShownMapObjects().testFlag(map::AIRSPACE) ||
-       paintLayer->getShownMapObjects().testFlag(map::AIRSPACE_ONLINE)))
-    return;
-
-  if(paintLayer->getMapLayerEffective()->isAirportDiagram())
+       paintLayer->getShownMapObjects().testFlag(map::AIRSPACE_ONLINE)) ||
+     paintLayer->getMapLayerEffective()->isAirportDiagram() ||
+     mapWidget->distance() >= layer::DISTANCE_CUT_OFF_LIMIT || // Do not put into index if nothing is drawn
+     !paintLayer->getMapScale()->isValid())
+  {
+    airspaceGeometry = AirspaceGeometry();
+    airspacePolygons.clear();
+    airspacePolygonsOnline.clear();
+    airspaceGrid.clear();
+    airspaceGridOnline.clear();
     return;
+  }
 
-  // Do not put into index if nothing is drawn
-  if(mapWidget->distance() >= layer::DISTANCE_CUT_OFF_LIMIT)
+  if(airspaceFuture.isRunning())
+    // Will be called again for lastAirspaceBox once the thread has finished - keep the old index until then
     return;
 
+  QVector<std::pair<int, atools::geo::LineString> > input, inputOnline;
+  uint checksum = 0;
   if(paintLayer->getShownMapObjects().testFlag(map::AIRSPACE))
-    updateAirspaceScreenGeometry(airspacePolygons, airspaceQuery, curBox);
+    collectAirspaceGeometryInput(input, checksum, airspaceQuery, curBox);
+
+  // Separate online from simulator airspaces which can have the same id
+  checksum = checksum * 31u + 1u;
 
   if(paintLayer->getShownMapObjects().testFlag(map::AIRSPACE_ONLINE))
-    updateAirspaceScreenGeometry(airspacePolygonsOnline, airspaceQueryOnline, curBox);
+    collectAirspaceGeometryInput(inputOnline, checksum, airspaceQueryOnline, curBox);
+
+  GeometryView view = currentGeometryView();
+  QPoint offset;
+  if(airspaceGeometry.checksum == checksum && canMoveGeometry(airspaceGeometry.view, view, offset))
+    // Same airspaces and simple pan or no change at all
+    publishAirspaceGeometry(offset);
+  else
+  {
+    airspaceFuture = QtConcurrent::run(&MapScreenIndex::calculateAirspaceGeometry, view, checksum, input,
+                                       inputOnline);
+    airspaceWatcher.setFuture(airspaceFuture);
+  }
 }
 
 void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonAltBox& curBox)
 {
-  airwayLines.clear();
+  lastAirwayBox = curBox;
 
-  CoordinateConverter conv(mapWidget->viewport());
   const MapScale *scale = paintLayer->getMapScale();
   bool showJet = paintLayer->getShownMapObjects().testFlag(map::AIRWAYJ);
   bool showVictor = paintLayer->getShownMapObjects().testFlag(map::AIRWAYV);
 
-  if(scale->isValid() && paintLayer->getMapLayer()->isAirway() && (showJet || showVictor))
+  if(!scale->isValid() || !paintLayer->getMapLayer()->isAirway() || !(showJet || showVictor))
   {
-    // Airways are visible on map - get them from the cache/database
-    const QList<MapAirway> *airways = mapQuery->getAirways(curBox, paintLayer->getMapLayer(), false);
-    const QRect& mapGeo = mapWidget->rect();
+    airwayGeometry = AirwayGeometry();
+    airwayLines.clear();
+    airwayGrid.clear();
+    return;
+  }
+
+  if(airwayFuture.isRunning())
+    // Will be called again for lastAirwayBox once the thread has finished - keep the old index until then
+    return;
+
+  // Airways are visible on map - get them from the cache/database
+  const QList<MapAirway> *airways = mapQuery->getAirways(curBox, paintLayer->getMapLayer(), false);
+
+  QVector<AirwayGeometryInput> input;
+  uint checksum = 0;
+  for(int i = 0; i < airways->size(); i++)
+  {
+    const MapAirway& airway = airways->at(i);
+    if((airway.type == map::VICTOR && !showVictor) || (airway.type == map::JET && !showJet))
+      continue;
+
+    const Rect& bnd = airway.bounding;
+    Marble::GeoDataLatLonBox airwaybox(bnd.getNorth(), bnd.getSouth(), bnd.getEast(), bnd.getWest(),
+                                       Marble::GeoDataCoordinates::Degree);
 
-    for(int i = 0; i < airways->size(); i++)
+    if(airwaybox.intersects(curBox))
     {
-      const MapAirway& airway = airways->at(i);
-      if((airway.type == map::VICTOR && !showVictor) || (airway.type == map::JET && !showJet))
-        continue;
+      // Airway segment intersects with view rectangle
+      AirwayGeometryInput airwayInput;
+      airwayInput.id = airway.id;
+      airwayInput.from = airway.from;
+      airwayInput.to = airway.to;
+      airwayInput.distanceMeter = airway.from.distanceMeterTo(airway.to);
+
+      // Approximate the needed number of line segments
+      airwayInput.numSegments =
+        std::min(std::max(scale->getPixelIntForMeter(airwayInput.distanceMeter) / 40.f, 2.f), 72.f);
+      input.append(airwayInput);
+
+      // Include coordinates to detect database changes
+      checksum = checksum * 31u + static_cast<uint>(airway.id);
+      checksum = checksum * 31u + qHash(airway.from.getLonX()) + qHash(airway.from.getLatY());
+      checksum = checksum * 31u + qHash(airway.to.getLonX()) + qHash(airway.to.getLatY());
+    }
+  }
+
+  GeometryView view = currentGeometryView();
+  QPoint offset;
+  if(airwayGeometry.checksum == checksum && canMoveGeometry(airwayGeometry.view, view, offset))
+    // Same airways and simple pan or no change at all
+    publishAirwayGeometry(offset);
+  else
+  {
+    airwayFuture = QtConcurrent::run(&MapScreenIndex::calculateAirwayGeometry, view, checksum, input);
+    airwayWatcher.setFuture(airwayFuture);
+  }
+}
+
+MapScreenIndex::AirwayGeometry MapScreenIndex::calculateAirwayGeometry(GeometryView view, uint checksum,
+                                                                      QVector<AirwayGeometryInput> input)
+{
+  AirwayGeometry geometry;
+  geometry.view = view;
+  geometry.checksum = checksum;
+
+  // Keep everything up to one screen size outside to allow moving the geometry later
+  QRect area(QPoint(0, 0), view.size);
+  area.adjust(-view.size.width(), -view.size.height(), view.size.width(), view.size.height());
 
-      const Rect& bnd = airway.bounding;
-      Marble::GeoDataLatLonBox airwaybox(bnd.getNorth(), bnd.getSouth(), bnd.getEast(), bnd.getWest(),
-                                         Marble::GeoDataCoordinates::Degree);
+  for(const AirwayGeometryInput& airway : input)
+  {
+    float step = 1.f / airway.numSegments;
 
-      if(airwaybox.intersects(curBox))
+    // Split the segments into smaller lines and add them only if visible
+    for(int j = 0; j < airway.numSegments; j++)
+    {
+      float cur = step * static_cast<float>(j);
+      int xs1, ys1, xs2, ys2;
+      wToSGeometry(view, airway.from.interpolate(airway.to, airway.distanceMeter, cur), xs1, ys1);
+      wToSGeometry(view, airway.from.interpolate(airway.to, airway.distanceMeter, cur + step), xs2, ys2);
+
+      QRect rect(QPoint(xs1, ys1), QPoint(xs2, ys2));
+      rect = rect.normalized();
+      // Avoid points or flat rectangles (lines)
+      rect.adjust(-1, -1, 1, 1);
+
+      if(area.intersects(rect))
+        geometry.lines.append(std::make_pair(airway.id, QLine(xs1, ys1, xs2, ys2)));
+    }
+  }
+  return geometry;
+}
+
+MapScreenIndex::AirspaceGeometry MapScreenIndex::calculateAirspaceGeometry(
+  GeometryView view, uint checksum, QVector<std::pair<int, atools::geo::LineString> > input,
+  QVector<std::pair<int, atools::geo::LineString> > inputOnline)
+{
+  AirspaceGeometry geometry;
+  geometry.view = view;
+  geometry.checksum = checksum;
+
+  for(int k = 0; k < 2; k++)
+  {
+    const QVector<std::pair<int, atools::geo::LineString> >& airspaces = k == 0 ? input : inputOnline;
+    QList<std::pair<int, QPolygon> >& polygons = k == 0 ? geometry.polygons : geometry.polygonsOnline;
+
+    for(const std::pair<int, atools::geo::LineString>& airspace : airspaces)
+    {
+      QPolygon polygon;
+      polygon.reserve(airspace.second.size());
+      for(const Pos& pos : airspace.second)
       {
-        // Airway segment intersects with view rectangle
-        float distanceMeter = airway.from.distanceMeterTo(airway.to);
-        // Approximate the needed number of line segments
-        float numSegments = std::min(std::max(scale->getPixelIntForMeter(distanceMeter) / 40.f, 2.f), 72.f);
-        float step = 1.f / numSegments;
-
-        // Split the segments into smaller lines and add them only if visible
-        for(int j = 0; j < numSegments; j++)
-        {
-          float cur = step * static_cast<float>(j);
-          int xs1, ys1, xs2, ys2;
-          conv.wToS(airway.from.interpolate(airway.to, distanceMeter, cur), xs1, ys1);
-          conv.wToS(airway.from.interpolate(airway.to, distanceMeter, cur + step), xs2, ys2);
-
-          QRect rect(QPoint(xs1, ys1), QPoint(xs2, ys2));
-          rect = rect.normalized();
-          // Avoid points or flat rectangles (lines)
-          rect.adjust(-1, -1, 1, 1);
-
-          if(mapGeo.intersects(rect))
-            airwayLines.append(std::make_pair(airway.id, QLine(xs1, ys1, xs2, ys2)));
-        }
+        int x, y;
+        wToSGeometry(view, pos, x, y);
+        polygon.append(QPoint(x, y));
       }
+
+      // Polygon is not clipped to the screen which does not change the result of point in polygon tests
+      // for points on the screen
+      polygons.append(std::make_pair(airspace.first, polygon));
+    }
+  }
+  return geometry;
+}
+
+void MapScreenIndex::publishAirwayGeometry(const QPoint& offset)
+{
+  airwayLines.clear();
+
+  // Lines just outside the map can still be near the cursor
+  airwayGrid.reset(mapWidget->rect(), ScreenGrid::DEFAULT_CELL_SIZE);
+
+  const QRect& mapGeo = mapWidget->rect();
+  for(const std::pair<int, QLine>& linePair : airwayGeometry.lines)
+  {
+    QLine line = linePair.second.translated(offset);
+
+    QRect rect = QRect(line.p1(), line.p2()).normalized();
+    rect.adjust(-1, -1, 1, 1);
+
+    if(mapGeo.intersects(rect))
+    {
+      airwayGrid.insert(airwayLines.size(), line);
+      airwayLines.append(std::make_pair(linePair.first, line));
     }
   }
 }
 
+void MapScreenIndex::publishAirspaceGeometry(const QPoint& offset)
+{
+  publishAirspaceGeometry(airspaceGeometry.polygons, airspacePolygons, airspaceGrid, offset);
+  publishAirspaceGeometry(airspaceGeometry.polygonsOnline, airspacePolygonsOnline, airspaceGridOnline, offset);
+}
+
+void MapScreenIndex::publishAirspaceGeometry(const QList<std::pair<int, QPolygon> >& from,
+                                             QList<std::pair<int, QPolygon> >& to, ScreenGrid& grid,
+                                             const QPoint& offset)
+{
+  to.clear();
+  grid.reset(mapWidget->rect());
+
+  const QRect& mapGeo = mapWidget->rect();
+  for(const std::pair<int, QPolygon>& polyPair : from)
+  {
+    // Avoid copying if not moved
+    QPolygon polygon = offset.isNull() ? polyPair.second : polyPair.second.translated(offset);
+    QRect bounding = polygon.boundingRect();
+
+    if(mapGeo.intersects(bounding))
+    {
+      grid.insert(to.size(), bounding);
+      to.append(std::make_pair(polyPair.first, polygon));
+    }
+  }
+}
+
+MapScreenIndex::GeometryView MapScreenIndex::currentGeometryView() const
+{
+  const Marble::ViewportParams *viewport = mapWidget->viewport();
+
+  GeometryView view;
+  view.projection = viewport->projection();
+  view.radius = viewport->radius();
+  view.centerLon = viewport->centerLongitude();
+  view.centerLat = viewport->centerLatitude();
+  view.size = viewport->size();
+  return view;
+}
+
+bool MapScreenIndex::canMoveGeometry(const GeometryView& from, const GeometryView& to, QPoint& offset)
+{
+  offset = QPoint(0, 0);
+
+  if(from == to)
+    return true;
+
+  // Pans are a simple translation only in the Mercator projection for the same zoom
+  if(from.projection != Marble::Mercator || to.projection != Marble::Mercator ||
+     from.radius != to.radius || from.size != to.size)
+    return false;
+
+  double rad2Pixel = 2. * to.radius / M_PI;
+
+  // Avoid repeating world and views crossing the anti-meridian including the extra area around the screen
+  double halfWidthRad = 1.5 * to.size.width() / rad2Pixel;
+  if(std::abs(from.centerLon) + halfWidthRad > M_PI || std::abs(to.centerLon) + halfWidthRad > M_PI)
+    return false;
+
+  double dx = (from.centerLon - to.centerLon) * rad2Pixel;
+  double dy = (std::atanh(std::sin(to.centerLat)) - std::atanh(std::sin(from.centerLat))) * rad2Pixel;
+
+  // Geometry covers only one screen size around the view
+  if(std::abs(dx) > to.size.width() || std::abs(dy) > to.size.height())
+    return false;
+
+  offset = QPoint(static_cast<int>(std::round(dx)), static_cast<int>(std::round(dy)));
+  return true;
+}
+
+bool MapScreenIndex::wToSGeometry(const GeometryView& view, const atools::geo::Pos& pos, int& x, int& y)
+{
+  double lon = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+  double lat = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+
+  // Longitude difference normalized to -180 to 180 degree
+  double dLon = std::remainder(lon - view.centerLon, 2. * M_PI);
+  double sx, sy;
+  bool visible = true;
+
+  if(view.projection == Marble::Mercator)
+  {
+    // Same scale as Marble::MercatorProjection - cut off at the maximum Mercator latitude
+    static Q_DECL_CONSTEXPR double MAX_LAT = 85.05113 * M_PI / 180.;
+    double rad2Pixel = 2. * view.radius / M_PI;
+    lat = std::max(std::min(lat, MAX_LAT), -MAX_LAT);
+    sx = dLon * rad2Pixel;
+    sy = (std::atanh(std::sin(lat)) - std::atanh(std::sin(view.centerLat))) * rad2Pixel;
+  }
+  else
+  {
+    // Orthographic projection like Marble::SphericalProjection
+    double cosLat = std::cos(lat), sinLat = std::sin(lat);
+    double cosCenterLat = std::cos(view.centerLat), sinCenterLat = std::sin(view.centerLat);
+    sx = view.radius * cosLat * std::sin(dLon);
+    sy = view.radius * (cosCenterLat * sinLat - sinCenterLat * cosLat * std::cos(dLon));
+    visible = sinCenterLat * sinLat + cosCenterLat * cosLat * std::cos(dLon) >= 0.;
+  }
+
+  x = static_cast<int>(std::round(view.size.width() / 2. + sx));
+  y = static_cast<int>(std::round(view.size.height() / 2. - sy));
+  return visible;
+}
+
+bool MapScreenIndex::GeometryView::operator==(const GeometryView& other) const
+{
+  return projection == other.projection && radius == other.radius &&
+         centerLon == other.centerLon && centerLat == other.centerLat && size == other.size;
+}
+
 void MapScreenIndex::saveState()
 {
   atools::settings::Settings& s = atools::settings::Settings::instance();
@@ -299,6 +554,12 @@ void MapScreenIndex::updateRouteScreenGeometry(const Marble::GeoDataLatLonAltBox
   }
 }
 
+void MapScreenIndex::updateSimData(const atools::fs::sc::SimConnectData& data)
+{
+  userAircraft = data.getUserAircraftConst();
+  traffic.update(data.getAiAircraftConst(), QDateTime::currentMSecsSinceEpoch());
+}
+
 void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapSearchResult& result)
 {
   getAllNearest(xs, ys, maxDistance, result, nullptr);
@@ -319,30 +580,35 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapSear
   result.userAircraft = atools::fs::sc::SimConnectUserAircraft();
   if(shown & map::AIRCRAFT && NavApp::isConnectedAndAircraft())
   {
-    const atools::fs::sc::SimConnectUserAircraft& user = simData.getUserAircraftConst();
     int x, y;
-    if(conv.wToS(user.getPosition(), x, y))
+    if(conv.wToS(userAircraft.getPosition(), x, y))
     {
       if(atools::geo::manhattanDistance(x, y, xs, ys) < maxDistance)
-        result.userAircraft = user;
+        result.userAircraft = userAircraft;
     }
   }
 
   // Check for AI / multiplayer aircraft from simulator ==============================
   int x, y;
 
+  // Get only vehicles in view at the positions as drawn
+  QVector<TrafficStore::Vehicle> vehicles;
+  if(NavApp::isConnected() || mapWidget->getUserAircraft().isDebug())
+    traffic.getVehicles(vehicles, mapWidget->viewport()->viewLatLonAltBox());
+
   // Add boats ======================================
   result.aiAircraft.clear();
   if(NavApp::isConnected())
   {
     if(shown & map::AIRCRAFT_AI_SHIP && mapLayer->isAiShipLarge())
     {
-      for(const atools::fs::sc::SimConnectAircraft& obj : simData.getAiAircraftConst())
+      for(const TrafficStore::Vehicle& vehicle : vehicles)
       {
+        const atools::fs::sc::SimConnectAircraft& obj = *vehicle.aircraft;
         if(obj.getCategory() == atools::fs::sc::BOAT &&
            (obj.getModelRadiusCorrected() * 2 > layer::LARGE_SHIP_SIZE || mapLayer->isAiShipSmall()))
         {
-          if(conv.wToS(obj.getPosition(), x, y))
+          if(conv.wToS(vehicle.position, x, y))
             if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
               insertSortedByDistance(conv, result.aiAircraft, nullptr, xs, ys, obj);
         }
@@ -353,23 +619,21 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapSear
   if(shown & map::AIRCRAFT_AI)
   {
     // Add AI or injected multiplayer aircraft ======================================
-    if(NavApp::isConnected() || mapWidget->getUserAircraft().isDebug())
+    for(const TrafficStore::Vehicle& vehicle : vehicles)
     {
-      for(const atools::fs::sc::SimConnectAircraft& obj : mapWidget->getAiAircraft())
+      const atools::fs::sc::SimConnectAircraft& obj = *vehicle.aircraft;
+      if(obj.getCategory() != atools::fs::sc::BOAT && mapfunc::aircraftVisible(obj, mapLayer))
       {
-        if(obj.getCategory() != atools::fs::sc::BOAT && mapfunc::aircraftVisible(obj, mapLayer))
+        if(conv.wToS(vehicle.position, x, y))
         {
-          if(conv.wToS(obj.getPosition(), x, y))
+          if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
           {
-            if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
-            {
-              // Add online network shadow aircraft from simulator to online list
-              atools::fs::sc::SimConnectAircraft shadow;
-              if(NavApp::getOnlinedataController()->getShadowAircraft(shadow, obj))
-                insertSortedByDistance(conv, result.onlineAircraft, &result.onlineAircraftIds, xs, ys, shadow);
+            // Add online network shadow aircraft from simulator to online list
+            atools::fs::sc::SimConnectAircraft shadow;
+            if(NavApp::getOnlinedataController()->getShadowAircraft(shadow, obj))
+              insertSortedByDistance(conv, result.onlineAircraft, &result.onlineAircraftIds, xs, ys, shadow);
 
-              insertSortedByDistance(conv, result.aiAircraft, nullptr, xs, ys, obj);
-            }
+            insertSortedByDistance(conv, result.aiAircraft, nullptr, xs, ys, obj);
           }
         }
       }
@@ -521,33 +785,33 @@ int MapScreenIndex::getNearestRoutePointIndex(int xs, int ys, int maxDistance)
   return minIndex;
 }
 
-/* Get all airways near cursor position */
+/* Get all airspaces near cursor position */
 void MapScreenIndex::getNearestAirspaces(int xs, int ys, map::MapSearchResult& result)
 {
   if(!paintLayer->getShownMapObjects().testFlag(map::AIRSPACE) &&
      !paintLayer->getShownMapObjects().testFlag(map::AIRSPACE_ONLINE))
     return;
 
-  for(int i = 0; i < airspacePolygons.size(); i++)
-  {
-    const std::pair<int, QPolygon>& polyPair = airspacePolygons.at(i);
+  getNearestAirspaces(xs, ys, airspacePolygons, airspaceGrid, NavApp::getAirspaceQuery(), result);
+  getNearestAirspaces(xs, ys, airspacePolygonsOnline, airspaceGridOnline, NavApp::getAirspaceQueryOnline(), result);
+}
 
-    if(polyPair.second.containsPoint(QPoint(xs, ys), Qt::OddEvenFill))
-    {
-      map::MapAirspace airspace;
-      NavApp::getAirspaceQuery()->getAirspaceById(airspace, polyPair.first);
-      result.airspaces.append(airspace);
-    }
-  }
+void MapScreenIndex::getNearestAirspaces(int xs, int ys, const QList<std::pair<int, QPolygon> >& polygons,
+                                         const ScreenGrid& grid, AirspaceQuery *query,
+                                         map::MapSearchResult& result)
+{
+  // Get candidates from the cells at the cursor position
+  QVector<int> indexes;
+  grid.getNearest(xs, ys, 0, indexes);
 
-  for(int i = 0; i < airspacePolygonsOnline.size(); i++)
+  for(int i : indexes)
   {
-    const std::pair<int, QPolygon>& polyPair = airspacePolygonsOnline.at(i);
+    const std::pair<int, QPolygon>& polyPair = polygons.at(i);
 
     if(polyPair.second.containsPoint(QPoint(xs, ys), Qt::OddEvenFill))
     {
       map::MapAirspace airspace;
-      NavApp::getAirspaceQueryOnline()->getAirspaceById(airspace, polyPair.first);
+      query->getAirspaceById(airspace, polyPair.first);
       result.airspaces.append(airspace);
     }
   }
@@ -560,7 +824,11 @@ void MapScreenIndex::getNearestAirways(int xs, int ys, int maxDistance, map::Map
      !paintLayer->getShownMapObjects().testFlag(map::AIRWAYV))
     return;
 
-  for(int i = 0; i < airwayLines.size(); i++)
+  // Get candidates from the cells around the cursor position
+  QVector<int> indexes;
+  airwayGrid.getNearest(xs, ys, maxDistance, indexes);
+
+  for(int i : indexes)
   {
     const std::pair<int, QLine>& linePair = airwayLines.at(i);
 
@@ -21,16 +21,20 @@
 #include "fs/sc/simconnectdata.h"
 
 #include "route/route.h"
+#include "common/screengrid.h"
+#include "mapgui/trafficstore.h"
+#include "geo/linestring.h"
+
+#include <QFuture>
+#include <QFutureWatcher>
+
+#include <marble/GeoDataLatLonAltBox.h>
 
 namespace map {
 struct MapSearchResult;
 
 }
 
-namespace Marble {
-class GeoDataLatLonAltBox;
-}
-
 class MapWidget;
 class AirportQuery;
 class AirspaceQuery;
@@ -75,7 +79,10 @@ public:
   /* Get index of nearest flight plan waypoint or -1 if nothing was found nearby. */
   int getNearestRoutePointIndex(int xs, int ys, int maxDistance);
 
-  /* Update geometry after a route or scroll or map change */
+  /* Update geometry after a route or scroll or map change.
+   * Airway and airspace geometry is moved for pans in the Mercator projection and calculated in a background
+   * thread otherwise. Lookups use the geometry of the previous view until the thread has finished and the
+   * new geometry replaces it. The index is only cleared if the layer is not shown. */
   void updateRouteScreenGeometry(const Marble::GeoDataLatLonAltBox& curBox);
   void updateAirwayScreenGeometry(const Marble::GeoDataLatLonAltBox& curBox);
   void updateAirspaceScreenGeometry(const Marble::GeoDataLatLonAltBox& curBox);
@@ -157,32 +164,41 @@ public:
 
   const atools::fs::sc::SimConnectUserAircraft& getUserAircraft()
   {
-    return simData.getUserAircraftConst();
+    return userAircraft;
   }
 
   const atools::fs::sc::SimConnectUserAircraft& getLastUserAircraft()
   {
-    return lastSimData.getUserAircraftConst();
+    return lastUserAircraft;
   }
 
   const QVector<atools::fs::sc::SimConnectAircraft>& getAiAircraft()
   {
-    return simData.getAiAircraftConst();
+    return traffic.getAircraft();
+  }
+
+  /* AI and multiplayer aircraft and ships with spatial index and interpolated positions */
+  const TrafficStore& getTraffic() const
+  {
+    return traffic;
   }
 
-  void updateSimData(const atools::fs::sc::SimConnectData& data)
+  TrafficStore& getTraffic()
   {
-    simData = data;
+    return traffic;
   }
 
+  /* Keeps user aircraft and merges AI into the traffic store */
+  void updateSimData(const atools::fs::sc::SimConnectData& data);
+
   bool isUserAircraftValid() const
   {
-    return simData.getUserAircraftConst().getPosition().isValid();
+    return userAircraft.getPosition().isValid();
   }
 
   void updateLastSimData(const atools::fs::sc::SimConnectData& data)
   {
-    lastSimData = data;
+    lastUserAircraft = data.getUserAircraftConst();
   }
 
   const proc::MapProcedureLegs& getProcedureHighlight() const
@@ -226,13 +242,80 @@ private:
   void getNearestHighlights(int xs, int ys, int maxDistance, map::MapSearchResult& result);
   void getNearestProcedureHighlights(int xs, int ys, int maxDistance, map::MapSearchResult& result,
                                      QList<proc::MapProcedurePoint>* procPoints);
-  void updateAirspaceScreenGeometry(QList<std::pair<int, QPolygon> >& polygons, AirspaceQuery *query,
-                                    const Marble::GeoDataLatLonAltBox& curBox);
+  /* View parameters for which airway or airspace screen geometry was calculated */
+  struct GeometryView
+  {
+    int projection = -1, radius = 0;
+    double centerLon = 0., centerLat = 0.; /* Radians */
+    QSize size;
+
+    bool operator==(const GeometryView& other) const;
+
+    bool operator!=(const GeometryView& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  /* Airway segment to project in the background thread */
+  struct AirwayGeometryInput
+  {
+    int id;
+    atools::geo::Pos from, to;
+    float distanceMeter, numSegments;
+  };
+
+  /* Airway segments in screen coordinates for a view. Contains all segments up to one screen size outside
+   * of the view to allow moving. */
+  struct AirwayGeometry
+  {
+    GeometryView view;
+    uint checksum = 0;
+    QList<std::pair<int, QLine> > lines;
+  };
+
+  /* Airspace polygons in screen coordinates for a view. Polygons are not clipped to allow moving. */
+  struct AirspaceGeometry
+  {
+    GeometryView view;
+    uint checksum = 0;
+    QList<std::pair<int, QPolygon> > polygons, polygonsOnline;
+  };
+
+  /* Get airspaces and geometry from the query and add them to input */
+  void collectAirspaceGeometryInput(QVector<std::pair<int, atools::geo::LineString> >& input, uint& checksum,
+                                    AirspaceQuery *query, const Marble::GeoDataLatLonAltBox& curBox);
+
+  /* Copy geometry into the index lists and grids and move it by offset to the current view */
+  void publishAirwayGeometry(const QPoint& offset);
+  void publishAirspaceGeometry(const QPoint& offset);
+  void publishAirspaceGeometry(const QList<std::pair<int, QPolygon> >& from, QList<std::pair<int, QPolygon> >& to,
+                               ScreenGrid& grid, const QPoint& offset);
+
+  GeometryView currentGeometryView() const;
+
+  /* true if geometry for view "from" can be used for view "to" by moving it. offset is set to the needed distance. */
+  static bool canMoveGeometry(const GeometryView& from, const GeometryView& to, QPoint& offset);
+
+  /* Project pos into the screen described by view. Does not use any Marble object so it can be used in the
+   * background threads. Supports the Mercator and the spherical projection. Returns false if hidden. */
+  static bool wToSGeometry(const GeometryView& view, const atools::geo::Pos& pos, int& x, int& y);
+
+  /* Called in background thread */
+  static AirwayGeometry calculateAirwayGeometry(GeometryView view, uint checksum,
+                                                QVector<AirwayGeometryInput> input);
+  static AirspaceGeometry calculateAirspaceGeometry(GeometryView view, uint checksum,
+                                                    QVector<std::pair<int, atools::geo::LineString> > input,
+                                                    QVector<std::pair<int, atools::geo::LineString> > inputOnline);
+  void getNearestAirspaces(int xs, int ys, const QList<std::pair<int, QPolygon> >& polygons,
+                           const ScreenGrid& grid, AirspaceQuery *query, map::MapSearchResult& result);
 
   template<typename TYPE>
   int getNearestIndex(int xs, int ys, int maxDistance, const QList<TYPE>& typeList);
 
-  atools::fs::sc::SimConnectData simData, lastSimData;
+  atools::fs::sc::SimConnectUserAircraft userAircraft, lastUserAircraft;
+  TrafficStore traffic;
   MapWidget *mapWidget;
   MapQuery *mapQuery;
   AirspaceQuery *airspaceQuery;
@@ -266,6 +349,21 @@ private:
   QList<std::pair<int, QPolygon> > airspacePolygonsOnline;
   QList<std::pair<int, QPoint> > routePoints;
 
+  /* Buckets of indexes into the lists above for faster lookup */
+  ScreenGrid airwayGrid, airspaceGrid, airspaceGridOnline;
+
+  /* Last calculated airway and airspace geometry which is reused for pans */
+  AirwayGeometry airwayGeometry;
+  AirspaceGeometry airspaceGeometry;
+
+  /* Background calculation of airway and airspace geometry. The update is repeated for the last requested
+   * view once the thread has finished. */
+  QFuture<AirwayGeometry> airwayFuture;
+  QFutureWatcher<AirwayGeometry> airwayWatcher;
+  QFuture<AirspaceGeometry> airspaceFuture;
+  QFutureWatcher<AirspaceGeometry> airspaceWatcher;
+  Marble::GeoDataLatLonAltBox lastAirwayBox, lastAirspaceBox;
+
 };
 
 #endif // LITTLENAVMAP_MAPSCREENINDEX_H
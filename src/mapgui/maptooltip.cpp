@@ -39,6 +39,7 @@ MapTooltip::MapTooltip(MainWindow *parentWindow)
   : mainWindow(parentWindow), mapQuery(NavApp::getMapQuery()), weather(NavApp::getWeatherReporter())
 {
   qDebug() << Q_FUNC_INFO;
+  htmlCache.setMaxCost(MAX_CACHED_TEXTS);
 }
 
 MapTooltip::~MapTooltip()
@@ -140,11 +141,13 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
       if(!html.isEmpty())
         html.hr();
 
-      map::WeatherContext currentWeatherContext;
-
       html.p();
-      mainWindow->buildWeatherContextForTooltip(currentWeatherContext, airport);
-      info.airportText(airport, currentWeatherContext, html, &route);
+      appendCached(html, info, map::AIRPORT, airport.id, [this, &info, &airport, &route](HtmlBuilder& text)
+      {
+        map::WeatherContext currentWeatherContext;
+        mainWindow->buildWeatherContextForTooltip(currentWeatherContext, airport);
+        info.airportText(airport, currentWeatherContext, text, &route);
+      }, airport.position, airport.magvar);
       html.pEnd();
       numEntries++;
     }
@@ -176,7 +179,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.vorText(vor, html);
+      appendCached(html, info, map::VOR, vor.id, [&info, &vor](HtmlBuilder& text)
+      {
+        info.vorText(vor, text);
+      }, vor.position, vor.magvar);
       html.pEnd();
       numEntries++;
     }
@@ -190,7 +196,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.ndbText(ndb, html);
+      appendCached(html, info, map::NDB, ndb.id, [&info, &ndb](HtmlBuilder& text)
+      {
+        info.ndbText(ndb, text);
+      }, ndb.position, ndb.magvar);
       html.pEnd();
       numEntries++;
     }
@@ -204,7 +213,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.waypointText(wp, html);
+      appendCached(html, info, map::WAYPOINT, wp.id, [&info, &wp](HtmlBuilder& text)
+      {
+        info.waypointText(wp, text);
+      }, wp.position, wp.magvar);
       html.pEnd();
       numEntries++;
     }
@@ -218,7 +230,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.markerText(m, html);
+      appendCached(html, info, map::MARKER, m.id, [&info, &m](HtmlBuilder& text)
+      {
+        info.markerText(m, text);
+      });
       html.pEnd();
       numEntries++;
     }
@@ -249,7 +264,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.parkingText(p, html);
+      appendCached(html, info, map::PARKING, p.id, [&info, &p](HtmlBuilder& text)
+      {
+        info.parkingText(p, text);
+      });
       html.pEnd();
       numEntries++;
     }
@@ -262,7 +280,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.helipadText(p, html);
+      appendCached(html, info, map::HELIPAD, p.id, [&info, &p](HtmlBuilder& text)
+      {
+        info.helipadText(p, text);
+      });
       html.pEnd();
       numEntries++;
     }
@@ -293,7 +314,10 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
         html.hr();
 
       html.p();
-      info.airwayText(airway, html);
+      appendCached(html, info, map::AIRWAY, airway.id, [&info, &airway](HtmlBuilder& text)
+      {
+        info.airwayText(airway, text);
+      });
       html.pEnd();
       numEntries++;
     }
@@ -310,12 +334,15 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
       if(!html.isEmpty())
         html.hr();
 
-      atools::sql::SqlRecord onlineRec;
-      if(airspace.online)
-        onlineRec = NavApp::getAirspaceQueryOnline()->getAirspaceRecordById(airspace.id);
-
       html.p();
-      info.airspaceText(airspace, onlineRec, html);
+      if(airspace.online)
+        // Online airspaces are not cached since they are updated with the same id
+        info.airspaceText(airspace, NavApp::getAirspaceQueryOnline()->getAirspaceRecordById(airspace.id), html);
+      else
+        appendCached(html, info, map::AIRSPACE, airspace.id, [&info, &airspace](HtmlBuilder& text)
+        {
+          info.airspaceText(airspace, atools::sql::SqlRecord(), text);
+        });
       html.pEnd();
       numEntries++;
     }
@@ -324,6 +351,32 @@ QString MapTooltip::buildTooltip(const map::MapSearchResult& mapSearchResult,
   return html.getHtml();
 }
 
+void MapTooltip::appendCached(HtmlBuilder& html, HtmlInfoBuilder& info, map::MapObjectTypes type, int id,
+                              const std::function<void(HtmlBuilder& html)>& func, const atools::geo::Pos& pos,
+                              float magVar)
+{
+  quint64 key = (static_cast<quint64>(type) << 32) | static_cast<quint32>(id);
+  HtmlBuilder *cached = htmlCache.object(key);
+  if(cached == nullptr)
+  {
+    // Build text without the aircraft dependent parts
+    cached = new HtmlBuilder(false);
+    info.setBearingText(false);
+    func(*cached);
+    info.setBearingText(true);
+    htmlCache.insert(key, cached);
+  }
+
+  // Appending the builder also adds its number of lines for checklength()
+  html.textHtml(*cached);
+  info.bearingTextTable(pos, magVar, html);
+}
+
+void MapTooltip::clearCache()
+{
+  htmlCache.clear();
+}
+
 /* Check if the result HTML has more than the allowed number of lines and add a "more" text */
 bool MapTooltip::checkText(HtmlBuilder& html, int numEntries)
 {
@@ -332,6 +385,5 @@ bool MapTooltip::checkText(HtmlBuilder& html, int numEntries)
     html.hr().b(tr("More ..."));
     return true;
   }
-
   return html.checklength(MAX_LINES, tr("More ..."));
 }
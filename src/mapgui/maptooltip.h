@@ -18,8 +18,14 @@
 #ifndef LITTLENAVMAP_MAPTOOLTIP_H
 #define LITTLENAVMAP_MAPTOOLTIP_H
 
+#include "common/mapflags.h"
+#include "geo/pos.h"
+
 #include <QColor>
 #include <QApplication>
+#include <QCache>
+
+#include <functional>
 
 namespace map {
 struct MapSearchResult;
@@ -30,6 +36,7 @@ class MapQuery;
 class WeatherReporter;
 class Route;
 class MainWindow;
+class HtmlInfoBuilder;
 
 namespace atools {
 namespace util {
@@ -66,12 +73,29 @@ public:
                        const QList<proc::MapProcedurePoint>& procPoints, const Route& route,
                        bool airportDiagram);
 
+  /* Clear cached HTML of map objects. Needed after changes of options, weather, flight plan or database. */
+  void clearCache();
+
 private:
   bool checkText(atools::util::HtmlBuilder& html, int numEntries);
 
+  /* Append HTML for the object with the given type and id. Text is taken from the cache if available.
+   * Otherwise it is created by calling func and added to the cache. Bearing and distance to the user aircraft
+   * change all the time. These are left out of the cached text and added for pos if valid. */
+  void appendCached(atools::util::HtmlBuilder& html, HtmlInfoBuilder& info, map::MapObjectTypes type, int id,
+                    const std::function<void(atools::util::HtmlBuilder& html)>& func,
+                    const atools::geo::Pos& pos = atools::geo::Pos(), float magVar = 0.f);
+
   static Q_DECL_CONSTEXPR int MAX_LINES = 20;
   static Q_DECL_CONSTEXPR int MAX_ENTRIES = 3;
 
+  /* Number of cached object texts */
+  static Q_DECL_CONSTEXPR int MAX_CACHED_TEXTS = 500;
+
+  /* HTML of map objects keyed by type in the upper and database id in the lower 32 bits.
+   * Builders are kept to have the line count available when appending. */
+  QCache<quint64, atools::util::HtmlBuilder> htmlCache;
+
   MainWindow *mainWindow = nullptr;
   MapQuery *mapQuery;
   WeatherReporter *weather;
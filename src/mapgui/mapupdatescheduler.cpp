@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapupdatescheduler.h"
+
+#include <QWidget>
+
+MapUpdateScheduler::MapUpdateScheduler(QWidget *widgetParam)
+  : QObject(widgetParam), widget(widgetParam)
+{
+  flushTimer.setSingleShot(true);
+  connect(&flushTimer, &QTimer::timeout, this, &MapUpdateScheduler::flush);
+  lastFlush.start();
+}
+
+MapUpdateScheduler::~MapUpdateScheduler()
+{
+  flushTimer.stop();
+}
+
+void MapUpdateScheduler::setMaxFramesPerSecond(int fps)
+{
+  maxFramesPerSecond = fps;
+}
+
+void MapUpdateScheduler::requestFullUpdate()
+{
+  fullUpdate = true;
+  dirtyRegion = QRegion();
+  scheduleFlush();
+}
+
+void MapUpdateScheduler::requestUpdate(const QRect& rect)
+{
+  if(fullUpdate)
+    // Already covered
+    return;
+
+  QRect clipped = rect.intersected(widget->rect());
+  if(clipped.isEmpty())
+    return;
+
+  dirtyRegion += clipped;
+  scheduleFlush();
+}
+
+void MapUpdateScheduler::cancel()
+{
+  flushTimer.stop();
+  fullUpdate = false;
+  dirtyRegion = QRegion();
+}
+
+void MapUpdateScheduler::painted(const QRect& rect)
+{
+  // The paint event used the current state - pending requests within its area are done
+  if(fullUpdate)
+  {
+    if(rect.contains(widget->rect()))
+      cancel();
+  }
+  else if(!dirtyRegion.isEmpty())
+  {
+    dirtyRegion -= rect;
+    if(dirtyRegion.isEmpty())
+      cancel();
+  }
+}
+
+void MapUpdateScheduler::scheduleFlush()
+{
+  if(flushTimer.isActive())
+    // Merged into the pending frame
+    return;
+
+  int minIntervalMs = maxFramesPerSecond > 0 ? 1000 / maxFramesPerSecond : 0;
+  qint64 elapsedMs = lastFlush.elapsed();
+  flushTimer.start(elapsedMs >= minIntervalMs ? 0 : static_cast<int>(minIntervalMs - elapsedMs));
+}
+
+void MapUpdateScheduler::flush()
+{
+  if(fullUpdate)
+    widget->update();
+  else if(!dirtyRegion.isEmpty())
+    widget->update(dirtyRegion);
+
+  fullUpdate = false;
+  dirtyRegion = QRegion();
+  lastFlush.restart();
+}
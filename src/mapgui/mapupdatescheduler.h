@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_MAPUPDATESCHEDULER_H
+#define LITTLENAVMAP_MAPUPDATESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QRegion>
+#include <QTimer>
+
+class QWidget;
+
+/*
+ * Collects repaint requests for the map widget from simulator, online, weather and flight plan updates
+ * and passes them on with a limited frame rate.
+ *
+ * Requests can be for the whole widget or for a dirty region only. Regions are merged until the next
+ * frame is due. A full request overrides all regions.
+ *
+ * Note that a region update still runs all map painters. It only limits the area which is drawn and
+ * flushed to the screen by clipping.
+ */
+class MapUpdateScheduler :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  MapUpdateScheduler(QWidget *widgetParam);
+  virtual ~MapUpdateScheduler();
+
+  /* Repaint whole widget with the next frame */
+  void requestFullUpdate();
+
+  /* Repaint only the given rectangle with the next frame. Painters still run but are clipped to the region. */
+  void requestUpdate(const QRect& rect);
+
+  /* Drop all pending requests */
+  void cancel();
+
+  /* Has to be called on each paint event. Removes pending requests which are covered by the painted area. */
+  void painted(const QRect& rect);
+
+  /* Maximum number of frames per second from options. Values below one disable the limit. */
+  void setMaxFramesPerSecond(int fps);
+
+  int getMaxFramesPerSecond() const
+  {
+    return maxFramesPerSecond;
+  }
+
+private:
+  void flush();
+  void scheduleFlush();
+
+  QWidget *widget;
+  QTimer flushTimer;
+
+  /* Time since last frame was sent */
+  QElapsedTimer lastFlush;
+
+  QRegion dirtyRegion;
+  bool fullUpdate = false;
+  int maxFramesPerSecond = 20;
+};
+
+#endif // LITTLENAVMAP_MAPUPDATESCHEDULER_H
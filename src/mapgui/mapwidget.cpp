@@ -23,6 +23,7 @@
 #include "mapgui/mappaintlayer.h"
 #include "settings/settings.h"
 #include "common/elevationprovider.h"
+#include "common/elevationservice.h"
 #include "gui/mainwindow.h"
 #include "mapgui/mapscale.h"
 #include "geo/calculations.h"
@@ -41,6 +42,7 @@
 #include "common/symbolpainter.h"
 #include "mapgui/mapscreenindex.h"
 #include "mapgui/mapvisible.h"
+#include "mapgui/mapupdatescheduler.h"
 #include "ui_mainwindow.h"
 #include "gui/actiontextsaver.h"
 #include "util/htmlbuilder.h"
@@ -77,6 +79,15 @@ const int ALTITUDE_UPDATE_TIMEOUT = 200;
 // Delay recognition to avoid detection of bumps
 const int TAKEOFF_LANDING_TIMEOUT = 5000;
 
+// Collect tooltip events while the mouse moves and build only the text for the last position
+const int TOOLTIP_UPDATE_TIMEOUT = 30;
+
+// Repaint interval for interpolated AI and multiplayer vehicles
+const int TRAFFIC_ANIMATION_TIMEOUT = 200;
+
+/* Added to the dirty rectangles of user aircraft and wind pointer to catch changing label widths */
+const int DIRTY_RECT_MARGIN = 16;
+
 /* If width and height of a bounding rect are smaller than this use show point */
 const float POS_IS_POINT_EPSILON = 0.0001f;
 
@@ -169,6 +180,19 @@ MapWidget::MapWidget(MainWindow *parent)
   takeoffLandingTimer.setSingleShot(true);
   connect(&takeoffLandingTimer, &QTimer::timeout, this, &MapWidget::takeoffLandingTimeout);
 
+  progressiveRenderTimer.setSingleShot(true);
+  connect(&progressiveRenderTimer, &QTimer::timeout, this, &MapWidget::progressiveRenderTimeout);
+
+  tooltipTimer.setInterval(TOOLTIP_UPDATE_TIMEOUT);
+  tooltipTimer.setSingleShot(true);
+  connect(&tooltipTimer, &QTimer::timeout, this, &MapWidget::tooltipTimeout);
+
+  trafficAnimationTimer.setInterval(TRAFFIC_ANIMATION_TIMEOUT);
+  connect(&trafficAnimationTimer, &QTimer::timeout, this, &MapWidget::trafficAnimationTimeout);
+
+  updateScheduler = new MapUpdateScheduler(this);
+  updateScheduler->setMaxFramesPerSecond(OptionData::instance().getSimMaxFramesPerSecond());
+
   mapVisible = new MapVisible(paintLayer);
 }
 
@@ -176,6 +200,10 @@ MapWidget::~MapWidget()
 {
   elevationDisplayTimer.stop();
   takeoffLandingTimer.stop();
+  progressiveRenderTimer.stop();
+  tooltipTimer.stop();
+  trafficAnimationTimer.stop();
+  updateScheduler->cancel();
 
   qDebug() << Q_FUNC_INFO << "removeEventFilter";
   removeEventFilter(this);
@@ -268,11 +296,19 @@ void MapWidget::optionsChanged()
 {
   screenSearchDistance = OptionData::instance().getMapClickSensitivity();
   screenSearchDistanceTooltip = OptionData::instance().getMapTooltipSensitivity();
+  updateScheduler->setMaxFramesPerSecond(OptionData::instance().getSimMaxFramesPerSecond());
+  mapTooltip->clearCache();
 
   // Updated sun shadow and force a tile refresh by changing the show status again
   setSunShadingDimFactor(static_cast<double>(OptionData::instance().getDisplaySunShadingDimFactor()) / 100.);
   setShowSunShading(showSunShading());
 
+  // Units or other route texts might have changed
+  paintLayer->routeChanged();
+
+  // Elevation data path might have changed
+  paintLayer->terrainChanged();
+
   // reloadMap();
   updateCacheSizes();
   update();
@@ -349,6 +385,7 @@ void MapWidget::updateMapObjectsShown()
   // Display types which are not used in structs
   setShowMapFeaturesDisplay(map::AIRPORT_WEATHER, ui->actionMapShowAirportWeather->isChecked());
   setShowMapFeaturesDisplay(map::MINIMUM_ALTITUDE, ui->actionMapShowMinimumAltitude->isChecked());
+  setShowMapFeaturesDisplay(map::TERRAIN_SHADING, ui->actionMapShowTerrainShading->isChecked());
 
   // Force addon airport independent of other settings or not
   setShowMapFeatures(map::AIRPORT_ADDON, ui->actionMapShowAddonAirports->isChecked());
@@ -403,7 +440,7 @@ void MapWidget::updateSunShadingOption()
 void MapWidget::weatherUpdated()
 {
   if(paintLayer->getShownMapObjects() | map::AIRPORT_WEATHER)
-    update();
+    updateScheduler->requestFullUpdate();
 }
 
 map::MapWeatherSource MapWidget::getMapWeatherSource() const
@@ -500,6 +537,8 @@ void MapWidget::preDatabaseLoad()
   jumpBackToAircraftCancel();
   cancelDragAll();
   databaseLoadStatus = true;
+  hideTooltip();
+  mapTooltip->clearCache();
   paintLayer->preDatabaseLoad();
 }
 
@@ -783,9 +822,10 @@ void MapWidget::restoreState()
     kmlFilePaths = s.valueStrList(lnm::MAP_KMLFILES);
   screenIndex->restoreState();
 
+  // Set capacity first to avoid truncating the loaded track to the default size
+  aircraftTrack.setMaxTrackEntries(OptionData::instance().getAircraftTrackMaxPoints());
   if(OptionData::instance().getFlags() & opts::STARTUP_LOAD_TRAIL)
     aircraftTrack.restoreState();
-  aircraftTrack.setMaxTrackEntries(OptionData::instance().getAircraftTrackMaxPoints());
 
   atools::gui::WidgetState state(lnm::MAP_OVERLAY_VISIBLE, false /*save visibility*/, true /*block signals*/);
   for(QAction *action : mapOverlays.values())
@@ -1244,11 +1284,15 @@ void MapWidget::routeChanged(bool geometryChanged)
 {
   qDebug() << Q_FUNC_INFO;
 
+  // Texts might have changed too
+  paintLayer->routeChanged();
+  mapTooltip->clearCache();
+
   if(geometryChanged)
   {
     cancelDragAll();
     screenIndex->updateRouteScreenGeometry(currentViewBoundingBox);
-    update();
+    updateScheduler->requestFullUpdate();
   }
 }
 
@@ -1261,7 +1305,7 @@ void MapWidget::routeAltitudeChanged(float altitudeFeet)
 
   qDebug() << Q_FUNC_INFO;
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
-  update();
+  updateScheduler->requestFullUpdate();
 }
 
 bool MapWidget::isCenterLegAndAircraftActive()
@@ -1352,12 +1396,17 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   curPosVisible = widgetRectSmall.contains(curPoint);
 
   bool wasEmpty = aircraftTrack.isEmpty();
+
+  // Start of the track segment which is added by this update
+  Pos lastTrackPos = wasEmpty ? Pos() : aircraftTrack.last().pos;
 #ifdef DEBUG_INFORMATION_DISABLED
   qDebug() << "curPos" << curPos;
   qDebug() << "widgetRectSmall" << widgetRectSmall;
 #endif
 
-  if(aircraftTrack.appendTrackPos(aircraft.getPosition(), aircraft.getZuluTime(), aircraft.isOnGround()))
+  bool trackPruned = aircraftTrack.appendTrackPos(aircraft.getPosition(), aircraft.getZuluTime(),
+                                                  aircraft.isOnGround());
+  if(trackPruned)
     emit aircraftTrackPruned();
 
   if(wasEmpty != aircraftTrack.isEmpty())
@@ -1395,23 +1444,12 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
     {
       lastSimUpdateMs = now;
 
-      // Check if any AI aircraft are visible
+      // Check if any AI aircraft are visible - uses the spatial index of the traffic store
       bool aiVisible = false;
       if(paintLayer->getShownMapObjects() & map::AIRCRAFT_AI ||
          paintLayer->getShownMapObjects() & map::AIRCRAFT_AI_SHIP ||
          paintLayer->getShownMapObjects() & map::AIRCRAFT_ONLINE)
-      {
-        for(const atools::fs::sc::SimConnectAircraft& ai : simulatorData.getAiAircraftConst())
-        {
-          if(currentViewBoundingBox.contains(
-               Marble::GeoDataCoordinates(ai.getPosition().getLonX(), ai.getPosition().getLatY(), 0,
-                                          Marble::GeoDataCoordinates::Degree)))
-          {
-            aiVisible = true;
-            break;
-          }
-        }
-      }
+        aiVisible = screenIndex->getTraffic().hasVehicles(currentViewBoundingBox);
 
       // Check if position has changed significantly
       bool posHasChanged = !last.isValid() || // No previous position
@@ -1547,9 +1585,43 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
       if(!updatesEnabled())
         setUpdatesEnabled(true);
 
+      int activeLeg = NavApp::getRouteConst().getActiveLegIndex();
       if((dataHasChanged || aiVisible) && !contextMenuActive)
+      {
         // Not scrolled or zoomed but needs a redraw
-        update();
+        QRect aircraftRect = paintLayer->getUserAircraftRect();
+
+        if(aiVisible || trackPruned || activeLeg != lastSimUpdateActiveLeg || !aircraftRect.isValid() ||
+           paintLayer->getShownMapObjects() & map::COMPASS_ROSE)
+          // Vehicles, route or compass rose change too - redraw all
+          updateScheduler->requestFullUpdate();
+        else
+        {
+          // Only user aircraft, its track and wind pointer changed - limit redraw to old and new aircraft position
+          QRect oldRect = aircraftRect.adjusted(-DIRTY_RECT_MARGIN, -DIRTY_RECT_MARGIN,
+                                                DIRTY_RECT_MARGIN, DIRTY_RECT_MARGIN);
+          updateScheduler->requestUpdate(oldRect);
+          updateScheduler->requestUpdate(oldRect.translated(curPoint - paintLayer->getUserAircraftPoint()));
+
+          // New track segment from the last track point to the aircraft can be outside of both rectangles
+          int xs, ys;
+          if(paintLayer->getShownMapObjects() & map::AIRCRAFT_TRACK && lastTrackPos.isValid() &&
+             conv.wToS(lastTrackPos, xs, ys))
+            updateScheduler->requestUpdate(QRect(QPoint(xs, ys), curPoint).normalized().
+                                           adjusted(-DIRTY_RECT_MARGIN, -DIRTY_RECT_MARGIN,
+                                                    DIRTY_RECT_MARGIN, DIRTY_RECT_MARGIN));
+
+          QRect windRect = paintLayer->getWindPointerRect();
+          if(windRect.isValid())
+            updateScheduler->requestUpdate(windRect.adjusted(-DIRTY_RECT_MARGIN, -DIRTY_RECT_MARGIN,
+                                                             DIRTY_RECT_MARGIN, DIRTY_RECT_MARGIN));
+        }
+      }
+      lastSimUpdateActiveLeg = activeLeg;
+
+      // Move visible vehicles smoothly until the next packet arrives
+      if(aiVisible && screenIndex->getTraffic().isInterpolating(now) && !trafficAnimationTimer.isActive())
+        trafficAnimationTimer.start();
     }
   }
   else if(paintLayer->getShownMapObjects() & map::AIRCRAFT_TRACK)
@@ -1560,7 +1632,7 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
       screenIndex->updateLastSimData(simulatorData);
 
       if(!contextMenuActive)
-        update();
+        updateScheduler->requestFullUpdate();
     }
   }
 }
@@ -2687,9 +2759,7 @@ void MapWidget::contextMenuEvent(QContextMenuEvent *event)
       emit showApproaches(*airport);
     else if(action == ui->actionMapUserdataAdd)
     {
-      if(NavApp::getElevationProvider()->isGlobeOfflineProvider())
-        pos.setAltitude(atools::geo::meterToFeet(NavApp::getElevationProvider()->getElevationMeter(pos)));
-      emit addUserpointFromMap(result, pos);
+      addUserpointWithElevation(result, pos);
     }
     else if(action == ui->actionMapUserdataEdit)
       emit editUserpointFromMap(result);
@@ -2877,13 +2947,54 @@ void MapWidget::elevationDisplayTimerTimeout()
   {
     if(geoCoordinates(point.x(), point.y(), lon, lat, GeoDataCoordinates::Degree))
     {
-      Pos pos(lon, lat);
-      pos.setAltitude(NavApp::getElevationProvider()->getElevationMeter(pos));
-      mainWindow->updateMapPosLabel(pos, point.x(), point.y());
+      // Label is updated in elevationsAvailable
+      ElevationService *service = NavApp::getElevationService();
+      service->cancelRequest(elevationDisplayRequestId);
+      elevationDisplayPoint = point;
+      elevationDisplayRequestId = service->requestElevation(Pos(lon, lat));
     }
   }
 }
 
+void MapWidget::addUserpointWithElevation(const map::MapSearchResult& result, const atools::geo::Pos& pos)
+{
+  if(NavApp::getElevationProvider()->isGlobeOfflineProvider())
+  {
+    // Dialog is opened in elevationsAvailable
+    ElevationService *service = NavApp::getElevationService();
+    service->cancelRequest(userpointRequestId);
+    userpointRequestResult = result;
+    userpointRequestId = service->requestElevation(pos);
+  }
+  else
+    emit addUserpointFromMap(result, pos);
+}
+
+void MapWidget::elevationUpdateAvailable()
+{
+  paintLayer->terrainChanged();
+  updateScheduler->requestFullUpdate();
+}
+
+void MapWidget::elevationsAvailable(quint64 requestId, const atools::geo::LineString& elevations)
+{
+  if(elevations.isEmpty())
+    return;
+
+  if(requestId == elevationDisplayRequestId)
+  {
+    elevationDisplayRequestId = 0L;
+    mainWindow->updateMapPosLabel(elevations.first(), elevationDisplayPoint.x(), elevationDisplayPoint.y());
+  }
+  else if(requestId == userpointRequestId)
+  {
+    userpointRequestId = 0L;
+    Pos pos = elevations.first();
+    pos.setAltitude(atools::geo::meterToFeet(pos.getAltitude()));
+    emit addUserpointFromMap(userpointRequestResult, pos);
+  }
+}
+
 bool MapWidget::eventFilter(QObject *obj, QEvent *e)
 {
   bool jumpBackWasActive = false;
@@ -2978,7 +3089,12 @@ bool MapWidget::eventFilter(QObject *obj, QEvent *e)
     if(geoCoordinates(mouseEvent->pos().x(), mouseEvent->pos().y(), lon, lat, GeoDataCoordinates::Degree))
     {
       if(NavApp::getElevationProvider()->isGlobeOfflineProvider())
+      {
+        // Result for the previous cursor position is not needed anymore
+        NavApp::getElevationService()->cancelRequest(elevationDisplayRequestId);
+        elevationDisplayRequestId = 0L;
         elevationDisplayTimer.start();
+      }
       mainWindow->updateMapPosLabel(Pos(lon, lat, static_cast<double>(map::INVALID_ALTITUDE_VALUE)),
                                     mouseEvent->pos().x(), mouseEvent->pos().y());
     }
@@ -3360,9 +3476,7 @@ bool MapWidget::mousePressCheckModifierActions(QMouseEvent *event)
         emit editUserpointFromMap(result);
       else
       {
-        if(NavApp::getElevationProvider()->isGlobeOfflineProvider())
-          pos.setAltitude(atools::geo::meterToFeet(NavApp::getElevationProvider()->getElevationMeter(pos)));
-        emit addUserpointFromMap(result, pos);
+        addUserpointWithElevation(result, pos);
       }
     }
     else if(event->modifiers() == Qt::ControlModifier || event->modifiers() == Qt::AltModifier)
@@ -3706,12 +3820,15 @@ const QList<map::TrafficPattern>& MapWidget::getTrafficPatterns() const
 
 void MapWidget::hideTooltip()
 {
+  tooltipTimer.stop();
   QToolTip::hideText();
   tooltipPos = QPoint();
 }
 
 void MapWidget::updateTooltip()
 {
+  // Weather or aircraft changed - texts have to be rebuilt
+  mapTooltip->clearCache();
   showTooltip(true /* update */);
 }
 
@@ -3746,6 +3863,11 @@ const QVector<atools::fs::sc::SimConnectAircraft>& MapWidget::getAiAircraft() co
   return screenIndex->getAiAircraft();
 }
 
+const TrafficStore& MapWidget::getTraffic() const
+{
+  return screenIndex->getTraffic();
+}
+
 void MapWidget::deleteAircraftTrack()
 {
   aircraftTrack.clearTrack();
@@ -3759,18 +3881,11 @@ bool MapWidget::event(QEvent *event)
   {
     QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
 
-    // Load tooltip data into mapSearchResultTooltip
-    mapSearchResultTooltip = map::MapSearchResult();
-    procPointsTooltip.clear();
-    screenIndex->getAllNearest(helpEvent->pos().x(), helpEvent->pos().y(), screenSearchDistanceTooltip,
-                               mapSearchResultTooltip, &procPointsTooltip);
-    NavApp::getOnlinedataController()->filterOnlineShadowAircraft(mapSearchResultTooltip.onlineAircraft,
-                                                                  mapSearchResultTooltip.aiAircraft);
-
+    // Remember position and build the tooltip after a short delay - restarting the timer drops
+    // all requests for positions the mouse has already left
+    tooltipLocalPos = helpEvent->pos();
     tooltipPos = helpEvent->globalPos();
-
-    // Build HTML
-    showTooltip(false /* update */);
+    tooltipTimer.start();
     event->accept();
     return true;
   }
@@ -3787,6 +3902,9 @@ void MapWidget::paintEvent(QPaintEvent *paintEvent)
     return;
   }
 
+  // Drop pending scheduled updates which are covered by this paint event
+  updateScheduler->painted(paintEvent->rect());
+
   bool changed = false;
   const GeoDataLatLonAltBox visibleLatLonAltBox = viewport()->viewLatLonAltBox();
 
@@ -3808,6 +3926,9 @@ void MapWidget::paintEvent(QPaintEvent *paintEvent)
     changed = true;
   }
 
+  // Use the same interpolated vehicle positions for all painters and the following tooltip lookups
+  screenIndex->getTraffic().setInterpolationTimeMs(QDateTime::currentMSecsSinceEpoch());
+
   MarbleWidget::paintEvent(paintEvent);
 
   if(changed)
@@ -3921,14 +4042,55 @@ void MapWidget::setMapDetail(int factor)
 void MapWidget::onlineClientAndAtcUpdated()
 {
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
-  update();
+  updateScheduler->requestFullUpdate();
 }
 
 void MapWidget::onlineNetworkChanged()
 {
   screenIndex->resetAirspaceOnlineScreenGeometry();
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
-  update();
+  updateScheduler->requestFullUpdate();
+}
+
+void MapWidget::startProgressiveRenderTimer(int delayMs)
+{
+  progressiveRenderTimer.start(delayMs);
+}
+
+void MapWidget::tooltipTimeout()
+{
+  if(tooltipPos.isNull())
+    return;
+
+  // Load tooltip data into mapSearchResultTooltip
+  mapSearchResultTooltip = map::MapSearchResult();
+  procPointsTooltip.clear();
+  screenIndex->getAllNearest(tooltipLocalPos.x(), tooltipLocalPos.y(), screenSearchDistanceTooltip,
+                             mapSearchResultTooltip, &procPointsTooltip);
+  NavApp::getOnlinedataController()->filterOnlineShadowAircraft(mapSearchResultTooltip.onlineAircraft,
+                                                                mapSearchResultTooltip.aiAircraft);
+
+  // Build HTML
+  showTooltip(false /* update */);
+}
+
+void MapWidget::trafficAnimationTimeout()
+{
+  bool interpolating = screenIndex->getTraffic().isInterpolating(QDateTime::currentMSecsSinceEpoch());
+
+  // Do not disturb user interaction - a final update puts vehicles on the last packet position
+  if(mouseState == mw::NONE && viewContext() == Marble::Still && !contextMenuActive && !databaseLoadStatus)
+    updateScheduler->requestFullUpdate();
+
+  if(!interpolating)
+    trafficAnimationTimer.stop();
+}
+
+void MapWidget::progressiveRenderTimeout()
+{
+  // Ignore if the map was moved in the meantime - will be restarted after moving
+  if(viewContext() == Marble::Still && paintLayer->nextProgressiveStage())
+    update();
 }
 
 void MapWidget::takeoffLandingTimeout()
@@ -54,6 +54,8 @@ class MapScreenIndex;
 class Route;
 class MapVisible;
 class JumpBack;
+class TrafficStore;
+class MapUpdateScheduler;
 
 namespace mw {
 /* State of click, drag and drop actions on the map */
@@ -230,6 +232,12 @@ public:
   /* Update map */
   void postDatabaseLoad();
 
+  /* Elevation data was loaded or changed. Drops cached terrain shading tiles. */
+  void elevationUpdateAvailable();
+
+  /* Results from the elevation service for cursor position display and new user points */
+  void elevationsAvailable(quint64 requestId, const atools::geo::LineString& elevations);
+
   /* Set map theme.
    * @param theme filename of the map theme
    * @param index MapThemeComboIndex
@@ -282,6 +290,9 @@ public:
 
   const QVector<atools::fs::sc::SimConnectAircraft>& getAiAircraft() const;
 
+  /* AI and multiplayer vehicles with spatial index and interpolated positions */
+  const TrafficStore& getTraffic() const;
+
   MainWindow *getParentWindow() const
   {
     return mainWindow;
@@ -353,6 +364,19 @@ public:
   /* Create json document with coordinates for AviTab configuration */
   QString createAvitabJson();
 
+  /* Called by the paint layer to schedule the next detail pass for progressive rendering */
+  void startProgressiveRenderTimer(int delayMs);
+
+  MapPaintLayer *getMapPaintLayer() const
+  {
+    return paintLayer;
+  }
+
+  MapUpdateScheduler *getUpdateScheduler() const
+  {
+    return updateScheduler;
+  }
+
 signals:
   /* Emitted whenever the result exceeds the limit clause in the queries */
   void resultTruncated(int truncatedTo);
@@ -445,6 +469,9 @@ private:
   void elevationDisplayTimerTimeout();
   void cancelDragUserpoint();
 
+  /* Query elevation in background if available and emit addUserpointFromMap once done */
+  void addUserpointWithElevation(const map::MapSearchResult& result, const atools::geo::Pos& pos);
+
   void zoomInOut(bool directionIn, bool smooth);
 
   bool isCenterLegAndAircraftActive();
@@ -466,6 +493,15 @@ private:
   /* Timer for takeoff and landing recognition fired */
   void takeoffLandingTimeout();
 
+  /* Paint next progressive detail stage */
+  void progressiveRenderTimeout();
+
+  /* Delayed tooltip building for the last hovered position */
+  void tooltipTimeout();
+
+  /* Repaint while AI positions are interpolated between simulator packets */
+  void trafficAnimationTimeout();
+
   /* Internal zooming and centering. Zooms one step out to get a sharper map display if allowAdjust is true */
   void setDistanceToMap(double distance, bool allowAdjust = true);
   void centerRectOnMap(const atools::geo::Rect& rect, bool allowAdjust = true);
@@ -513,7 +549,7 @@ private:
   QPixmap userpointDragPixmap;
 
   /* Save last tooltip position. If invalid/null no tooltip will be shown */
-  QPoint tooltipPos;
+  QPoint tooltipPos, tooltipLocalPos;
   map::MapSearchResult mapSearchResultTooltip;
   QList<proc::MapProcedurePoint> procPointsTooltip;
   MapTooltip *mapTooltip;
@@ -553,14 +589,32 @@ private:
   qint64 lastSimUpdateMs = 0L;
   qint64 lastCenterAcAndWp = 0L;
   qint64 lastSimUpdateTooltipMs = 0L;
+  int lastSimUpdateActiveLeg = -1;
   bool active = false;
 
   /* Delay display of elevation display to avoid lagging mouse movements */
   QTimer elevationDisplayTimer;
 
+  /* Pending elevation service requests. 0 if none. */
+  quint64 elevationDisplayRequestId = 0L, userpointRequestId = 0L;
+  QPoint elevationDisplayPoint;
+  map::MapSearchResult userpointRequestResult;
+
   /* Delay takeoff and landing messages to avoid false recognition of bumpy landings */
   QTimer takeoffLandingTimer;
 
+  /* Triggers the next detail pass for progressive rendering */
+  QTimer progressiveRenderTimer;
+
+  /* Coalesces tooltip events while hovering */
+  QTimer tooltipTimer;
+
+  /* Animates AI and multiplayer vehicles between simulator packets */
+  QTimer trafficAnimationTimer;
+
+  /* Coalesces repaint requests and limits the frame rate */
+  MapUpdateScheduler *updateScheduler = nullptr;
+
   /* Simulator zulu time timestamp of takeoff event */
   qint64 takeoffTimeMs = 0L;
 
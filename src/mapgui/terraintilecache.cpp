@@ -0,0 +1,366 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/terraintilecache.h"
+
+#include "navapp.h"
+#include "common/constants.h"
+#include "common/elevationprovider.h"
+#include "settings/settings.h"
+#include "options/optiondata.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+const float METER_PER_DEGREE = 111319.5f;
+
+/* Maximum elevation covered by the color table */
+const float TINT_MAX_ELEVATION_METER = 8800.f;
+
+/* Opacity of land in tiles */
+const int TILE_ALPHA = 170;
+
+/* Light from north west at 45 degree altitude as east, north and up components */
+const float LIGHT_X = -0.5f, LIGHT_Y = 0.5f, LIGHT_Z = 0.7071f;
+
+struct TintStop
+{
+  float elevationMeter;
+  int red, green, blue;
+};
+
+const TintStop TINT_STOPS[] =
+{
+  {0.f, 112, 160, 96},
+  {300.f, 150, 185, 110},
+  {800.f, 200, 200, 130},
+  {1500.f, 200, 170, 110},
+  {2500.f, 170, 130, 95},
+  {3500.f, 150, 120, 110},
+  {5000.f, 235, 235, 235},
+  {8800.f, 255, 255, 255}
+};
+
+/* Elevation colors interpolated between stops for 256 steps up to TINT_MAX_ELEVATION_METER */
+const std::array<QRgb, 256>& tintTable()
+{
+  static const std::array<QRgb, 256> table = []() -> std::array<QRgb, 256>
+  {
+    std::array<QRgb, 256> colors;
+    int numStops = static_cast<int>(sizeof(TINT_STOPS) / sizeof(TintStop));
+    for(int i = 0; i < 256; i++)
+    {
+      float elevation = i * TINT_MAX_ELEVATION_METER / 255.f;
+      int stop = 1;
+      while(stop < numStops - 1 && TINT_STOPS[stop].elevationMeter < elevation)
+        stop++;
+
+      const TintStop& s1 = TINT_STOPS[stop - 1], & s2 = TINT_STOPS[stop];
+      float f = std::min(std::max((elevation - s1.elevationMeter) / (s2.elevationMeter - s1.elevationMeter), 0.f), 1.f);
+      colors[static_cast<size_t>(i)] = qRgb(static_cast<int>(s1.red + (s2.red - s1.red) * f),
+                                            static_cast<int>(s1.green + (s2.green - s1.green) * f),
+                                            static_cast<int>(s1.blue + (s2.blue - s1.blue) * f));
+    }
+    return colors;
+  }();
+  return table;
+}
+
+}
+
+// ======= Key  ===============================================================
+uint qHash(const TerrainTileCache::Key& key)
+{
+  return static_cast<uint>(key.x) ^ (static_cast<uint>(key.y) << 12) ^ (static_cast<uint>(key.zoom) << 26);
+}
+
+// ======= TerrainTileCache ===============================================================
+TerrainTileCache::TerrainTileCache(const std::function<void()>& tilesAvailableCallback)
+  : tileCache(CACHE_SIZE_KB), tilesAvailable(tilesAvailableCallback)
+{
+  updateCacheDir();
+  startCleanup();
+
+  QObject::connect(&buildWatcher, &QFutureWatcher<BuildResult>::finished, [this]()
+  {
+    bool added = false;
+    if(!discardResults)
+    {
+      for(const BuildResult& result : buildFuture.results())
+      {
+        if(result.saved)
+          numSavedTiles++;
+
+        queuedKeys.remove(result.key);
+        if(!result.image.isNull() && !tileCache.contains(result.key))
+        {
+          tileCache.insert(result.key, new QImage(result.image), result.image.byteCount() / 1024);
+          added = true;
+        }
+      }
+    }
+    discardResults = false;
+
+    if(added && tilesAvailable)
+      tilesAvailable();
+
+    if(numSavedTiles >= CLEANUP_SAVED_TILES)
+    {
+      numSavedTiles = 0;
+      startCleanup();
+    }
+
+    // Continue with jobs queued in the meantime
+    startJobs();
+  });
+}
+
+TerrainTileCache::~TerrainTileCache()
+{
+  buildWatcher.disconnect();
+  buildFuture.cancel();
+  buildFuture.waitForFinished();
+  cleanupFuture.waitForFinished();
+}
+
+void TerrainTileCache::clear()
+{
+  tileCache.clear();
+  pendingJobs.clear();
+  queuedKeys.clear();
+
+  if(buildFuture.isRunning())
+    discardResults = true;
+  generation.ref();
+
+  QString oldCacheDir = cacheDir;
+  updateCacheDir();
+  if(cacheDir != oldCacheDir)
+    // Remove tiles of the previous elevation data
+    startCleanup();
+}
+
+void TerrainTileCache::startCleanup()
+{
+  if(!cleanupFuture.isRunning())
+    cleanupFuture = QtConcurrent::run(&TerrainTileCache::cleanupDiskCache, baseDir, cacheDir);
+}
+
+void TerrainTileCache::cleanupDiskCache(const QString& baseDir, const QString& currentDir)
+{
+  // Remove tiles of other format versions or elevation data paths
+  QString currentPath = QFileInfo(currentDir).absoluteFilePath();
+  for(const QFileInfo& dirInfo : QDir(baseDir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+  {
+    if(dirInfo.absoluteFilePath() != currentPath)
+    {
+      qInfo() << Q_FUNC_INFO << "Removing terrain tiles in" << dirInfo.absoluteFilePath();
+      QDir(dirInfo.absoluteFilePath()).removeRecursively();
+    }
+  }
+
+  // Collect size of all tiles
+  QFileInfoList files;
+  qint64 size = 0L;
+  QDirIterator it(currentDir, {"*.png"}, QDir::Files, QDirIterator::Subdirectories);
+  while(it.hasNext())
+  {
+    it.next();
+    files.append(it.fileInfo());
+    size += it.fileInfo().size();
+  }
+
+  qint64 maxSize = MAX_DISK_CACHE_MB * 1024L * 1024L;
+  if(size > maxSize)
+  {
+    // Delete oldest tiles first
+    std::sort(files.begin(), files.end(), [](const QFileInfo& file1, const QFileInfo& file2) -> bool
+    {
+      return file1.lastModified() < file2.lastModified();
+    });
+
+    qint64 targetSize = maxSize * 8 / 10;
+    int numRemoved = 0;
+    for(const QFileInfo& file : files)
+    {
+      if(size <= targetSize)
+        break;
+
+      if(QFile::remove(file.absoluteFilePath()))
+      {
+        size -= file.size();
+        numRemoved++;
+      }
+    }
+    qInfo() << Q_FUNC_INFO << "Removed" << numRemoved << "terrain tiles from" << currentDir;
+  }
+}
+
+void TerrainTileCache::updateCacheDir()
+{
+  QByteArray pathHash = QCryptographicHash::hash(OptionData::instance().getOfflineElevationPath().toUtf8(),
+                                                 QCryptographicHash::Md5).toHex();
+
+  baseDir = atools::settings::Settings::getPath() + QDir::separator() + lnm::TERRAIN_TILE_DIR;
+  cacheDir = baseDir + QDir::separator() + QString("v%1_%2").arg(FORMAT_VERSION).arg(QString::fromLatin1(pathHash));
+}
+
+const QImage *TerrainTileCache::getCachedTile(int zoom, int x, int y) const
+{
+  return tileCache.object({zoom, x, y});
+}
+
+const QImage *TerrainTileCache::getTile(int zoom, int x, int y)
+{
+  Key key = {zoom, x, y};
+  const QImage *image = tileCache.object(key);
+  if(image == nullptr && !queuedKeys.contains(key))
+  {
+    queuedKeys.insert(key);
+    pendingJobs.append(key);
+    startJobs();
+  }
+  return image;
+}
+
+void TerrainTileCache::startJobs()
+{
+  if(pendingJobs.isEmpty() || buildFuture.isRunning())
+    return;
+
+  QString dir = cacheDir;
+  const QAtomicInt *gen = &generation;
+  int jobGeneration = generation.load();
+  std::function<BuildResult(const Key&)> func = [dir, gen, jobGeneration](const Key& key) -> BuildResult
+                                                {
+                                                  return buildTile(key, dir, gen, jobGeneration);
+                                                };
+
+  buildFuture = QtConcurrent::mapped(pendingJobs, func);
+  buildWatcher.setFuture(buildFuture);
+  pendingJobs.clear();
+}
+
+TerrainTileCache::BuildResult TerrainTileCache::buildTile(const Key& key, const QString& cacheDir,
+                                                          const QAtomicInt *generation, int jobGeneration)
+{
+  QString dir = cacheDir + QDir::separator() + QString::number(key.zoom);
+  QString filename = dir + QDir::separator() + QString("%1_%2.png").arg(key.x).arg(key.y);
+
+  // Try disk cache first
+  QImage image(filename);
+  if(image.width() == TILE_SIZE && image.height() == TILE_SIZE)
+    return {key, image.convertToFormat(QImage::Format_ARGB32_Premultiplied), false};
+
+  image = calculateTile(key);
+  bool saved = false;
+
+  // Elevation data might have changed since the job was started
+  if(!image.isNull() && generation->load() == jobGeneration)
+  {
+    if(QDir().mkpath(dir) && image.save(filename, "PNG"))
+      saved = true;
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot save" << filename;
+  }
+  return {key, image, saved};
+}
+
+QImage TerrainTileCache::calculateTile(const Key& key)
+{
+  // Grid with one extra row and column around the tile to get gradients at the borders
+  const int stride = TILE_SIZE + 2;
+  float degree = static_cast<float>(tileDegree(key.zoom));
+  float cell = degree / TILE_SIZE;
+  float west = -180.f + key.x * degree, north = 90.f - key.y * degree;
+
+  // Sample pixel centers in structure of arrays layout
+  QVector<float> lonX(stride * stride), latY(stride * stride), elevation(stride * stride);
+  for(int row = 0; row < stride; row++)
+  {
+    float lat = std::min(std::max(north - (row - 0.5f) * cell, -90.f), 90.f);
+    for(int col = 0; col < stride; col++)
+    {
+      lonX[row * stride + col] = west + (col - 0.5f) * cell;
+      latY[row * stride + col] = lat;
+    }
+  }
+
+  if(!NavApp::getElevationProvider()->getElevations(elevation.data(), lonX.constData(), latY.constData(),
+                                                    stride * stride))
+    return QImage();
+
+  // Vertical exaggeration to make relief visible in coarse tiles
+  float exaggeration = 8.f / (key.zoom + 1);
+  const std::array<QRgb, 256>& tints = tintTable();
+
+  QImage image(TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied);
+  float brightness[TILE_SIZE];
+  for(int row = 0; row < TILE_SIZE; row++)
+  {
+    const float *above = elevation.constData() + row * stride;
+    const float *center = above + stride;
+    const float *below = center + stride;
+
+    float lat = north - (row + 0.5f) * cell;
+    float factorX = exaggeration / (2.f * cell * METER_PER_DEGREE *
+                                    std::max(std::cos(lat * 0.0174532925f), 0.01f));
+    float factorY = exaggeration / (2.f * cell * METER_PER_DEGREE);
+
+    // Lambert hillshade from central differences - kept free of branches to allow vectorization
+    for(int col = 0; col < TILE_SIZE; col++)
+    {
+      float dzdx = (center[col + 2] - center[col]) * factorX;
+      float dzdy = (above[col + 1] - below[col + 1]) * factorY;
+      float shade = (-dzdx * LIGHT_X - dzdy * LIGHT_Y + LIGHT_Z) / std::sqrt(dzdx * dzdx + dzdy * dzdy + 1.f);
+
+      // Flat terrain keeps the tint color
+      brightness[col] = std::min(std::max(0.35f + 0.65f * shade / LIGHT_Z, 0.f), 1.2f);
+    }
+
+    QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(row));
+    for(int col = 0; col < TILE_SIZE; col++)
+    {
+      float elev = center[col + 1];
+      if(elev > 0.f)
+      {
+        QRgb tint = tints[static_cast<size_t>(std::min(elev / TINT_MAX_ELEVATION_METER * 255.f, 255.f))];
+
+        // Premultiplied alpha
+        float f = brightness[col] * TILE_ALPHA / 255.f;
+        line[col] = qRgba(std::min(static_cast<int>(qRed(tint) * f), TILE_ALPHA),
+                          std::min(static_cast<int>(qGreen(tint) * f), TILE_ALPHA),
+                          std::min(static_cast<int>(qBlue(tint) * f), TILE_ALPHA),
+                          TILE_ALPHA);
+      }
+      else
+        // Sea is transparent
+        line[col] = 0;
+    }
+  }
+  return image;
+}
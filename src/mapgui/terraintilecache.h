@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_TERRAINTILECACHE_H
+#define LITTLENAVMAP_TERRAINTILECACHE_H
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QSet>
+
+#include <functional>
+
+/*
+ * Caches terrain shading tiles which combine hypsometric tints with a hillshade computed from the offline
+ * GLOBE elevation data.
+ *
+ * Tiles use an equirectangular grid where zoom level 0 has 4 x 2 tiles of 90 degree. Each further level
+ * halves the tile size. Tiles are loaded from the disk cache or calculated in the thread pool when first
+ * requested and saved to the disk cache as PNG files.
+ *
+ * The disk cache is limited in size by deleting the oldest tiles. Directories of other format versions or
+ * elevation data are deleted at startup.
+ *
+ * Not thread safe. Use only from the main thread.
+ */
+class TerrainTileCache
+{
+public:
+  /* tilesAvailable is called in the main thread when new tiles were added to the cache */
+  TerrainTileCache(const std::function<void()>& tilesAvailableCallback);
+  ~TerrainTileCache();
+
+  /* Get tile from the cache. Queues the tile for loading or calculation and returns null if not available yet. */
+  const QImage *getTile(int zoom, int x, int y);
+
+  /* Get tile from the cache only. Returns null if not available. */
+  const QImage *getCachedTile(int zoom, int x, int y) const;
+
+  /* Clear memory cache and drop all queued background work. Also selects the disk cache directory
+   * for the current elevation data path. */
+  void clear();
+
+  /* Size of a tile in degree for zoom level */
+  static double tileDegree(int zoom)
+  {
+    return 90. / (1 << zoom);
+  }
+
+  static int numColumns(int zoom)
+  {
+    return 4 << zoom;
+  }
+
+  static int numRows(int zoom)
+  {
+    return 2 << zoom;
+  }
+
+  /* Tile size in pixel */
+  static Q_DECL_CONSTEXPR int TILE_SIZE = 256;
+
+  /* Level 5 tiles have about the resolution of the GLOBE data */
+  static Q_DECL_CONSTEXPR int MAX_ZOOM = 5;
+
+private:
+  struct Key
+  {
+    int zoom, x, y;
+
+    bool operator==(const TerrainTileCache::Key& other) const
+    {
+      return zoom == other.zoom && x == other.x && y == other.y;
+    }
+
+  };
+
+  friend uint qHash(const TerrainTileCache::Key& key);
+
+  struct BuildResult
+  {
+    Key key;
+    QImage image; /* Null if elevation data is not available */
+    bool saved; /* Newly calculated and saved to disk cache */
+  };
+
+  /* Runs in the thread pool. Loads tile from disk or calculates and saves it. The tile is not saved if
+   * generation differs from jobGeneration, i.e. the elevation data changed in the meantime. */
+  static BuildResult buildTile(const Key& key, const QString& cacheDir, const QAtomicInt *generation,
+                               int jobGeneration);
+
+  /* Runs in the thread pool. Removes all directories in baseDir except currentDir and deletes the oldest
+   * tiles in currentDir if the size exceeds MAX_DISK_CACHE_MB. */
+  static void cleanupDiskCache(const QString& baseDir, const QString& currentDir);
+  void startCleanup();
+
+  /* Calculate hillshade and tints for a tile. Returns a null image if elevation data is not available. */
+  static QImage calculateTile(const Key& key);
+
+  /* Start background threads for all pending jobs if not already running */
+  void startJobs();
+
+  /* Disk cache directory is separated by format version and elevation data path */
+  void updateCacheDir();
+
+  /* Increase if the tile calculation or color table changes to avoid loading outdated tiles from disk */
+  static Q_DECL_CONSTEXPR int FORMAT_VERSION = 1;
+
+  /* Disk cache is reduced to 80 percent of this size if exceeded */
+  static Q_DECL_CONSTEXPR qint64 MAX_DISK_CACHE_MB = 512;
+
+  /* Check disk cache size again after this number of tiles were saved */
+  static Q_DECL_CONSTEXPR int CLEANUP_SAVED_TILES = 256;
+
+  /* Tiles take 256 KB each */
+  static Q_DECL_CONSTEXPR int CACHE_SIZE_KB = 64 * 1024;
+
+  QCache<Key, QImage> tileCache;
+
+  /* Jobs waiting for the background threads and keys in progress to avoid duplicates */
+  QVector<Key> pendingJobs;
+  QSet<Key> queuedKeys;
+
+  QFuture<BuildResult> buildFuture;
+  QFutureWatcher<BuildResult> buildWatcher;
+
+  QFuture<void> cleanupFuture;
+  int numSavedTiles = 0;
+
+  /* Set by clear() to drop the results of running threads */
+  bool discardResults = false;
+
+  /* Incremented by clear() to avoid saving tiles calculated from old data into the new directory or vice versa */
+  QAtomicInt generation;
+
+  std::function<void()> tilesAvailable;
+  QString baseDir, cacheDir;
+};
+
+#endif // LITTLENAVMAP_TERRAINTILECACHE_H
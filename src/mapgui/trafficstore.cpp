@@ -0,0 +1,193 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/trafficstore.h"
+
+#include <marble/GeoDataLatLonBox.h>
+
+#include <cmath>
+
+using atools::fs::sc::SimConnectAircraft;
+using atools::geo::Pos;
+using Marble::GeoDataCoordinates;
+
+void TrafficStore::clear()
+{
+  aircraft.clear();
+  tracks.clear();
+  grid.clear();
+  interpolationEndMs = 0L;
+}
+
+void TrafficStore::update(const QVector<SimConnectAircraft>& aircraftList, qint64 timestampMs)
+{
+  // Implicitly shared - no copy
+  aircraft = aircraftList;
+  grid.clear();
+  interpolationEndMs = 0L;
+
+  QHash<int, Track> newTracks;
+  newTracks.reserve(aircraft.size());
+
+  for(int i = 0; i < aircraft.size(); i++)
+  {
+    const SimConnectAircraft& ac = aircraft.at(i);
+    const Pos& pos = ac.getPosition();
+
+    Track track;
+    track.endPos = track.startPos = pos;
+    track.startMs = timestampMs;
+
+    QHash<int, Track>::const_iterator it = tracks.constFind(ac.getObjectId());
+    if(it != tracks.constEnd() && pos.isValid() && it->endPos.isValid() &&
+       timestampMs - it->startMs < MAX_INTERPOLATION_MS &&
+       pos.distanceSimpleTo(it->endPos) < MAX_INTERPOLATION_DEG)
+    {
+      // Known vehicle - continue from the currently displayed position and use the last
+      // packet interval as the time to reach the new position
+      track.startPos = interpolatedPos(*it, timestampMs);
+      track.durationMs = timestampMs - it->startMs;
+
+      if(track.startPos != track.endPos)
+        interpolationEndMs = std::max(interpolationEndMs, track.startMs + track.durationMs);
+    }
+    newTracks.insert(ac.getObjectId(), track);
+
+    if(pos.isValid())
+      grid[cellForPos(pos)].append(i);
+  }
+
+  // Vehicles not in the packet are dropped
+  tracks.swap(newTracks);
+}
+
+Pos TrafficStore::interpolatedPos(const Track& track, qint64 timestampMs)
+{
+  if(track.durationMs <= 0L || timestampMs >= track.startMs + track.durationMs)
+    return track.endPos;
+  else if(timestampMs <= track.startMs)
+    return track.startPos;
+
+  float fraction = static_cast<float>(timestampMs - track.startMs) / static_cast<float>(track.durationMs);
+
+  // Take the short way across the anti-meridian
+  float deltaLon = track.endPos.getLonX() - track.startPos.getLonX();
+  if(deltaLon > 180.f)
+    deltaLon -= 360.f;
+  else if(deltaLon < -180.f)
+    deltaLon += 360.f;
+
+  float lonX = track.startPos.getLonX() + deltaLon * fraction;
+  if(lonX > 180.f)
+    lonX -= 360.f;
+  else if(lonX < -180.f)
+    lonX += 360.f;
+
+  return Pos(lonX,
+             track.startPos.getLatY() + (track.endPos.getLatY() - track.startPos.getLatY()) * fraction,
+             track.startPos.getAltitude() + (track.endPos.getAltitude() - track.startPos.getAltitude()) * fraction);
+}
+
+int TrafficStore::cellForPos(const Pos& pos)
+{
+  int row = static_cast<int>(std::floor((pos.getLatY() + 90.f) / CELL_SIZE_DEG));
+  int col = static_cast<int>(std::floor((pos.getLonX() + 180.f) / CELL_SIZE_DEG));
+  row = std::min(std::max(row, 0), NUM_ROWS - 1);
+  col = (col % NUM_COLUMNS + NUM_COLUMNS) % NUM_COLUMNS;
+  return row * NUM_COLUMNS + col;
+}
+
+template<typename FUNC>
+void TrafficStore::forEachIndex(const Marble::GeoDataLatLonBox& box, FUNC func) const
+{
+  // Rows and columns including a margin of one cell for interpolated positions
+  int rowStart = static_cast<int>(std::floor((box.south(GeoDataCoordinates::Degree) + 90.) / CELL_SIZE_DEG)) - 1;
+  int rowEnd = static_cast<int>(std::floor((box.north(GeoDataCoordinates::Degree) + 90.) / CELL_SIZE_DEG)) + 1;
+  rowStart = std::max(rowStart, 0);
+  rowEnd = std::min(rowEnd, NUM_ROWS - 1);
+
+  int colStart = static_cast<int>(std::floor((box.west(GeoDataCoordinates::Degree) + 180.) / CELL_SIZE_DEG)) - 1;
+  int colEnd = static_cast<int>(std::floor((box.east(GeoDataCoordinates::Degree) + 180.) / CELL_SIZE_DEG)) + 1;
+  if(box.crossesDateLine())
+    colEnd += NUM_COLUMNS;
+
+  int numCols = colEnd - colStart + 1;
+  if(numCols >= NUM_COLUMNS)
+  {
+    colStart = 0;
+    numCols = NUM_COLUMNS;
+  }
+  colStart = (colStart % NUM_COLUMNS + NUM_COLUMNS) % NUM_COLUMNS;
+
+  if(numCols * (rowEnd - rowStart + 1) > grid.size())
+  {
+    // Box covers more cells than there are occupied ones - check all occupied
+    for(QHash<int, QVector<int> >::const_iterator it = grid.constBegin(); it != grid.constEnd(); ++it)
+    {
+      int row = it.key() / NUM_COLUMNS, col = it.key() % NUM_COLUMNS;
+      if(row >= rowStart && row <= rowEnd && (col - colStart + NUM_COLUMNS) % NUM_COLUMNS < numCols)
+      {
+        for(int index : it.value())
+        {
+          if(!func(index))
+            return;
+        }
+      }
+    }
+  }
+  else
+  {
+    for(int row = rowStart; row <= rowEnd; row++)
+    {
+      for(int c = 0; c < numCols; c++)
+      {
+        QHash<int, QVector<int> >::const_iterator it = grid.constFind(row * NUM_COLUMNS + (colStart + c) % NUM_COLUMNS);
+        if(it != grid.constEnd())
+        {
+          for(int index : it.value())
+          {
+            if(!func(index))
+              return;
+          }
+        }
+      }
+    }
+  }
+}
+
+void TrafficStore::getVehicles(QVector<Vehicle>& vehicles, const Marble::GeoDataLatLonBox& box) const
+{
+  forEachIndex(box, [this, &vehicles](int index) -> bool
+  {
+    const SimConnectAircraft *ac = &aircraft.at(index);
+    QHash<int, Track>::const_iterator it = tracks.constFind(ac->getObjectId());
+    vehicles.append({ac, it != tracks.constEnd() ? interpolatedPos(*it, interpolationTimeMs) : ac->getPosition()});
+    return true;
+  });
+}
+
+bool TrafficStore::hasVehicles(const Marble::GeoDataLatLonBox& box) const
+{
+  bool found = false;
+  forEachIndex(box, [this, &box, &found](int index) -> bool
+  {
+    const Pos& pos = aircraft.at(index).getPosition();
+    found = box.contains(GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0., GeoDataCoordinates::Degree));
+    return !found;
+  });
+  return found;
+}
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2019 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_TRAFFICSTORE_H
+#define LITTLENAVMAP_TRAFFICSTORE_H
+
+#include "fs/sc/simconnectaircraft.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace Marble {
+class GeoDataLatLonBox;
+}
+
+/*
+ * Keeps the AI and multiplayer aircraft and ships of the last simulator packets.
+ *
+ * Packets are merged by object id and all vehicles are kept in a geographic grid to allow
+ * visibility checks and lookups which depend only on the number of vehicles in the view.
+ *
+ * Positions are interpolated between the last two packets for drawing. The displayed position
+ * lags one packet behind which avoids jumps when a new packet arrives.
+ */
+class TrafficStore
+{
+public:
+  /* Vehicle with interpolated position */
+  struct Vehicle
+  {
+    const atools::fs::sc::SimConnectAircraft *aircraft;
+    atools::geo::Pos position;
+  };
+
+  /* Merge the aircraft of a new packet. Aircraft not in the packet are removed. */
+  void update(const QVector<atools::fs::sc::SimConnectAircraft>& aircraftList, qint64 timestampMs);
+
+  void clear();
+
+  /* Aircraft of the last packet in packet order */
+  const QVector<atools::fs::sc::SimConnectAircraft>& getAircraft() const
+  {
+    return aircraft;
+  }
+
+  /* Set time used to interpolate positions for drawing and lookups */
+  void setInterpolationTimeMs(qint64 timestampMs)
+  {
+    interpolationTimeMs = timestampMs;
+  }
+
+  /* true if any vehicle is still moving between two positions at the given time */
+  bool isInterpolating(qint64 timestampMs) const
+  {
+    return interpolationEndMs > timestampMs;
+  }
+
+  /* Get vehicles with interpolated positions in or close to the bounding box */
+  void getVehicles(QVector<Vehicle>& vehicles, const Marble::GeoDataLatLonBox& box) const;
+
+  /* true if the last position of any vehicle is within the bounding box */
+  bool hasVehicles(const Marble::GeoDataLatLonBox& box) const;
+
+private:
+  /* Vehicle moves from start to end position within duration */
+  struct Track
+  {
+    atools::geo::Pos startPos, endPos;
+    qint64 startMs = 0L, durationMs = 0L;
+  };
+
+  /* Grid cell for position */
+  static int cellForPos(const atools::geo::Pos& pos);
+
+  /* Call function for all indexes in cells overlapping the box extended by one cell.
+   * Stops if function returns false. */
+  template<typename FUNC>
+  void forEachIndex(const Marble::GeoDataLatLonBox& box, FUNC func) const;
+
+  static atools::geo::Pos interpolatedPos(const Track& track, qint64 timestampMs);
+
+  /* Size of grid cells in degree */
+  static Q_DECL_CONSTEXPR int CELL_SIZE_DEG = 1;
+  static Q_DECL_CONSTEXPR int NUM_COLUMNS = 360 / CELL_SIZE_DEG;
+  static Q_DECL_CONSTEXPR int NUM_ROWS = 180 / CELL_SIZE_DEG;
+
+  /* Do not interpolate large jumps or long gaps between packets */
+  static Q_DECL_CONSTEXPR float MAX_INTERPOLATION_DEG = 0.5f;
+  static Q_DECL_CONSTEXPR qint64 MAX_INTERPOLATION_MS = 10000L;
+
+  QVector<atools::fs::sc::SimConnectAircraft> aircraft;
+
+  /* Object id to track */
+  QHash<int, Track> tracks;
+
+  /* Cell to list of indexes in aircraft */
+  QHash<int, QVector<int> > grid;
+
+  qint64 interpolationTimeMs = 0L, interpolationEndMs = 0L;
+};
+
+#endif // LITTLENAVMAP_TRAFFICSTORE_H
@@ -29,6 +29,7 @@
 #include "gui/mainwindow.h"
 #include "route/routecontroller.h"
 #include "common/elevationprovider.h"
+#include "common/elevationservice.h"
 #include "fs/common/magdecreader.h"
 #include "fs/common/morareader.h"
 #include "common/updatehandler.h"
@@ -62,6 +63,7 @@ ConnectClient *NavApp::connectClient = nullptr;
 DatabaseManager *NavApp::databaseManager = nullptr;
 MainWindow *NavApp::mainWindow = nullptr;
 ElevationProvider *NavApp::elevationProvider = nullptr;
+ElevationService *NavApp::elevationService = nullptr;
 atools::fs::db::DatabaseMeta *NavApp::databaseMeta = nullptr;
 atools::fs::db::DatabaseMeta *NavApp::databaseMetaNav = nullptr;
 QSplashScreen *NavApp::splashScreen = nullptr;
@@ -167,6 +169,7 @@ void NavApp::init(MainWindow *mainWindowParam)
 void NavApp::initElevationProvider()
 {
   elevationProvider = new ElevationProvider(mainWindow, mainWindow->getElevationModel());
+  elevationService = new ElevationService(mainWindow, elevationProvider);
 }
 
 void NavApp::deInit()
@@ -197,6 +200,10 @@ void NavApp::deInit()
   delete connectClient;
   connectClient = nullptr;
 
+  qDebug() << Q_FUNC_INFO << "delete elevationService";
+  delete elevationService;
+  elevationService = nullptr;
+
   qDebug() << Q_FUNC_INFO << "delete elevationProvider";
   delete elevationProvider;
   elevationProvider = nullptr;
@@ -399,6 +406,16 @@ Route& NavApp::getRoute()
   return mainWindow->getRouteController()->getRoute();
 }
 
+QSharedPointer<const Route> NavApp::getRouteSnapshot()
+{
+  return mainWindow->getRouteController()->getRouteSnapshot();
+}
+
+quint64 NavApp::getRouteVersion()
+{
+  return mainWindow->getRouteController()->getRouteVersion();
+}
+
 int NavApp::getRouteSize()
 {
   return mainWindow->getRouteController()->getRoute().size();
@@ -574,6 +591,11 @@ ElevationProvider *NavApp::getElevationProvider()
   return elevationProvider;
 }
 
+ElevationService *NavApp::getElevationService()
+{
+  return elevationService;
+}
+
 WeatherReporter *NavApp::getWeatherReporter()
 {
   return mainWindow->getWeatherReporter();
@@ -23,6 +23,8 @@
 #include "common/mapflags.h"
 #include "fs/fspaths.h"
 
+#include <QSharedPointer>
+
 class AirportQuery;
 class MapQuery;
 class AirspaceQuery;
@@ -38,6 +40,7 @@ class RouteController;
 class MapWidget;
 class WeatherReporter;
 class ElevationProvider;
+class ElevationService;
 class AircraftTrack;
 class QSplashScreen;
 class UpdateHandler;
@@ -151,6 +154,10 @@ public:
   static ProcedureQuery *getProcedureQuery();
   static const Route& getRouteConst();
   static Route& getRoute();
+
+  /* Shared read only copy of the route and its version. See RouteController::getRouteSnapshot() */
+  static QSharedPointer<const Route> getRouteSnapshot();
+  static quint64 getRouteVersion();
   static int getRouteSize();
 
   static const RouteAltitude& getAltitudeLegs();
@@ -194,6 +201,9 @@ public:
 
   static ElevationProvider *getElevationProvider();
 
+  /* Asynchronous elevation queries for the main thread */
+  static ElevationService *getElevationService();
+
   static WeatherReporter *getWeatherReporter();
   static atools::fs::weather::Metar getAirportWeather(const QString& airportIcao, const atools::geo::Pos& airportPos);
   static map::MapWeatherSource getAirportWeatherSource();
@@ -278,6 +288,7 @@ private:
   static InfoQuery *infoQuery;
   static ProcedureQuery *procedureQuery;
   static ElevationProvider *elevationProvider;
+  static ElevationService *elevationService;
   static ApronGeometryCache *apronGeometryCache;
 
   /* Most important handlers */
@@ -289,7 +289,8 @@ enum MapScrollDetail
   FULL,
   HIGHER,
   NORMAL,
-  NONE
+  NONE,
+  PROGRESSIVE /* Show symbols while scrolling and add details step by step afterwards */
 };
 
 /* Speed of simualator aircraft updates */
@@ -585,12 +586,24 @@ public:
     return routeGroundBuffer;
   }
 
+  /* Terrain corridor to each side of the flight plan for the profile in the distance unit. 0 if disabled. */
+  float getRouteTerrainCorridor() const
+  {
+    return routeTerrainCorridor;
+  }
+
   /* Bounding box for aircraft updates in percent */
   int getSimUpdateBox() const
   {
     return simUpdateBox;
   }
 
+  /* Maximum map repaints per second for simulator and online updates. 0 is unlimited. */
+  int getSimMaxFramesPerSecond() const
+  {
+    return simMaxFramesPerSecond;
+  }
+
   /* Default zoom distance for point objects */
   float getMapZoomShowClick() const
   {
@@ -902,6 +915,9 @@ private:
   // ui->spinBoxOptionsMapSimUpdateBox
   int simUpdateBox = 50;
 
+  // ui->spinBoxOptionsSimMaxFps
+  int simMaxFramesPerSecond = 20;
+
   // ui->spinBoxOptionsCacheDiskSize
   int cacheSizeDisk = 2000;
 
@@ -947,6 +963,9 @@ private:
   // ui->spinBoxOptionsRouteGroundBuffer
   int routeGroundBuffer = 1000;
 
+  // ui->doubleSpinBoxOptionsRouteTerrainCorridor
+  float routeTerrainCorridor = 0.f;
+
   // comboBoxOptionsUnitDistance
   opts::UnitDist unitDist = opts::DIST_NM;
 
@@ -129,6 +129,7 @@ OptionsDialog::OptionsDialog(QMainWindow *parentWindow)
     ui->doubleSpinBoxOptionsMapZoomShowMap,
     ui->doubleSpinBoxOptionsMapZoomShowMapMenu,
     ui->spinBoxOptionsRouteGroundBuffer,
+    ui->doubleSpinBoxOptionsRouteTerrainCorridor,
     ui->labelOptionsMapRangeRings,
     ui->spinBoxDisplayOnlineClearance,
     ui->spinBoxDisplayOnlineArea,
@@ -244,6 +245,7 @@ OptionsDialog::OptionsDialog(QMainWindow *parentWindow)
   widgets.append(ui->radioButtonOptionsSimUpdateMedium);
   widgets.append(ui->checkBoxOptionsSimUpdatesConstant);
   widgets.append(ui->spinBoxOptionsSimUpdateBox);
+  widgets.append(ui->spinBoxOptionsSimMaxFps);
   widgets.append(ui->spinBoxSimMaxTrackPoints);
   widgets.append(ui->radioButtonOptionsStartupShowHome);
   widgets.append(ui->radioButtonOptionsStartupShowLast);
@@ -267,6 +269,7 @@ OptionsDialog::OptionsDialog(QMainWindow *parentWindow)
   widgets.append(ui->doubleSpinBoxOptionsMapZoomShowMap);
   widgets.append(ui->doubleSpinBoxOptionsMapZoomShowMapMenu);
   widgets.append(ui->spinBoxOptionsRouteGroundBuffer);
+  widgets.append(ui->doubleSpinBoxOptionsRouteTerrainCorridor);
 
   widgets.append(ui->spinBoxOptionsDisplayTextSizeAircraftAi);
   widgets.append(ui->spinBoxOptionsDisplaySymbolSizeNavaid);
@@ -1131,6 +1134,7 @@ void OptionsDialog::widgetsToOptionData()
 
   data.simNoFollowAircraftOnScroll = ui->spinBoxSimDoNotFollowOnScrollTime->value();
   data.simUpdateBox = ui->spinBoxOptionsSimUpdateBox->value();
+  data.simMaxFramesPerSecond = ui->spinBoxOptionsSimMaxFps->value();
   data.aircraftTrackMaxPoints = ui->spinBoxSimMaxTrackPoints->value();
 
   data.cacheSizeDisk = ui->spinBoxOptionsCacheDiskSize->value();
@@ -1150,6 +1154,7 @@ void OptionsDialog::widgetsToOptionData()
   data.mapZoomShowMenu = static_cast<float>(ui->doubleSpinBoxOptionsMapZoomShowMapMenu->value());
 
   data.routeGroundBuffer = ui->spinBoxOptionsRouteGroundBuffer->value();
+  data.routeTerrainCorridor = static_cast<float>(ui->doubleSpinBoxOptionsRouteTerrainCorridor->value());
 
   data.displayTextSizeAircraftAi = ui->spinBoxOptionsDisplayTextSizeAircraftAi->value();
   data.displaySymbolSizeNavaid = ui->spinBoxOptionsDisplaySymbolSizeNavaid->value();
@@ -1342,6 +1347,7 @@ void OptionsDialog::optionDataToWidgets()
 
   ui->spinBoxSimDoNotFollowOnScrollTime->setValue(data.simNoFollowAircraftOnScroll);
   ui->spinBoxOptionsSimUpdateBox->setValue(data.simUpdateBox);
+  ui->spinBoxOptionsSimMaxFps->setValue(data.simMaxFramesPerSecond);
   ui->spinBoxSimMaxTrackPoints->setValue(data.aircraftTrackMaxPoints);
 
   ui->spinBoxOptionsCacheDiskSize->setValue(data.cacheSizeDisk);
@@ -1359,6 +1365,7 @@ void OptionsDialog::optionDataToWidgets()
   ui->doubleSpinBoxOptionsMapZoomShowMap->setValue(data.mapZoomShowClick);
   ui->doubleSpinBoxOptionsMapZoomShowMapMenu->setValue(data.mapZoomShowMenu);
   ui->spinBoxOptionsRouteGroundBuffer->setValue(data.routeGroundBuffer);
+  ui->doubleSpinBoxOptionsRouteTerrainCorridor->setValue(data.routeTerrainCorridor);
 
   ui->spinBoxOptionsDisplayTextSizeAircraftAi->setValue(data.displayTextSizeAircraftAi);
   ui->spinBoxOptionsDisplaySymbolSizeNavaid->setValue(data.displaySymbolSizeNavaid);
@@ -43,6 +43,10 @@
 #include <QRubberBand>
 #include <QMouseEvent>
 #include <QtConcurrent/QtConcurrentRun>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <functional>
 
 #include <marble/ElevationModel.h>
 #include <marble/GeoDataCoordinates.h>
@@ -103,9 +107,16 @@ ProfileWidget::ProfileWidget(QWidget *parent)
   // Marble will let us know when updates are available
   connect(NavApp::getElevationProvider(), &ElevationProvider::updateAvailable,
           this, &ProfileWidget::elevationUpdateAvailable);
+  connect(NavApp::getElevationProvider(), &ElevationProvider::pyramidAvailable,
+          this, &ProfileWidget::elevationPyramidAvailable);
 
   // Notification from thread that it has finished and we can get the result from the future
-  connect(&watcher, &QFutureWatcher<ElevationLegList>::finished, this, &ProfileWidget::updateThreadFinished);
+  connect(&watcher, &QFutureWatcher<ElevationLegSample>::finished, this, &ProfileWidget::updateThreadFinished);
+
+  elevationLegCache.setMaxCost(ELEVATION_CACHE_POINTS);
+
+  // Consider highest terrain within this distance left and right of the flight plan
+  terrainCorridorNm = Unit::rev(OptionData::instance().getRouteTerrainCorridor(), Unit::distNmF);
 
   // Want mouse events even when no button is pressed
   setMouseTracking(true);
@@ -137,6 +148,7 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
 
   bool updateWidget = false;
   bool updateLabelWidget = false;
+  QRect updateRect;
   const Route& route = routeController->getRoute();
 
   if(!NavApp::getRouteConst().isFlightplanEmpty())
@@ -165,6 +177,12 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
         // Get point (NM/ft) for current update
         QPointF currentPoint(aircraftDistanceFromStart, simPos.getAltitude());
 
+        // Predicted path changes with each update - repaint if a conflict appears or disappears
+        updateVerticalPrediction(aircraftDistanceFromStart, simData.getUserAircraftConst());
+        if(showAircraft && (prediction.valid != paintedPrediction.valid ||
+                            prediction.hasConflict != paintedPrediction.hasConflict))
+          updateRect = predictionUpdateRect(paintedPrediction).united(predictionUpdateRect(prediction));
+
         // Add track point if delta value between last and current update is large enough
         if(simPos.isValid())
         {
@@ -178,7 +196,10 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
               aircraftTrackPoints.append(currentPoint);
 
             if(aircraftTrackPoints.size() > OptionData::instance().getAircraftTrackMaxPoints())
+            {
               aircraftTrackPoints.removeFirst();
+              trackPathValid = false;
+            }
           }
         }
 
@@ -207,14 +228,25 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
           lastAircraftDistanceFromStart = aircraftDistanceFromStart;
 
           if(simPos.getAltitude() > maxWindowAlt)
+          {
             // Scale up to keep the aircraft visible
             updateScreenCoords();
+            updateWidget = true;
+          }
+          else if(lastPos.isValid() &&
+                  (toScreen(lastPoint) - toScreen(currentPoint)).manhattanLength() < AIRCRAFT_UPDATE_HEIGHT / 2)
+          {
+            // Repaint only aircraft, track tail and prediction - background comes from the cached pixmap
+            updateRect = aircraftUpdateRect(toScreen(lastPoint)).united(aircraftUpdateRect(toScreen(currentPoint)));
+            updateRect = updateRect.united(predictionUpdateRect(paintedPrediction)).
+                         united(predictionUpdateRect(prediction));
+          }
+          else
+            updateWidget = true;
 
           // Probably center aircraft on scroll area
           if(NavApp::getMainUi()->actionProfileCenterAircraft->isChecked() && !jumpBack->isActive())
             scrollArea->centerAircraft(toScreen(currentPoint));
-
-          updateWidget = true;
         }
       } // if(route.getRouteDistances(&aircraftDistanceFromStart, &aircraftDistanceToDest))
     } // if((showAircraft || showAircraftTrack))
@@ -229,6 +261,8 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
   }
   if(updateWidget)
     update();
+  else if(!updateRect.isEmpty())
+    update(updateRect);
 
   if(updateLabelWidget)
     updateLabel();
@@ -239,6 +273,7 @@ void ProfileWidget::connectedToSimulator()
   qDebug() << Q_FUNC_INFO;
   jumpBack->cancel();
   simData = atools::fs::sc::SimConnectData();
+  clearVerticalPrediction();
   updateScreenCoords();
   update();
   updateLabel();
@@ -249,6 +284,7 @@ void ProfileWidget::disconnectedFromSimulator()
   qDebug() << Q_FUNC_INFO;
   jumpBack->cancel();
   simData = atools::fs::sc::SimConnectData();
+  clearVerticalPrediction();
   updateScreenCoords();
   update();
   updateLabel();
@@ -269,6 +305,8 @@ void ProfileWidget::updateScreenCoords()
   // Widget drawing region width and height
   int w = rect().width() - X0 * 2, h = rect().height() - Y0;
 
+  coordsRevision++;
+
   // Need scale to determine track length on screen
   horizontalScale = w / legList.totalDistance;
 
@@ -320,6 +358,33 @@ void ProfileWidget::updateScreenCoords()
 
   // Last point closing polygon
   landPolygon.append(QPoint(X0 + w, h + Y0));
+
+  // Calculate the corridor polygon - use centerline for legs without corridor
+  corridorPolygon.clear();
+  if(terrainCorridorNm > 0.f)
+  {
+    corridorPolygon.append(QPoint(X0, h + Y0));
+    for(const ElevationLeg& leg : legList.elevationLegs)
+    {
+      bool hasCorridor = !leg.corridor.isEmpty();
+      const LineString& elevation = hasCorridor ? leg.corridor : leg.elevation;
+      const QVector<float>& distances = hasCorridor ? leg.corridorDistances : leg.distances;
+
+      QPoint lastPt;
+      for(int i = 0; i < elevation.size(); i++)
+      {
+        QPoint pt(X0 + static_cast<int>(distances.at(i) * horizontalScale),
+                  Y0 + static_cast<int>(h - elevation.at(i).getAltitude() * verticalScale));
+
+        if(lastPt.isNull() || i == elevation.size() - 1 || (lastPt - pt).manhattanLength() > 2)
+        {
+          corridorPolygon.append(pt);
+          lastPt = pt;
+        }
+      }
+    }
+    corridorPolygon.append(QPoint(X0 + w, h + Y0));
+  }
 }
 
 QVector<std::pair<int, int> > ProfileWidget::calcScaleValues()
@@ -592,8 +657,9 @@ void ProfileWidget::paintEvent(QPaintEvent *)
   // Saved route that was used to create the geometry
   // const Route& route = legList.route;
 
-  // Get a copy of the active route
-  Route route = NavApp::getRoute();
+  // Get the shared copy of the active route - the copy is created only once after route changes
+  QSharedPointer<const Route> routeSnapshot = NavApp::getRouteSnapshot();
+  const Route& route = *routeSnapshot;
   const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
 
   if(legList.route.size() != route.size() ||
@@ -621,7 +687,7 @@ void ProfileWidget::paintEvent(QPaintEvent *)
     return;
   }
 
-  // Draw grey vertical lines for waypoints
+  // Check for valid altitudes
   int flightplanY = getFlightplanAltY();
   int safeAltY = getMinSafeAltitudeY();
   if(flightplanY == map::INVALID_INDEX_VALUE || safeAltY == map::INVALID_INDEX_VALUE)
@@ -630,11 +696,244 @@ void ProfileWidget::paintEvent(QPaintEvent *)
     return;
   }
 
+  // Static parts are painted into a pixmap covering the visible part of the widget and reused
+  // until size, scroll position, zoom or data change
+  BackgroundKey key = currentBackgroundKey();
+  if(!(key == backgroundKey) || backgroundPixmap.isNull())
+  {
+    qreal ratio = devicePixelRatioF();
+    backgroundPixmap = QPixmap(key.viewportSize * ratio);
+    backgroundPixmap.setDevicePixelRatio(ratio);
+    backgroundPixmap.fill(Qt::transparent);
+
+    QPainter backgroundPainter(&backgroundPixmap);
+    backgroundPainter.setFont(font());
+    backgroundPainter.translate(-key.offset);
+    paintBackground(backgroundPainter, route);
+    backgroundKey = key;
+  }
+  painter.drawPixmap(key.offset, backgroundPixmap);
+
+  paintAircraft(painter);
+
+  // Dim the map by drawing a semi-transparent black rectangle
+  mapcolors::darkenPainterRect(painter);
+
+  scrollArea->updateLabelWidget();
+}
+
+bool ProfileWidget::BackgroundKey::operator==(const ProfileWidget::BackgroundKey& other) const
+{
+  return size == other.size && viewportSize == other.viewportSize && offset == other.offset &&
+         routeVersion == other.routeVersion && coordsRevision == other.coordsRevision && ils == other.ils &&
+         vasi == other.vasi && flightplan == other.flightplan;
+}
+
+ProfileWidget::BackgroundKey ProfileWidget::currentBackgroundKey() const
+{
+  Ui::MainWindow *ui = NavApp::getMainUi();
+
+  BackgroundKey key;
+  key.size = size();
+  key.viewportSize = scrollArea->getViewport()->size();
+  key.offset = scrollArea->getOffset();
+  key.routeVersion = NavApp::getRouteVersion();
+  key.coordsRevision = coordsRevision;
+  key.ils = ui->actionProfileShowIls->isChecked();
+  key.vasi = ui->actionProfileShowVasi->isChecked();
+  key.flightplan = NavApp::getMapWidget()->getShownMapFeatures() & map::FLIGHTPLAN;
+  return key;
+}
+
+void ProfileWidget::updateTrackPath()
+{
+  if(!trackPathValid || trackPathRevision != coordsRevision || trackPathPoints > aircraftTrackPoints.size())
+  {
+    trackPath = QPainterPath();
+    trackPathPoints = 0;
+    trackPathRevision = coordsRevision;
+    trackPathValid = true;
+  }
+
+  for(int i = trackPathPoints; i < aircraftTrackPoints.size(); i++)
+  {
+    QPoint pt = toScreen(aircraftTrackPoints.at(i));
+    if(i == 0)
+    {
+      trackPath.moveTo(pt);
+      trackPathLast = pt;
+    }
+    else if((trackPathLast - pt).manhattanLength() > 3 || i == aircraftTrackPoints.size() - 1)
+    {
+      // Skip points which are too close on screen but always connect the latest one
+      trackPath.lineTo(pt);
+      trackPathLast = pt;
+    }
+  }
+  trackPathPoints = aircraftTrackPoints.size();
+}
+
+void ProfileWidget::updateTerrainProfile()
+{
+  // Collect ground and corridor points - the prediction is checked against the points of both
+  QVector<std::pair<float, float> > points;
+  for(const ElevationLeg& leg : legList.elevationLegs)
+  {
+    for(int i = 0; i < leg.elevation.size(); i++)
+      points.append(std::make_pair(leg.distances.at(i), leg.elevation.at(i).getAltitude()));
+    for(int i = 0; i < leg.corridor.size(); i++)
+      points.append(std::make_pair(leg.corridorDistances.at(i), leg.corridor.at(i).getAltitude()));
+  }
+  std::stable_sort(points.begin(), points.end(), [](const std::pair<float, float>& p1,
+                                                    const std::pair<float, float>& p2) -> bool
+  {
+    return p1.first < p2.first;
+  });
+
+  terrainDistances.clear();
+  terrainElevations.clear();
+  terrainDistances.reserve(points.size());
+  terrainElevations.reserve(points.size());
+  for(const std::pair<float, float>& point : points)
+  {
+    terrainDistances.append(point.first);
+    terrainElevations.append(point.second);
+  }
+  terrainIndex = 0;
+
+  // Climb out and approach are always close to the ground - ignore terrain near departure and destination
+  terrainCheckStart = PREDICTION_AIRPORT_EXCLUDE_NM;
+  terrainCheckEnd = legList.totalDistance - PREDICTION_AIRPORT_EXCLUDE_NM;
+
+  clearVerticalPrediction();
+}
+
+void ProfileWidget::clearVerticalPrediction()
+{
+  prediction = VerticalPrediction();
+  paintedPrediction = VerticalPrediction();
+}
+
+void ProfileWidget::updateVerticalPrediction(float distanceFromStart,
+                                             const atools::fs::sc::SimConnectUserAircraft& aircraft)
+{
+  prediction = VerticalPrediction();
+
+  float groundSpeed = aircraft.getGroundSpeedKts();
+  if(aircraft.isOnGround() || groundSpeed < PREDICTION_MIN_GROUND_SPEED_KTS || movingBackwards ||
+     terrainDistances.isEmpty() ||
+     !(distanceFromStart < map::INVALID_DISTANCE_VALUE) ||
+     !(aircraft.getVerticalSpeedFeetPerMin() < atools::fs::sc::SC_INVALID_FLOAT))
+    return;
+
+  // Feet per nautical mile
+  float slope = aircraft.getVerticalSpeedFeetPerMin() * 60.f / groundSpeed;
+  float altitude = aircraft.getPosition().getAltitude();
+  float endDistance = std::min(distanceFromStart + groundSpeed * PREDICTION_MINUTES / 60.f, legList.totalDistance);
+  if(endDistance <= distanceFromStart)
+    return;
+
+  prediction.valid = true;
+  prediction.start = QPointF(distanceFromStart, altitude);
+  prediction.end = QPointF(endDistance, altitude + (endDistance - distanceFromStart) * slope);
+
+  // Move index to the aircraft position - usually only a few steps forward from the last update
+  int size = terrainDistances.size();
+  if(terrainIndex >= size || terrainDistances.at(terrainIndex) > distanceFromStart)
+    terrainIndex = std::max(static_cast<int>(std::upper_bound(terrainDistances.constBegin(),
+                                                               terrainDistances.constEnd(), distanceFromStart) -
+                                             terrainDistances.constBegin()) - 1, 0);
+  while(terrainIndex < size - 1 && terrainDistances.at(terrainIndex + 1) <= distanceFromStart)
+    terrainIndex++;
+
+  // Find first terrain point where the predicted path is below the safe altitude
+  float checkEnd = std::min(endDistance, terrainCheckEnd);
+  for(int i = terrainIndex + 1; i < size && terrainDistances.at(i) <= checkEnd; i++)
+  {
+    float dist = terrainDistances.at(i);
+    if(dist < terrainCheckStart)
+      continue;
+
+    if(altitude + (dist - distanceFromStart) * slope < calcGroundBuffer(terrainElevations.at(i)))
+    {
+      prediction.hasConflict = true;
+      prediction.conflict = QPointF(dist, terrainElevations.at(i));
+      break;
+    }
+  }
+}
+
+void ProfileWidget::paintVerticalPrediction(QPainter& painter)
+{
+  paintedPrediction = prediction;
+  if(!prediction.valid || !showAircraft)
+    return;
+
+  QPoint start = toScreen(prediction.start);
+  painter.setBrush(Qt::NoBrush);
+  if(prediction.hasConflict)
+  {
+    // Draw path until terrain and mark conflict
+    QPoint conflict = toScreen(prediction.conflict);
+    QPen pen = mapcolors::profilePredictionPen;
+    pen.setColor(mapcolors::profileTerrainConflictColor);
+    painter.setPen(pen);
+    painter.drawLine(start, conflict);
+
+    painter.setPen(QPen(mapcolors::profileTerrainConflictColor, 3.));
+    painter.drawEllipse(conflict, 8, 8);
+
+    SymbolPainter symPainter;
+    symPainter.textBox(&painter, {tr("Terrain")}, mapcolors::profileTerrainConflictColor,
+                       conflict.x() + 10, conflict.y() - 10, textatt::BOLD | textatt::ROUTE_BG_COLOR, 255);
+  }
+  else
+  {
+    painter.setPen(mapcolors::profilePredictionPen);
+    painter.drawLine(start, toScreen(prediction.end));
+  }
+}
+
+QRect ProfileWidget::predictionUpdateRect(const VerticalPrediction& pred) const
+{
+  if(!pred.valid)
+    return QRect();
+
+  QRect rect = QRect(toScreen(pred.start), toScreen(pred.end)).normalized();
+  if(pred.hasConflict)
+    // Include conflict marker and label
+    rect = rect.united(QRect(toScreen(pred.start), toScreen(pred.conflict)).normalized());
+  return rect.adjusted(-20, -40, 100, 20);
+}
+
+QRect ProfileWidget::aircraftUpdateRect(const QPoint& point) const
+{
+  return QRect(point.x() - AIRCRAFT_UPDATE_WIDTH / 2, point.y() - AIRCRAFT_UPDATE_HEIGHT / 2,
+               AIRCRAFT_UPDATE_WIDTH, AIRCRAFT_UPDATE_HEIGHT);
+}
+
+/* Paints everything except user aircraft and track */
+void ProfileWidget::paintBackground(QPainter& painter, const Route& route)
+{
+  const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
+  int w = rect().width() - X0 * 2, h = rect().height() - Y0;
+  int flightplanY = getFlightplanAltY();
+  int safeAltY = getMinSafeAltitudeY();
+  SymbolPainter symPainter;
+
   // Fill background sky blue ====================================================
   painter.setRenderHint(QPainter::Antialiasing);
   painter.setRenderHint(QPainter::SmoothPixmapTransform);
   painter.fillRect(X0, 0, rect().width() - X0 * 2, rect().height(), mapcolors::profileSkyColor);
 
+  // Draw the highest terrain in the corridor behind the ground ===========================
+  if(!corridorPolygon.isEmpty())
+  {
+    painter.setBrush(mapcolors::profileLandCorridorColor);
+    painter.setPen(Qt::NoPen);
+    painter.drawPolygon(corridorPolygon);
+  }
+
   // Draw the ground ======================================================
   painter.setBrush(mapcolors::profileLandColor);
   painter.setPen(mapcolors::profileLandOutlinePen);
@@ -1091,13 +1390,36 @@ void ProfileWidget::paintEvent(QPaintEvent *)
                        textatt::BOLD | textatt::LEFT, 255);
   } // if(NavApp::getMapWidget()->getShownMapFeatures() & map::FLIGHTPLAN)
 
+}
+
+/* Paints user aircraft track and symbol which change with each simulator update */
+void ProfileWidget::paintAircraft(QPainter& painter)
+{
+  int w = rect().width() - X0 * 2, h = rect().height() - Y0;
+  const OptionData& optData = OptionData::instance();
+  SymbolPainter symPainter;
+
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+  QFont defaultFont = painter.font();
+  defaultFont.setBold(true);
+  painter.setFont(defaultFont);
+  mapcolors::scaleFont(&painter, 0.9f);
+  defaultFont = painter.font();
+
   // Draw user aircraft track =========================================================
   if(!aircraftTrackPoints.isEmpty() && showAircraftTrack)
   {
+    updateTrackPath();
     painter.setPen(mapcolors::aircraftTrailPen(optData.getDisplayThicknessTrail() / 100.f * 2.f));
-    painter.drawPolyline(toScreen(aircraftTrackPoints));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPath(trackPath);
   }
 
+  // Draw predicted vertical path =========================================================
+  paintVerticalPrediction(painter);
+
   // Draw user aircraft =========================================================
   if(simData.getUserAircraftConst().getPosition().isValid() && showAircraft &&
      aircraftDistanceFromStart < map::INVALID_DISTANCE_VALUE)
@@ -1154,10 +1476,6 @@ void ProfileWidget::paintEvent(QPaintEvent *)
     symPainter.textBoxF(&painter, texts, QPen(Qt::black), textx, texty, att, 255);
   }
 
-  // Dim the map by drawing a semi-transparent black rectangle
-  mapcolors::darkenPainterRect(painter);
-
-  scrollArea->updateLabelWidget();
 }
 
 /* Update signal from Marble elevation model */
@@ -1168,11 +1486,24 @@ void ProfileWidget::elevationUpdateAvailable()
 
   // Do not terminate thread here since this can lead to starving updates
 
+  // Elevation data has changed - sample all legs again
+  elevationLegCache.clear();
+  clearVerticalPrediction();
+
   // Start thread after long delay to calculate new data
   updateTimer->start(NavApp::getElevationProvider()->isGlobeOfflineProvider() ?
                      ELEVATION_CHANGE_OFFLINE_UPDATE_TIMEOUT_MS : ELEVATION_CHANGE_UPDATE_TIMEOUT_MS);
 }
 
+void ProfileWidget::elevationPyramidAvailable()
+{
+  if(!widgetVisible || databaseLoadStatus)
+    return;
+
+  // Samples are still valid - legs are taken from the cache
+  updateTimer->start(ELEVATION_CHANGE_OFFLINE_UPDATE_TIMEOUT_MS);
+}
+
 void ProfileWidget::routeAltitudeChanged(int altitudeFeet)
 {
   Q_UNUSED(altitudeFeet);
@@ -1206,6 +1537,9 @@ void ProfileWidget::routeChanged(bool geometryChanged, bool newFlightPlan)
   if(newFlightPlan)
     scrollArea->expandWidget();
 
+  // Distances along the flight plan might have changed
+  clearVerticalPrediction();
+
   if(geometryChanged)
   {
     // Start thread after short delay to calculate new data
@@ -1232,16 +1566,53 @@ void ProfileWidget::updateTimeout()
   terminateThread();
   terminateThreadSignal = false;
 
-  // Need a copy of the leg list before starting thread to avoid synchronization problems
-  // Start the computation in background
-  ElevationLegList legs;
-  legs.route = routeController->getRoute();
+  // Max and safe altitude use the pyramid if available
+  NavApp::getElevationProvider()->requestPyramid();
+
+  // Need a copy of the route before starting threads to avoid synchronization problems
+  pendingRoute = routeController->getRoute();
+  pendingRequests.clear();
+  pendingSamples.clear();
 
-  // Start thread
-  future = QtConcurrent::run(this, &ProfileWidget::fetchRouteElevationsThread, legs);
+  // Collect legs which are not in the cache
+  QSet<ElevationLegKey> requestedKeys;
+  for(int i = 1; i < pendingRoute.size(); i++)
+  {
+    if(pendingRoute.at(i).getProcedureLeg().isMissed())
+      break;
 
-  // Watcher will call updateThreadFinished when finished
-  watcher.setFuture(future);
+    ElevationLegRequest request;
+    if(elevationLegGeometry(request.geometry, pendingRoute, i))
+    {
+      request.key = elevationLegKey(request.geometry);
+      const ElevationLegSample *cached = elevationLegCache.object(request.key);
+      if(cached != nullptr)
+        // Pin sample for this route
+        pendingSamples.insert(request.key, *cached);
+      else if(!requestedKeys.contains(request.key))
+      {
+        requestedKeys.insert(request.key);
+        pendingRequests.append(request);
+      }
+    }
+  }
+
+  if(pendingRequests.isEmpty())
+    // All legs cached - no need to start threads
+    updateThreadFinished();
+  else
+  {
+    // Sample changed legs in parallel using the global thread pool
+    std::function<ElevationLegSample(const ElevationLegRequest&)> func =
+      [this](const ElevationLegRequest& request) -> ElevationLegSample
+      {
+        return fetchLegElevationsThread(request);
+      };
+    future = QtConcurrent::mapped(pendingRequests, func);
+
+    // Watcher will call updateThreadFinished when finished
+    watcher.setFuture(future);
+  }
 }
 
 /* Called by watcher when the thread is finished */
@@ -1254,8 +1625,27 @@ void ProfileWidget::updateThreadFinished()
 
   if(!terminateThreadSignal)
   {
-    // Was not terminated in the middle of calculations - get result from the future
-    legList = future.result();
+    // Was not terminated in the middle of calculations - get results from the future
+    for(int i = 0; i < pendingRequests.size(); i++)
+    {
+      const ElevationLegSample& sample = future.resultAt(i);
+      if(!sample.valid)
+      {
+        // Sampling was cancelled - keep the current profile and wait for the next update
+        pendingRequests.clear();
+        pendingSamples.clear();
+        return;
+      }
+
+      pendingSamples.insert(pendingRequests.at(i).key, sample);
+      elevationLegCache.insert(pendingRequests.at(i).key, new ElevationLegSample(sample),
+                               std::max(sample.elevation.size() + sample.corridor.size(), 1));
+    }
+    pendingRequests.clear();
+
+    legList = buildElevationLegList(pendingRoute, pendingSamples);
+    pendingSamples.clear();
+    updateTerrainProfile();
     updateScreenCoords();
     updateErrorLabel();
     updateLabel();
@@ -1266,7 +1656,7 @@ void ProfileWidget::updateThreadFinished()
 /* Get elevation points between the two points. This returns also correct results if the antimeridian is crossed
  * @return true if not aborted */
 bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations,
-                                         const atools::geo::LineString& geometry) const
+                                         const atools::geo::LineString& geometry, float corridorMeter) const
 {
   ElevationProvider *elevationProvider = NavApp::getElevationProvider();
   for(int i = 0; i < geometry.size() - 1; i++)
@@ -1294,7 +1684,10 @@ bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations,
 
         p1.toDeg();
         p2.toDeg();
-        elevationProvider->getElevations(elevations, atools::geo::Line(p1, p2));
+        if(corridorMeter > 0.f)
+          elevationProvider->getCorridorElevations(elevations, atools::geo::Line(p1, p2), corridorMeter);
+        else
+          elevationProvider->getElevations(elevations, atools::geo::Line(p1, p2));
       }
     }
     qDeleteAll(coordsCorrected);
@@ -1313,83 +1706,170 @@ bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations,
   return true;
 }
 
-/* Background thread. Fetches elevation points from Marble elevation model and updates totals. */
-ProfileWidget::ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs) const
+/* Thread pool. Samples a single leg and converts elevation to feet. */
+ProfileWidget::ElevationLegSample ProfileWidget::fetchLegElevationsThread(const ElevationLegRequest& request) const
 {
   QThread::currentThread()->setPriority(QThread::LowestPriority);
-  // qDebug() << "priority" << QThread::currentThread()->priority();
 
-  using atools::geo::meterToNm;
-  using atools::geo::meterToFeet;
+  ElevationLegSample sample;
+  if(!fetchRouteElevations(sample.elevation, request.geometry, 0.f) ||
+     !convertLegElevations(sample.elevation, sample.distances, sample.maxElevation))
+    // Terminated - return invalid result
+    return ElevationLegSample();
 
-  legs.totalNumPoints = 0;
-  legs.totalDistance = 0.f;
-  legs.maxElevationFt = 0.f;
-  legs.elevationLegs.clear();
+  if(terrainCorridorNm > 0.f && NavApp::getElevationProvider()->isMappedGlobeProvider())
+  {
+    // Highest terrain across the corridor - only for memory mapped GLOBE data
+    if(!fetchRouteElevations(sample.corridor, request.geometry, atools::geo::nmToMeter(terrainCorridorNm)) ||
+       !convertLegElevations(sample.corridor, sample.corridorDistances, sample.maxElevation))
+      return ElevationLegSample();
+  }
 
-  // Loop over all route legs
-  for(int i = 1; i < legs.route.size(); i++)
+  sample.valid = true;
+  return sample;
+}
+
+bool ProfileWidget::convertLegElevations(LineString& elevations, QVector<float>& distances,
+                                         float& maxElevation) const
+{
+  float dist = 0.f;
+  Pos lastPos;
+  for(int j = 0; j < elevations.size(); j++)
   {
     if(terminateThreadSignal)
-      // Return empty result
-      return ElevationLegList();
+      return false;
+
+    Pos& coord = elevations[j];
+    float altFeet = atools::geo::meterToFeet(coord.getAltitude());
+    coord.setAltitude(altFeet);
+
+    // Adjust maximum
+    if(altFeet > maxElevation)
+      maxElevation = altFeet;
+
+    if(j > 0)
+      // Update leg distance
+      dist += atools::geo::meterToNm(lastPos.distanceMeterTo(coord));
+
+    // Distance to elevation point from leg start
+    distances.append(dist);
+    lastPos = coord;
+  }
+  return true;
+}
+
+bool ProfileWidget::elevationLegGeometry(LineString& geometry, const Route& route, int index) const
+{
+  const RouteLeg& routeLeg = route.at(index);
+
+  // Skip for too long segments when using the marble online provider
+  if(routeLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::getElevationProvider()->isGlobeOfflineProvider())
+  {
+    if(routeLeg.isAnyProcedure() && routeLeg.getGeometry().size() > 2)
+      geometry = routeLeg.getGeometry();
+    else
+      geometry << route.at(index - 1).getPosition() << routeLeg.getPosition();
+
+    geometry.removeInvalid();
+    return true;
+  }
+  return false;
+}
+
+ProfileWidget::ElevationLegKey ProfileWidget::elevationLegKey(const LineString& geometry) const
+{
+  ElevationLegKey key;
+  key.fromLonX = key.fromLatY = key.toLonX = key.toLatY = 0.f;
+  key.geometryHash = 0;
+  key.size = geometry.size();
+
+  if(!geometry.isEmpty())
+  {
+    key.fromLonX = geometry.first().getLonX();
+    key.fromLatY = geometry.first().getLatY();
+    key.toLonX = geometry.last().getLonX();
+    key.toLatY = geometry.last().getLatY();
+
+    for(const Pos& pos : geometry)
+      key.geometryHash = key.geometryHash * 31 + (qHash(pos.getLonX()) ^ (qHash(pos.getLatY()) << 1));
+  }
+  return key;
+}
+
+bool ProfileWidget::ElevationLegKey::operator==(const ProfileWidget::ElevationLegKey& other) const
+{
+  return fromLonX == other.fromLonX && fromLatY == other.fromLatY && toLonX == other.toLonX &&
+         toLatY == other.toLatY && geometryHash == other.geometryHash && size == other.size;
+}
+
+uint qHash(const ProfileWidget::ElevationLegKey& key)
+{
+  return key.geometryHash ^ static_cast<uint>(key.size);
+}
+
+/* Concatenates sampled legs and updates totals */
+ProfileWidget::ElevationLegList ProfileWidget::buildElevationLegList(const Route& route,
+                                                                     const QHash<ElevationLegKey,
+                                                                                 ElevationLegSample>& samples) const
+{
+  using atools::geo::meterToNm;
 
-    const RouteLeg& routeLeg = legs.route.at(i);
+  ElevationLegList legs;
+  legs.route = route;
+
+  // Loop over all route legs
+  for(int i = 1; i < route.size(); i++)
+  {
+    const RouteLeg& routeLeg = route.at(i);
     if(routeLeg.getProcedureLeg().isMissed())
       break;
 
-    const RouteLeg& lastLeg = legs.route.at(i - 1);
+    const RouteLeg& lastLeg = route.at(i - 1);
     ElevationLeg leg;
 
-    // Skip for too long segments when using the marble online provider
-    if(routeLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::getElevationProvider()->isGlobeOfflineProvider())
+    LineString geometry;
+    const ElevationLegSample *sample = nullptr;
+    if(elevationLegGeometry(geometry, route, i))
     {
-      LineString geometry;
-      if(routeLeg.isAnyProcedure() && routeLeg.getGeometry().size() > 2)
-        geometry = routeLeg.getGeometry();
-      else
-        geometry << lastLeg.getPosition() << routeLeg.getPosition();
-
-      geometry.removeInvalid();
-
-      LineString elevations;
-      if(!fetchRouteElevations(elevations, geometry))
-        return ElevationLegList();
+      ElevationLegKey key = elevationLegKey(geometry);
+      auto it = samples.constFind(key);
+      sample = it != samples.constEnd() ? &it.value() : elevationLegCache.object(key);
 
-      float dist = legs.totalDistance;
-      // Loop over all elevation points for the current leg
-      Pos lastPos;
-      for(int j = 0; j < elevations.size(); j++)
+      if(sample == nullptr || !sample->valid)
       {
-        if(terminateThreadSignal)
-          return ElevationLegList();
+        // Not available - should not happen. Use a straight leg instead of dropping the whole profile.
+        qWarning() << Q_FUNC_INFO << "No elevation sample for leg" << i;
+        sample = nullptr;
+      }
+    }
 
-        Pos& coord = elevations[j];
-        float altFeet = meterToFeet(coord.getAltitude());
-        coord.setAltitude(altFeet);
+    if(sample != nullptr)
+    {
+      // Move leg distances to distances along the route
+      leg.elevation = sample->elevation;
+      leg.maxElevation = sample->maxElevation;
 
-        // Adjust maximum
-        if(altFeet > leg.maxElevation)
-          leg.maxElevation = altFeet;
-        if(altFeet > legs.maxElevationFt)
-          legs.maxElevationFt = altFeet;
+      // The pyramid also covers peaks between the sampled points
+      float pyramidElevation;
+      if(NavApp::getElevationProvider()->getMaxElevation(pyramidElevation, geometry,
+                                                         atools::geo::nmToMeter(terrainCorridorNm)))
+        leg.maxElevation = std::max(leg.maxElevation, atools::geo::meterToFeet(pyramidElevation));
 
-        leg.elevation.append(coord);
-        if(j > 0)
-          // Update total distance
-          dist += meterToNm(lastPos.distanceMeterTo(coord));
+      leg.distances.reserve(sample->distances.size() + 1);
+      for(float dist : sample->distances)
+        leg.distances.append(legs.totalDistance + dist);
 
-        // Distance to elevation point from departure
-        leg.distances.append(dist);
+      leg.corridor = sample->corridor;
+      leg.corridorDistances.reserve(sample->corridorDistances.size());
+      for(float dist : sample->corridorDistances)
+        leg.corridorDistances.append(legs.totalDistance + dist);
 
-        legs.totalNumPoints++;
-        lastPos = coord;
-      }
+      legs.maxElevationFt = std::max(legs.maxElevationFt, leg.maxElevation);
+      legs.totalNumPoints += sample->elevation.size();
 
       legs.totalDistance += routeLeg.getDistanceTo();
-      leg.elevation.append(lastPos);
+      leg.elevation.append(sample->elevation.isEmpty() ? Pos() : sample->elevation.last());
       leg.distances.append(legs.totalDistance);
-
     }
     else
     {
@@ -1706,6 +2186,7 @@ void ProfileWidget::resizeEvent(QResizeEvent *)
 void ProfileWidget::deleteAircraftTrack()
 {
   aircraftTrackPoints.clear();
+  trackPathValid = false;
 
   updateScreenCoords();
   update();
@@ -1729,6 +2210,10 @@ void ProfileWidget::postDatabaseLoad()
 
 void ProfileWidget::optionsChanged()
 {
+  // Elevation source or corridor width might have changed
+  elevationLegCache.clear();
+  terrainCorridorNm = Unit::rev(OptionData::instance().getRouteTerrainCorridor(), Unit::distNmF);
+
   jumpBack->cancel();
   updateScreenCoords();
   updateErrorLabel();
@@ -1738,6 +2223,7 @@ void ProfileWidget::optionsChanged()
 
 void ProfileWidget::styleChanged()
 {
+  backgroundPixmap = QPixmap();
   scrollArea->styleChanged();
 }
 
@@ -1793,6 +2279,7 @@ void ProfileWidget::terminateThread()
   if(future.isRunning() || future.isStarted())
   {
     terminateThreadSignal = true;
+    future.cancel();
     future.waitForFinished();
   }
 }
@@ -1870,7 +2357,10 @@ void ProfileWidget::loadAircraftTrack()
       {
         in >> version;
         if(version == FILE_VERSION)
+        {
           in >> aircraftTrackPoints;
+          trackPathValid = false;
+        }
         else
           qWarning() << "Cannot read track" << trackFile.fileName() << ". Invalid version number:" << version;
       }
@@ -21,8 +21,11 @@
 #include "route/route.h"
 #include "fs/sc/simconnectdata.h"
 
+#include <QCache>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QPainterPath>
+#include <QPixmap>
 #include <QWidget>
 
 namespace atools {
@@ -161,6 +164,8 @@ private:
     atools::geo::LineString elevation; /* Ground elevation (Pos.altitude) and position */
     QVector<float> distances; /* Distances along the route for each elevation point.
                                *  Measured from departure point. Nautical miles. */
+    atools::geo::LineString corridor; /* Highest ground elevation across the terrain corridor. Empty if not used. */
+    QVector<float> corridorDistances; /* Distances along the route for each corridor point */
     float maxElevation = 0.f; /* Max ground altitude for this leg */
   };
 
@@ -174,6 +179,36 @@ private:
     int totalNumPoints = 0; /* Number of elevation points in whole flight plan */
   };
 
+  /* Identifies the sampled geometry of a leg in the elevation cache */
+  struct ElevationLegKey
+  {
+    float fromLonX, fromLatY, toLonX, toLatY; /* Leg endpoints */
+    uint geometryHash; /* Hash over all points including procedure geometry */
+    int size; /* Number of geometry points */
+
+    bool operator==(const ElevationLegKey& other) const;
+  };
+
+  friend uint qHash(const ProfileWidget::ElevationLegKey& key);
+
+  /* Leg which has to be sampled in the background */
+  struct ElevationLegRequest
+  {
+    ElevationLegKey key;
+    atools::geo::LineString geometry;
+  };
+
+  /* Sampled leg as stored in the cache. Distances are measured from start of the leg. */
+  struct ElevationLegSample
+  {
+    atools::geo::LineString elevation; /* Ground elevation in feet */
+    QVector<float> distances;
+    atools::geo::LineString corridor; /* Highest elevation across the terrain corridor in feet */
+    QVector<float> corridorDistances;
+    float maxElevation = 0.f; /* Maximum of elevation and corridor */
+    bool valid = false; /* false if sampling was terminated */
+  };
+
   /* Show position at x ordinate on profile on the map */
   void showPosAlongFlightplan(int x, bool doubleClick);
 
@@ -187,9 +222,28 @@ private:
   virtual void mouseMoveEvent(QMouseEvent *mouseEvent) override;
   virtual void contextMenuEvent(QContextMenuEvent *event) override;
 
-  bool fetchRouteElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const;
-  ElevationLegList fetchRouteElevationsThread(ElevationLegList legs) const;
+  /* Fetch elevations along geometry or the highest elevation across the corridor if corridorMeter > 0 */
+  bool fetchRouteElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry,
+                            float corridorMeter) const;
+
+  /* Convert fetched elevations to feet and calculate distances from leg start. Returns false if terminated. */
+  bool convertLegElevations(atools::geo::LineString& elevations, QVector<float>& distances,
+                            float& maxElevation) const;
+
+  /* Samples one leg. Called in parallel from the thread pool. */
+  ElevationLegSample fetchLegElevationsThread(const ElevationLegRequest& request) const;
+
+  /* Get geometry for route leg at index. Returns false if the leg is not sampled. */
+  bool elevationLegGeometry(atools::geo::LineString& geometry, const Route& route, int index) const;
+  ElevationLegKey elevationLegKey(const atools::geo::LineString& geometry) const;
+
+  /* Build the list of legs from cache and newly sampled legs */
+  ElevationLegList buildElevationLegList(const Route& route,
+                                         const QHash<ElevationLegKey, ElevationLegSample>& samples) const;
   void elevationUpdateAvailable();
+
+  /* Maximum elevation pyramid loaded - rebuild legs from cache to update max and safe altitude */
+  void elevationPyramidAvailable();
   void updateTimeout();
   void updateThreadFinished();
   void updateScreenCoords();
@@ -220,6 +274,52 @@ private:
   void paintIls(QPainter& painter, const Route& route);
   void paintVasi(QPainter& painter, const Route& route);
 
+  /* Identifies the state used to paint the cached background pixmap */
+  struct BackgroundKey
+  {
+    QSize size, viewportSize;
+    QPoint offset; /* Scroll position */
+    quint64 routeVersion = 0, coordsRevision = 0;
+    bool ils = false, vasi = false, flightplan = false;
+
+    bool operator==(const BackgroundKey& other) const;
+  };
+
+  BackgroundKey currentBackgroundKey() const;
+
+  /* Static parts like terrain, flight plan and labels */
+  void paintBackground(QPainter& painter, const Route& route);
+
+  /* User aircraft and track */
+  void paintAircraft(QPainter& painter);
+
+  /* Append new track points to the track path or rebuild it if screen coordinates have changed */
+  void updateTrackPath();
+
+  /* Region covering aircraft symbol and label which is updated when the aircraft moves */
+  QRect aircraftUpdateRect(const QPoint& point) const;
+
+  /* Predicted vertical path of the user aircraft. x is distance from departure in NM and y altitude in ft. */
+  struct VerticalPrediction
+  {
+    QPointF start, end;
+    QPointF conflict; /* First terrain point where the path is below the safe altitude. Only valid if hasConflict. */
+    bool valid = false, hasConflict = false;
+  };
+
+  /* Merge ground and corridor elevation of all legs into terrainDistances and terrainElevations */
+  void updateTerrainProfile();
+
+  /* Calculate prediction from vertical speed and ground speed. Called for each simulator update.
+   * Terrain is checked against the safe altitude from calcGroundBuffer except near departure and destination. */
+  void updateVerticalPrediction(float distanceFromStart, const atools::fs::sc::SimConnectUserAircraft& aircraft);
+
+  /* Drop current and painted prediction after connection, flight plan or elevation changes */
+  void clearVerticalPrediction();
+
+  void paintVerticalPrediction(QPainter& painter);
+  QRect predictionUpdateRect(const VerticalPrediction& pred) const;
+
   void jumpBackToAircraftStart();
   void jumpBackToAircraftTimeout();
 
@@ -248,6 +348,9 @@ private:
   /* Do not calculate a profile for legs longer than this value */
   static Q_DECL_CONSTEXPR int ELEVATION_MAX_LEG_NM = 2000;
 
+  /* Maximum number of elevation points in the leg cache */
+  static Q_DECL_CONSTEXPR int ELEVATION_CACHE_POINTS = 1000000;
+
   /* User aircraft data */
   atools::fs::sc::SimConnectData simData, lastSimData;
 
@@ -266,12 +369,23 @@ private:
   /* Calls updateTimeout which will start the update thread in background */
   QTimer *updateTimer = nullptr;
 
-  /* Used to fetch result from thread */
-  QFuture<ElevationLegList> future;
-  /* Sends signal once thread is finished */
-  QFutureWatcher<ElevationLegList> watcher;
+  /* Used to fetch results for each requested leg from the thread pool */
+  QFuture<ElevationLegSample> future;
+  /* Sends signal once all legs are sampled */
+  QFutureWatcher<ElevationLegSample> watcher;
   bool terminateThreadSignal = false;
 
+  /* Route and legs for the running sampling */
+  Route pendingRoute;
+  QVector<ElevationLegRequest> pendingRequests;
+
+  /* Copies of all samples needed for pendingRoute. Keeps them while the cache evicts entries when inserting
+   * new ones. Copies are cheap since the geometry is implicitly shared. */
+  QHash<ElevationLegKey, ElevationLegSample> pendingSamples;
+
+  /* Sampled legs from previous calculations. Cost is number of elevation and corridor points. */
+  QCache<ElevationLegKey, ElevationLegSample> elevationLegCache;
+
   bool databaseLoadStatus = false;
 
   QRubberBand *rubberBand = nullptr;
@@ -282,10 +396,55 @@ private:
   QVector<int> waypointX; /* Flight plan waypoint screen coordinates - does contain the dummy
                            * from airport to runway but not missed legs */
   QPolygon landPolygon; /* Green landmass polygon */
+  QPolygon corridorPolygon; /* Highest terrain in corridor drawn behind landmass. Empty if not used. */
+
+  /* Cached background for the visible part of the widget */
+  QPixmap backgroundPixmap;
+  BackgroundKey backgroundKey;
+
+  /* Incremented each time the screen coordinates are updated */
+  quint64 coordsRevision = 0;
+
+  /* Screen coordinates of aircraftTrackPoints - extended while flying */
+  QPainterPath trackPath;
+  int trackPathPoints = 0;
+  quint64 trackPathRevision = 0;
+  bool trackPathValid = false;
+  QPoint trackPathLast;
+
+  /* Highest terrain along the route sorted by distance from departure. NM and ft. */
+  QVector<float> terrainDistances, terrainElevations;
+
+  /* Index into terrain arrays at or before the last aircraft position - advanced incrementally */
+  int terrainIndex = 0;
+
+  /* Terrain is checked for conflicts only between these distances from departure in NM */
+  float terrainCheckStart = 0.f, terrainCheckEnd = 0.f;
+
+  /* Current and last painted prediction */
+  VerticalPrediction prediction, paintedPrediction;
+
+  /* Look ahead time for prediction */
+  static Q_DECL_CONSTEXPR float PREDICTION_MINUTES = 5.f;
+
+  /* No prediction below this ground speed */
+  static Q_DECL_CONSTEXPR float PREDICTION_MIN_GROUND_SPEED_KTS = 30.f;
+
+  /* Terrain within this distance of departure and destination is not checked for conflicts */
+  static Q_DECL_CONSTEXPR float PREDICTION_AIRPORT_EXCLUDE_NM = 5.f;
+
+  /* Size of the region updated around the aircraft */
+  static Q_DECL_CONSTEXPR int AIRCRAFT_UPDATE_WIDTH = 320;
+  static Q_DECL_CONSTEXPR int AIRCRAFT_UPDATE_HEIGHT = 200;
+
   float minSafeAltitudeFt = 0.f, /* Red line */
         flightplanAltFt = 0.f, /* Cruise altitude */
         maxWindowAlt = 1.f; /* Maximum altitude at top of widget */
 
+  /* Terrain corridor width to each side of the flight plan. Highest terrain is shown as a band and used for
+   * the safe altitude. 0 uses only the terrain below the flight plan. */
+  float terrainCorridorNm = 0.f;
+
   ProfileScrollArea *scrollArea = nullptr;
 
   float verticalScale = 1.f /* Factor to convert altitude in feet to screen coordinates*/,
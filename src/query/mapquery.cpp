@@ -30,10 +30,13 @@
 #include "settings/settings.h"
 #include "fs/common/xpgeometry.h"
 #include "db/databasemanager.h"
+#include "common/coordinateconverter.h"
 
 #include <QDataStream>
 #include <QRegularExpression>
 
+#include <marble/ViewportParams.h>
+
 using namespace Marble;
 using namespace atools::sql;
 using namespace atools::geo;
@@ -529,109 +532,111 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
   using maptools::insertSortedByDistance;
   using maptools::insertSortedByTowerDistance;
 
-  int x, y;
+  // Invalidate all screen grids if the view has changed
+  const ViewportParams *viewport = conv.getViewport();
+  NearestGridView view;
+  view.projection = viewport->projection();
+  view.radius = viewport->radius();
+  view.centerLon = viewport->centerLongitude();
+  view.centerLat = viewport->centerLatitude();
+  view.size = viewport->size();
+
+  if(view != nearestGridView)
+  {
+    nearestGridView = view;
+    for(NearestGrid *nearest : {&airportGrid, &towerGrid, &waypointGrid, &userpointGrid, &vorGrid, &ndbGrid,
+                                &markerGrid, &ilsGrid})
+      nearest->revision = -1;
+  }
+
+  // Candidate indexes into the cache lists - already filtered by distance
+  QVector<int> indexes;
   if(mapLayer->isAirport() && types.testFlag(map::AIRPORT))
   {
-    for(int i = airportCache.list.size() - 1; i >= 0; i--)
+    updateNearestGrid(conv, airportCache, airportGrid);
+    airportGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
     {
       const MapAirport& airport = airportCache.list.at(i);
-
       if(airport.isVisible(types))
-      {
-        if(conv.wToS(airport.position, x, y))
-          if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-            insertSortedByDistance(conv, result.airports, &result.airportIds, xs, ys, airport);
+        insertSortedByDistance(conv, result.airports, &result.airportIds, xs, ys, airport);
+    }
 
-        if(airportDiagram)
-        {
-          // Include tower for airport diagrams
-          if(conv.wToS(airport.towerCoords, x, y) &&
-             atools::geo::manhattanDistance(x, y, xs, ys) < screenDistance)
-            insertSortedByTowerDistance(conv, result.towers, xs, ys, airport);
-        }
+    if(airportDiagram)
+    {
+      // Include tower for airport diagrams
+      updateNearestTowerGrid(conv);
+      towerGrid.getNearest(xs, ys, screenDistance, indexes);
+      for(int i : indexes)
+      {
+        const MapAirport& airport = airportCache.list.at(i);
+        if(airport.isVisible(types))
+          insertSortedByTowerDistance(conv, result.towers, xs, ys, airport);
       }
     }
   }
 
   if(mapLayer->isVor() && types.testFlag(map::VOR))
   {
-    for(int i = vorCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapVor& vor = vorCache.list.at(i);
-      if(conv.wToS(vor.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.vors, &result.vorIds, xs, ys, vor);
-    }
+    updateNearestGrid(conv, vorCache, vorGrid);
+    vorGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.vors, &result.vorIds, xs, ys, vorCache.list.at(i));
   }
 
   if(mapLayer->isNdb() && types.testFlag(map::NDB))
   {
-    for(int i = ndbCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapNdb& ndb = ndbCache.list.at(i);
-      if(conv.wToS(ndb.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.ndbs, &result.ndbIds, xs, ys, ndb);
-    }
+    updateNearestGrid(conv, ndbCache, ndbGrid);
+    ndbGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.ndbs, &result.ndbIds, xs, ys, ndbCache.list.at(i));
   }
 
   if(mapLayer->isWaypoint() && types.testFlag(map::WAYPOINT))
   {
-    for(int i = waypointCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapWaypoint& wp = waypointCache.list.at(i);
-      if(conv.wToS(wp.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.waypoints, &result.waypointIds, xs, ys, wp);
-    }
+    updateNearestGrid(conv, waypointCache, waypointGrid);
+    waypointGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.waypoints, &result.waypointIds, xs, ys, waypointCache.list.at(i));
   }
 
   // No flag since visibility is defined by type
   if(mapLayer->isUserpoint())
   {
-    for(int i = userpointCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapUserpoint& wp = userpointCache.list.at(i);
-      if(conv.wToS(wp.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.userpoints, &result.userpointIds, xs, ys, wp);
-    }
+    updateNearestGrid(conv, userpointCache, userpointGrid);
+    userpointGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.userpoints, &result.userpointIds, xs, ys, userpointCache.list.at(i));
   }
 
   // Add waypoints that displayed together with airways =================================
   if(mapLayer->isAirwayWaypoint() && (types.testFlag(map::AIRWAYV) || types.testFlag(map::AIRWAYJ)))
   {
-    for(int i = waypointCache.list.size() - 1; i >= 0; i--)
+    updateNearestGrid(conv, waypointCache, waypointGrid);
+    waypointGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
     {
       const MapWaypoint& wp = waypointCache.list.at(i);
       if((wp.hasVictorAirways && types.testFlag(map::AIRWAYV)) ||
          (wp.hasJetAirways && types.testFlag(map::AIRWAYJ)))
-        if(conv.wToS(wp.position, x, y))
-          if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-            insertSortedByDistance(conv, result.waypoints, &result.waypointIds, xs, ys, wp);
+        insertSortedByDistance(conv, result.waypoints, &result.waypointIds, xs, ys, wp);
     }
   }
 
   if(mapLayer->isMarker() && types.testFlag(map::MARKER))
   {
-    for(int i = markerCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapMarker& wp = markerCache.list.at(i);
-      if(conv.wToS(wp.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.markers, nullptr, xs, ys, wp);
-    }
+    updateNearestGrid(conv, markerCache, markerGrid);
+    markerGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.markers, nullptr, xs, ys, markerCache.list.at(i));
   }
 
   if(mapLayer->isIls() && types.testFlag(map::ILS))
   {
-    for(int i = ilsCache.list.size() - 1; i >= 0; i--)
-    {
-      const MapIls& wp = ilsCache.list.at(i);
-      if(conv.wToS(wp.position, x, y))
-        if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-          insertSortedByDistance(conv, result.ils, nullptr, xs, ys, wp);
-    }
+    updateNearestGrid(conv, ilsCache, ilsGrid);
+    ilsGrid.getNearest(xs, ys, screenDistance, indexes);
+    for(int i : indexes)
+      insertSortedByDistance(conv, result.ils, nullptr, xs, ys, ilsCache.list.at(i));
   }
 
   // Get objects from airport diagram =====================================================
@@ -667,6 +672,83 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
   }
 }
 
+template<typename TYPE>
+void MapQuery::updateNearestGrid(const CoordinateConverter& conv, const SimpleRectCache<TYPE>& cache,
+                                 NearestGrid& nearest)
+{
+  if(nearest.revision == cache.revision && nearest.size == cache.list.size())
+    // Neither view nor cache content changed
+    return;
+
+  nearest.revision = cache.revision;
+  nearest.size = cache.list.size();
+
+  // Points are visible up to half of the default size outside the screen
+  nearest.grid.reset(QRect(QPoint(0, 0), conv.getViewport()->size()),
+                     CoordinateConverter::DEFAULT_WTOS_SIZE.width() / 2);
+  nearest.points.fill(QPoint(), cache.list.size());
+
+  ScreenPointBatch batch;
+  conv.wToSBatch(cache.list, batch);
+  for(int i = 0; i < batch.size(); i++)
+  {
+    if(batch.isVisible(i))
+    {
+      nearest.points[i] = QPoint(batch.xInt(i), batch.yInt(i));
+      nearest.grid.insert(i, nearest.points.at(i).x(), nearest.points.at(i).y());
+    }
+  }
+}
+
+void MapQuery::updateNearestTowerGrid(const CoordinateConverter& conv)
+{
+  if(towerGrid.revision == airportCache.revision && towerGrid.size == airportCache.list.size())
+    return;
+
+  towerGrid.revision = airportCache.revision;
+  towerGrid.size = airportCache.list.size();
+
+  towerGrid.grid.reset(QRect(QPoint(0, 0), conv.getViewport()->size()),
+                       CoordinateConverter::DEFAULT_WTOS_SIZE.width() / 2);
+  towerGrid.points.fill(QPoint(), airportCache.list.size());
+
+  QVector<Pos> towers;
+  towers.reserve(airportCache.list.size());
+  for(const MapAirport& airport : airportCache.list)
+    towers.append(airport.towerCoords);
+
+  ScreenPointBatch batch;
+  conv.wToSBatchPos(towers, batch);
+  for(int i = 0; i < batch.size(); i++)
+  {
+    if(batch.isVisible(i))
+    {
+      towerGrid.points[i] = QPoint(batch.xInt(i), batch.yInt(i));
+      towerGrid.grid.insert(i, towerGrid.points.at(i).x(), towerGrid.points.at(i).y());
+    }
+  }
+}
+
+void MapQuery::NearestGrid::getNearest(int xs, int ys, int screenDistance, QVector<int>& indexes) const
+{
+  grid.getNearest(xs, ys, screenDistance, indexes);
+
+  // Remove all candidates from the grid cells which are too far away
+  indexes.erase(std::remove_if(indexes.begin(), indexes.end(), [this, xs, ys, screenDistance](int i) -> bool
+  {
+    return atools::geo::manhattanDistance(points.at(i).x(), points.at(i).y(), xs, ys) >= screenDistance;
+  }), indexes.end());
+
+  // Iterate backwards like the cache lists to keep the order of objects with equal distance
+  std::reverse(indexes.begin(), indexes.end());
+}
+
+bool MapQuery::NearestGridView::operator==(const NearestGridView& other) const
+{
+  return projection == other.projection && radius == other.radius &&
+         centerLon == other.centerLon && centerLat == other.centerLat && size == other.size;
+}
+
 const QList<map::MapAirport> *MapQuery::getAirports(const Marble::GeoDataLatLonBox& rect,
                                                     const MapLayer *mapLayer, bool lazy)
 {
@@ -20,6 +20,7 @@
 
 #include "query/querytypes.h"
 #include "common/maptypes.h"
+#include "common/screengrid.h"
 
 #include <QCache>
 
@@ -197,6 +198,40 @@ private:
 
   bool runwayCompare(const map::MapRunway& r1, const map::MapRunway& r2);
 
+  /* Screen positions of cached objects bucketed in a grid for getNearestObjects.
+   * Built on the first lookup after the view or the cache content has changed. */
+  struct NearestGrid
+  {
+    ScreenGrid grid;
+    QVector<QPoint> points; /* Screen position for each index in the cache list */
+    int revision = -1, size = -1; /* Cache state used to build the grid */
+
+    /* Get indexes of all objects within manhattan distance in descending order */
+    void getNearest(int xs, int ys, int screenDistance, QVector<int>& indexes) const;
+
+  };
+
+  /* Viewport for which the nearest grids were built */
+  struct NearestGridView
+  {
+    int projection = -1, radius = 0;
+    double centerLon = 0., centerLat = 0.;
+    QSize size;
+
+    bool operator==(const NearestGridView& other) const;
+
+    bool operator!=(const NearestGridView& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  /* Rebuild grid if cache or view have changed */
+  template<typename TYPE>
+  void updateNearestGrid(const CoordinateConverter& conv, const SimpleRectCache<TYPE>& cache, NearestGrid& nearest);
+  void updateNearestTowerGrid(const CoordinateConverter& conv);
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbSim, *dbNav, *dbUser;
 
@@ -213,6 +248,10 @@ private:
   /* ID/object caches */
   QCache<int, QList<map::MapRunway> > runwayOverwiewCache;
 
+  /* Screen index for the rectangle caches above */
+  NearestGrid airportGrid, towerGrid, waypointGrid, userpointGrid, vorGrid, ndbGrid, markerGrid, ilsGrid;
+  NearestGridView nearestGridView;
+
   static int queryMaxRows;
 
   /* Database queries */
@@ -67,6 +67,9 @@ struct SimpleRectCache
   const MapLayer *curMapLayer = nullptr;
   QList<TYPE> list;
 
+  /* Incremented each time the list is cleared. Allows users to detect changed content. */
+  int revision = 0;
+
 };
 
 // ---------------------------------------------------------------------------------
@@ -87,6 +90,7 @@ bool SimpleRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, co
   {
     // Rectangle not covered by loaded data or new layer selected
     list.clear();
+    revision++;
     curRect = rect;
     curMapLayer = mapLayer;
     return true;
@@ -108,6 +112,7 @@ template<typename TYPE>
 void SimpleRectCache<TYPE>::clear()
 {
   list.clear();
+  revision++;
   curRect.clear();
   curMapLayer = nullptr;
 }
@@ -189,6 +189,10 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
   connect(&routeAltDelayTimer, &QTimer::timeout, this, &RouteController::routeAltChangedDelayed);
   routeAltDelayTimer.setSingleShot(true);
 
+  // Connect first to update the snapshot before any other receivers are notified
+  connect(this, &RouteController::routeChanged, this, &RouteController::invalidateRouteSnapshot);
+  connect(this, &RouteController::routeAltitudeChanged, this, &RouteController::invalidateRouteSnapshot);
+
   // set up table view
   view->horizontalHeader()->setSectionsMovable(true);
   view->verticalHeader()->setSectionsMovable(false);
@@ -3281,9 +3285,13 @@ void RouteController::simDataChanged(const atools::fs::sc::SimConnectData& simul
       {
         map::PosCourse position(aircraft.getPosition(), aircraft.getTrackDegTrue());
         int previousRouteLeg = route.getActiveLegIndexCorrected();
+        int previousActiveLeg = route.getActiveLegIndex();
         route.updateActiveLegAndPos(position);
         int routeLeg = route.getActiveLegIndexCorrected();
 
+        if(route.getActiveLegIndex() != previousActiveLeg)
+          invalidateRouteSnapshot();
+
         if(routeLeg != previousRouteLeg)
         {
           // Use corrected indexes to highlight initial fix
@@ -3299,6 +3307,19 @@ void RouteController::simDataChanged(const atools::fs::sc::SimConnectData& simul
   }
 }
 
+QSharedPointer<const Route> RouteController::getRouteSnapshot() const
+{
+  if(routeSnapshot.isNull())
+    routeSnapshot = QSharedPointer<const Route>(new Route(route));
+  return routeSnapshot;
+}
+
+void RouteController::invalidateRouteSnapshot()
+{
+  routeSnapshot.reset();
+  routeVersion++;
+}
+
 /* */
 void RouteController::highlightNextWaypoint(int nearestLegIndex)
 {
@@ -23,6 +23,7 @@
 
 #include <QIcon>
 #include <QObject>
+#include <QSharedPointer>
 #include <QTimer>
 
 namespace atools {
@@ -110,6 +111,16 @@ public:
     return route;
   }
 
+  /* Get a shared read only copy of the route. The copy is created only once after each change and can be kept
+   * by callers while the route is modified. */
+  QSharedPointer<const Route> getRouteSnapshot() const;
+
+  /* Incremented on each route change including active leg changes. Used to detect changes of the snapshot. */
+  quint64 getRouteVersion() const
+  {
+    return routeVersion;
+  }
+
   /* Get a copy of all route map objects (legs) that are selected in the flight plan table view */
   void getSelectedRouteLegs(QList<int>& selLegIndexes) const;
 
@@ -363,6 +374,9 @@ private:
 
   void updateTableHeaders();
   void highlightNextWaypoint(int nearestLegIndex);
+
+  /* Drops the route snapshot and increments the version */
+  void invalidateRouteSnapshot();
   void highlightProcedureItems();
   void loadProceduresFromFlightplan(bool clearOldProcedureProperties, bool quiet);
   void updateIcons();
@@ -402,6 +416,10 @@ private:
   /* Flightplan and route objects */
   Route route; /* real route containing all segments */
 
+  /* Copy of the route created on demand - reset when route changes */
+  mutable QSharedPointer<const Route> routeSnapshot;
+  quint64 routeVersion = 0;
+
   /* Current filename of empty if no route - also remember start and dest to avoid accidental overwriting */
   QString routeFilename, fileDeparture, fileDestination;
 